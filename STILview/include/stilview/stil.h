@@ -23,9 +23,11 @@
 #ifndef STIL_H
 #define STIL_H
 
-#include <iosfwd>
+#include <cstddef>
 #include <map>
+#include <memory>
 #include <string>
+#include <string_view>
 
 #include "stildefs.h"
 
@@ -267,7 +269,19 @@ public:
     const char *getErrorStr() const { return STIL_ERROR_STR[lastError]; }
 
 private:
-    using dirList = std::map<std::string, std::streampos>;
+    /// STIL.txt or BUGlist.txt, mapped in memory.
+    struct textFile
+    {
+        std::shared_ptr<const char> data;
+        std::size_t size = 0;
+    };
+
+    /**
+     * Maps each entry to the offset of its first line.
+     * The key is the section as written in the file
+     * followed by the lowercased file name.
+     */
+    using entryList = std::map<std::string, std::size_t>;
 
     /// Path to STIL.
     const char *PATH_TO_STIL;
@@ -284,10 +298,16 @@ private:
     /// Base dir
     std::string baseDir;
 
-    /// Maps of sections (subdirs) for easier positioning.
+    /// The files, kept for the lifetime of the base dir.
     //@{
-    dirList stilDirs;
-    dirList bugDirs;
+    textFile stilText;
+    textFile bugText;
+    //@}
+
+    /// Entries of the files, for direct positioning.
+    //@{
+    entryList stilEntries;
+    entryList bugEntries;
     //@}
 
     /**
@@ -330,44 +350,42 @@ private:
      *      - false - something went wrong
      *      - true  - everything is okay
      */
-    bool determineEOL(std::ifstream &stilFile);
+    bool determineEOL(const textFile &stilFile);
 
     /**
-     * Populates the given dirList array with the directories
-     * obtained from 'inFile' for faster positioning within
-     * 'inFile'.
+     * Populates the given entryList with the entries
+     * obtained from 'inFile', so that they can be found
+     * without scanning 'inFile'.
      *
-     * @param inFile - where to read the directories from
-     * @param dirs   - the dirList array that should be populated with the
-     *                 directory list
+     * @param inFile  - where to read the entries from
+     * @param entries - the entryList that should be populated
      * @param isSTILFile - is this the STIL or the BUGlist we are parsing
      * @return
-     *      - false - No entries were found or otherwise failed to process
+     *      - false - No sections were found or otherwise failed to process
      *                inFile
      *      - true  - everything is okay
      */
-    bool getDirs(std::ifstream &inFile, dirList &dirs, bool isSTILFile);
+    bool getEntries(const textFile &inFile, entryList &entries, bool isSTILFile);
 
     /**
-     * Positions the file pointer to the given entry in 'inFile'
-     * using the 'dirs' dirList for faster positioning.
+     * Finds the given entry in 'entries'.
      *
-     * @param entryStr - the entry to position to
-     * @param inFile   - position the file pointer in this file
-     * @param dirs     - the list of dirs in inFile for easier positioning
+     * @param entryStr - the entry to look for
+     * @param entries  - the entries of the file to search
+     * @param offset   - where to put the offset of the entry
      * @return
      *      - true - if successful
      *      - false - otherwise
      */
-    bool positionToEntry(const char *entryStr, std::ifstream &inFile, dirList &dirs);
+    bool positionToEntry(const char *entryStr, const entryList &entries, std::size_t &offset) const;
 
     /**
-     * Reads the entry from 'inFile'. 'inFile' should
-     * already be positioned to the entry to be read.
+     * Reads the entry starting at 'offset' in 'inFile'.
      *
-     * @param inFile File handle of file to read from.
+     * @param inFile File to read from.
+     * @param offset Offset of the first line of the entry.
      */
-    std::string readEntry(std::ifstream &inFile) const;
+    std::string readEntry(const textFile &inFile, std::size_t offset) const;
 
     /**
      * Given a STIL formatted entry in 'buffer', a tune number,
@@ -403,14 +421,17 @@ private:
     bool getOneField(std::string &result, const char *start, const char *end, STILField field);
 
     /**
-     * Extracts one line from 'infile' to 'line[]'. The end of
-     * the line is marked by endOfLineChar. Also eats up
-     * additional EOL-like chars.
+     * Extracts the line starting at 'pos' in 'infile' and moves
+     * 'pos' past its end. The end of the line is marked by
+     * endOfLineChar. Also eats up additional EOL-like chars.
      *
-     * @param infile - filehandle (streampos should already be positioned
-     *                 to the start of the desired line)
+     * @param infile - file to read from
+     * @param pos    - offset of the desired line
+     * @param eol    - set to false if the file ended before the EOL
+     * @return
+     *      a view of the line in 'infile', without the EOL
      */
-    std::string getStilLine(std::ifstream &infile) const;
+    std::string_view getStilLine(const textFile &infile, std::size_t &pos, bool &eol) const;
 };
 
 #endif // STIL_H
@@ -29,18 +29,19 @@
 
 #include <stilview/stil.h>
 
+#include <cctype>
 #include <cstdlib>
 #include <cstring>
 #include <cstdio>      // For snprintf() and NULL
-#include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <set>
 #include <sstream>
 #include <utility>
+#include <vector>
 
 #include "stringutils.h"
-
-constexpr std::ios::openmode STILopenFlags = std::ios::in | std::ios::binary;
+#include "utils/mapFile.h"
 
 constexpr float VERSION_NO = 3.0f;
 
@@ -90,6 +91,20 @@ void convertSlashes(std::string &str) { std::replace(str.begin(), str.end(), '/'
  */
 void convertToSlashes(std::string &str) { std::replace(str.begin(), str.end(), SLASH, '/'); }
 
+namespace
+{
+/**
+ * Appends a file name to an entry key.
+ * Entries are matched in a case insensitive way.
+ */
+void appendLower(std::string &key, std::string_view name)
+{
+    for (char c : name)
+        key.push_back(static_cast<char>(tolower(c)));
+}
+
+} // Anonymous namespace
+
 
 // CONSTRUCTOR
 STIL::STIL(const char *stilPath, const char *bugsPath) :
@@ -141,9 +156,11 @@ STIL::setBaseDir(const char *pathToHVSC)
     // Temporary placeholder for STIL.txt's version number.
     const float tempSTILVersion = STILVersion;
 
-    // Temporary placeholders for lists of sections.
-    dirList tempStilDirs;
-    dirList tempBugDirs;
+    // Temporary placeholders for the files and their entries.
+    textFile tempStilText;
+    textFile tempBugText;
+    entryList tempStilEntries;
+    entryList tempBugEntries;
 
     lastError = NO_STIL_ERROR;
 
@@ -174,9 +191,8 @@ STIL::setBaseDir(const char *pathToHVSC)
     tempName.append(PATH_TO_STIL);
     convertSlashes(tempName);
 
-    std::ifstream stilFile(tempName.c_str(), STILopenFlags);
-
-    if (stilFile.fail())
+    tempStilText.data = libsidplayfp::mapFile(tempName.c_str(), tempStilText.size);
+    if (!tempStilText.data)
     {
         CERR_STIL_DEBUG << "setBaseDir() open failed for " << tempName << std::endl;
         lastError = STIL_OPEN;
@@ -192,9 +208,10 @@ STIL::setBaseDir(const char *pathToHVSC)
     tempName.append(PATH_TO_BUGLIST);
     convertSlashes(tempName);
 
-    std::ifstream bugFile(tempName.c_str(), STILopenFlags);
+    tempBugText.data = libsidplayfp::mapFile(tempName.c_str(), tempBugText.size);
+    const bool bugOpen = tempBugText.data != nullptr;
 
-    if (bugFile.fail())
+    if (!bugOpen)
     {
         // This is not a critical error - some earlier versions of HVSC did
         // not have a BUGlist.txt file at all.
@@ -208,7 +225,7 @@ STIL::setBaseDir(const char *pathToHVSC)
     }
 
     // Find out what the EOL really is
-    if (determineEOL(stilFile) != true)
+    if (determineEOL(tempStilText) != true)
     {
         CERR_STIL_DEBUG << "determinEOL() failed" << std::endl;
         lastError = NO_EOL;
@@ -224,11 +241,11 @@ STIL::setBaseDir(const char *pathToHVSC)
     // file, too.
     STILVersion = 0.0;
 
-    // These will populate the tempStilDirs and tempBugDirs maps (or not :)
+    // These will populate the tempStilEntries and tempBugEntries maps (or not :)
 
-    if (getDirs(stilFile, tempStilDirs, true) != true)
+    if (getEntries(tempStilText, tempStilEntries, true) != true)
     {
-        CERR_STIL_DEBUG << "getDirs() failed for stilFile" << std::endl;
+        CERR_STIL_DEBUG << "getEntries() failed for stilFile" << std::endl;
         lastError = NO_STIL_DIRS;
 
         // Clean up and restore things.
@@ -237,15 +254,15 @@ STIL::setBaseDir(const char *pathToHVSC)
         return false;
     }
 
-    if (bugFile.good())
+    if (bugOpen)
     {
-        if (getDirs(bugFile, tempBugDirs, false) != true)
+        if (getEntries(tempBugText, tempBugEntries, false) != true)
         {
             // This is not a critical error - it is possible that the
             // BUGlist.txt file has no entries in it at all (in fact, that's
             // good!).
 
-            CERR_STIL_DEBUG << "getDirs() failed for bugFile" << std::endl;
+            CERR_STIL_DEBUG << "getEntries() failed for bugFile" << std::endl;
             lastError = BUG_OPEN;
         }
     }
@@ -256,8 +273,10 @@ STIL::setBaseDir(const char *pathToHVSC)
 
     // Copy.
     baseDir = tempBaseDir;
-    stilDirs = tempStilDirs;
-    bugDirs = tempBugDirs;
+    stilText = std::move(tempStilText);
+    bugText = std::move(tempBugText);
+    stilEntries = std::move(tempStilEntries);
+    bugEntries = std::move(tempBugEntries);
 
     // Clear the buffers (caches).
     entrybuf.clear();
@@ -343,23 +362,9 @@ STIL::getEntry(const char *relPathToEntry, int tuneNo, STILField field)
 
         CERR_STIL_DEBUG << "getEntry(): entry not in buffer" << std::endl;
 
-        // Create the full path+filename
-        std::string tempName(baseDir);
-        tempName.append(PATH_TO_STIL);
-        convertSlashes(tempName);
-
-        std::ifstream stilFile(tempName.c_str(), STILopenFlags);
-
-        if (stilFile.fail())
-        {
-            CERR_STIL_DEBUG << "getEntry() open failed for stilFile" << std::endl;
-            lastError = STIL_OPEN;
-            return nullptr;
-        }
+        std::size_t offset;
 
-        CERR_STIL_DEBUG << "getEntry() open succeeded for stilFile" << std::endl;
-
-        if (positionToEntry(relPathToEntry, stilFile, stilDirs) == false)
+        if (positionToEntry(relPathToEntry, stilEntries, offset) == false)
         {
             // Copy the entry's name to the buffer.
             entrybuf.assign(relPathToEntry).append("\n");
@@ -368,7 +373,7 @@ STIL::getEntry(const char *relPathToEntry, int tuneNo, STILField field)
         }
         else
         {
-            entrybuf = readEntry(stilFile);
+            entrybuf = readEntry(stilText, offset);
             CERR_STIL_DEBUG << "getEntry() entry read" << std::endl;
         }
     }
@@ -442,23 +447,16 @@ STIL::getBug(const char *relPathToEntry, int tuneNo)
 
         CERR_STIL_DEBUG << "getBug(): entry not in buffer" << std::endl;
 
-        // Create the full path+filename
-        std::string tempName(baseDir);
-        tempName.append(PATH_TO_BUGLIST);
-        convertSlashes(tempName);
-
-        std::ifstream bugFile(tempName.c_str(), STILopenFlags);
-
-        if (bugFile.fail())
+        if (bugText.data == nullptr)
         {
-            CERR_STIL_DEBUG << "getBug() open failed for bugFile" << std::endl;
+            CERR_STIL_DEBUG << "getBug() no bugFile" << std::endl;
             lastError = BUG_OPEN;
             return nullptr;
         }
 
-        CERR_STIL_DEBUG << "getBug() open succeeded for bugFile" << std::endl;
+        std::size_t offset;
 
-        if (positionToEntry(relPathToEntry, bugFile, bugDirs) == false)
+        if (positionToEntry(relPathToEntry, bugEntries, offset) == false)
         {
             // Copy the entry's name to the buffer.
             bugbuf.assign(relPathToEntry).append("\n");
@@ -467,7 +465,7 @@ STIL::getBug(const char *relPathToEntry, int tuneNo)
         }
         else
         {
-            bugbuf = readEntry(bugFile);
+            bugbuf = readEntry(bugText, offset);
             CERR_STIL_DEBUG << "getBug() entry read" << std::endl;
         }
     }
@@ -545,21 +543,9 @@ STIL::getGlobalComment(const char *relPathToEntry)
 
         CERR_STIL_DEBUG << "getGC(): entry not in buffer" << std::endl;
 
-        // Create the full path+filename
-        std::string tempName(baseDir);
-        tempName.append(PATH_TO_STIL);
-        convertSlashes(tempName);
-
-        std::ifstream stilFile(tempName.c_str(), STILopenFlags);
-
-        if (stilFile.fail())
-        {
-            CERR_STIL_DEBUG << "getGC() open failed for stilFile" << std::endl;
-            lastError = STIL_OPEN;
-            return nullptr;
-        }
+        std::size_t offset;
 
-        if (positionToEntry(dir.c_str(), stilFile, stilDirs) == false)
+        if (positionToEntry(dir.c_str(), stilEntries, offset) == false)
         {
             // Copy the dirname to the buffer.
             globalbuf.assign(dir).append("\n");
@@ -568,7 +554,7 @@ STIL::getGlobalComment(const char *relPathToEntry)
         }
         else
         {
-            globalbuf = readEntry(stilFile);
+            globalbuf = readEntry(stilText, offset);
             CERR_STIL_DEBUG << "getGC() entry read" << std::endl;
         }
     }
@@ -586,44 +572,30 @@ STIL::getGlobalComment(const char *relPathToEntry)
 
 //////// PRIVATE
 
-bool STIL::determineEOL(std::ifstream &stilFile)
+bool STIL::determineEOL(const textFile &stilFile)
 {
     CERR_STIL_DEBUG << "detEOL() called" << std::endl;
 
-    if (stilFile.fail())
-    {
-        CERR_STIL_DEBUG << "detEOL() open failed" << std::endl;
-        return false;
-    }
-
-    stilFile.seekg(0);
-
     STIL_EOL = '\0';
     STIL_EOL2 = '\0';
 
     // Determine what the EOL character is
     // (it can be different from OS to OS).
-    std::istream::sentry se(stilFile, true);
-    if (se)
-    {
-        std::streambuf *sb = stilFile.rdbuf();
+    const char *data = stilFile.data.get();
 
-        const int eof = std::char_traits<char>::eof();
-
-        while (sb->sgetc() != eof)
+    for (std::size_t i = 0; i < stilFile.size; i++)
+    {
+        const char c = data[i];
+        if (c == '\n' || c == '\r')
         {
-            const int c = sb->sbumpc();
-            if (c == '\n' || c == '\r')
-            {
-                STIL_EOL = static_cast<char>(c);
+            STIL_EOL = c;
 
-                if (c == '\r')
-                {
-                    if (sb->sgetc() == '\n')
-                        STIL_EOL2 = '\n';
-                }
-                break;
+            if (c == '\r')
+            {
+                if ((i + 1 < stilFile.size) && (data[i + 1] == '\n'))
+                    STIL_EOL2 = '\n';
             }
+            break;
         }
     }
 
@@ -639,17 +611,25 @@ bool STIL::determineEOL(std::ifstream &stilFile)
     return true;
 }
 
-bool STIL::getDirs(std::ifstream &inFile, dirList &dirs, bool isSTILFile)
+bool STIL::getEntries(const textFile &inFile, entryList &entries, bool isSTILFile)
 {
     bool newDir = !isSTILFile;
 
-    CERR_STIL_DEBUG << "getDirs() called" << std::endl;
+    CERR_STIL_DEBUG << "getEntries() called" << std::endl;
+
+    // The sections found so far.
+    std::set<std::string> dirs;
+
+    // The sections which would be scanned up to the current line
+    // when looking for an entry, each one a prefix of the next.
+    std::vector<std::string> sections;
 
-    inFile.seekg(0);
+    std::size_t pos = 0;
 
-    while (inFile.good())
+    while (pos < inFile.size)
     {
-        std::string line = getStilLine(inFile);
+        bool eol;
+        const std::string_view line = getStilLine(inFile, pos, eol);
 
         if (!isSTILFile)
         {
@@ -660,10 +640,10 @@ bool STIL::getDirs(std::ifstream &inFile, dirList &dirs, bool isSTILFile)
 
         if (isSTILFile && (STILVersion == 0.0f))
         {
-            if (strncmp(line.data(), "#  STIL v", 9) == 0)
+            if (line.compare(0, 9, "#  STIL v") == 0)
             {
                 // Get the version number
-                STILVersion = static_cast<float>(std::atof(line.c_str() + 9));
+                STILVersion = static_cast<float>(std::atof(std::string(line.substr(9)).c_str()));
 
                 // Put it into the string, too.
                 std::ostringstream ss;
@@ -671,7 +651,7 @@ bool STIL::getDirs(std::ifstream &inFile, dirList &dirs, bool isSTILFile)
                 ss << "SID Tune Information List (STIL) v" << STILVersion << std::endl;
                 versionString.append(ss.str());
 
-                CERR_STIL_DEBUG << "getDirs() STILVersion=" << STILVersion << std::endl;
+                CERR_STIL_DEBUG << "getEntries() STILVersion=" << STILVersion << std::endl;
 
                 continue;
             }
@@ -679,18 +659,37 @@ bool STIL::getDirs(std::ifstream &inFile, dirList &dirs, bool isSTILFile)
 
         // Search for the start of a dir separator first.
 
-        if (isSTILFile && !newDir && stringutils::equal(line.data(), "### ", 4))
+        if (isSTILFile && !newDir && (line.size() >= 4) && stringutils::equal(line.data(), "### ", 4))
         {
             newDir = true;
             continue;
         }
 
+        // Only the start of an entry is of interest from now on.
+
+        if (line.empty() || (line[0] != '/'))
+        {
+            continue;
+        }
+
+        const std::size_t offset = line.data() - inFile.data.get();
+        const std::size_t pathLen = line.find_last_of('/') + 1;
+
+        // The search in a section stops at the first entry outside of it.
+
+        while (!sections.empty()
+            && ((sections.back().size() > line.size())
+                || !stringutils::equal(sections.back().data(), line.data(), sections.back().size())))
+        {
+            sections.pop_back();
+        }
+
         // Is this the start of an entry immediately following a dir separator?
 
-        if (newDir && (line[0] == '/'))
+        if (newDir)
         {
             // Get the directory only
-            const std::string dirName(line, 0, line.find_last_of('/') + 1);
+            const std::string dirName(line.substr(0, pathLen));
 
             if (!isSTILFile)
             {
@@ -699,17 +698,35 @@ bool STIL::getDirs(std::ifstream &inFile, dirList &dirs, bool isSTILFile)
             }
 
             // Store the info
-            if (newDir)
+            if (newDir && dirs.insert(dirName).second)
             {
-                const std::streampos position = inFile.tellg() - static_cast<std::streampos>(line.size()) - 1L;
-
-                CERR_STIL_DEBUG << "getDirs() dirName=" << dirName << ", pos=" << position <<  std::endl;
+                CERR_STIL_DEBUG << "getEntries() dirName=" << dirName << ", pos=" << offset <<  std::endl;
 
-                dirs.insert(std::make_pair(dirName, position));
+                sections.push_back(dirName);
             }
 
             newDir = !isSTILFile;
         }
+
+        // A line cut short by the end of the file is never found.
+
+        if (!eol)
+        {
+            continue;
+        }
+
+        // Store the entry under each section it can be found from,
+        // the first one found wins.
+
+        for (const std::string &section : sections)
+        {
+            if (section.size() == pathLen)
+            {
+                std::string key(section);
+                appendLower(key, line.substr(pathLen));
+                entries.insert(std::make_pair(key, offset));
+            }
+        }
     }
 
     if (dirs.empty())
@@ -717,21 +734,19 @@ bool STIL::getDirs(std::ifstream &inFile, dirList &dirs, bool isSTILFile)
         // No entries found - something is wrong.
         // NOTE: It's perfectly valid to have a BUGlist.txt file with no
         // entries in it!
-        CERR_STIL_DEBUG << "getDirs() no dirs found" << std::endl;
+        CERR_STIL_DEBUG << "getEntries() no dirs found" << std::endl;
         return false;
     }
 
-    CERR_STIL_DEBUG << "getDirs() successful" << std::endl;
+    CERR_STIL_DEBUG << "getEntries() successful, " << entries.size() << " entries" << std::endl;
 
     return true;
 }
 
-bool STIL::positionToEntry(const char *entryStr, std::ifstream &inFile, dirList &dirs)
+bool STIL::positionToEntry(const char *entryStr, const entryList &entries, std::size_t &offset) const
 {
     CERR_STIL_DEBUG << "pos2Entry() called, entryStr=" << entryStr << std::endl;
 
-    inFile.seekg(0);
-
     // Get the dirpath.
 
     const char *chrptr = std::strrchr(entryStr, '/');
@@ -750,69 +765,41 @@ bool STIL::positionToEntry(const char *entryStr, std::ifstream &inFile, dirList
     const size_t entryStrLen = std::strlen(entryStr);
     const bool globComm = (pathLen == entryStrLen);
 
-    // Find it in the table.
-    const std::string entry(entryStr, pathLen);
-    dirList::iterator elem = dirs.find(entry);
-
-    if (elem == dirs.end())
-    {
-        // The directory was not found.
-        CERR_STIL_DEBUG << "pos2Entry() did not find the dir" << std::endl;
-        return false;
-    }
+    std::string key(entryStr, pathLen);
+    appendLower(key, std::string_view(entryStr + pathLen, entryStrLen - pathLen));
 
-    // Jump to the first entry of this section.
-    inFile.seekg(elem->second);
     bool foundIt = false;
 
-    // Now find the desired entry
-
-    std::string line;
-
-    do
+    if (globComm || (STILVersion > 2.59f))
     {
-        line = getStilLine(inFile);
+        const entryList::const_iterator elem = entries.find(key);
 
-        if (inFile.eof())
+        if (elem != entries.end())
         {
-            break;
+            offset = elem->second;
+            foundIt = true;
         }
-
-        // Check if it is the start of an entry
-
-        if (line[0] == '/')
+    }
+    else
+    {
+        // To be compatible with older versions of STIL, which may have
+        // the tune designation on the first line of a STIL entry
+        // together with the pathname, take the first entry
+        // in the file starting with the given one.
+        for (entryList::const_iterator elem = entries.lower_bound(key);
+            (elem != entries.end()) && (elem->first.compare(0, key.size(), key) == 0);
+            ++elem)
         {
-            if (!stringutils::equal(elem->first.data(), line.data(), pathLen))
+            if (!foundIt || (elem->second < offset))
             {
-                // We are outside the section - get out of the loop,
-                // which will fail the search.
-                break;
+                offset = elem->second;
+                foundIt = true;
             }
-
-            // Check whether we need to find a section-global comment or
-            // a specific entry.
-
-            if (globComm || (STILVersion > 2.59f))
-            {
-                foundIt = stringutils::equal(line.c_str(), entryStr);
-            }
-            else
-            {
-                // To be compatible with older versions of STIL, which may have
-                // the tune designation on the first line of a STIL entry
-                // together with the pathname.
-                foundIt = stringutils::equal(line.data(), entryStr, entryStrLen);
-            }
-
-            CERR_STIL_DEBUG << "pos2Entry() line=" << line << std::endl;
         }
     }
-    while (!foundIt);
 
     if (foundIt)
     {
-        // Reposition the file pointer back to the start of the entry.
-        inFile.seekg(inFile.tellg() - static_cast<std::streampos>(line.size()) - 1L);
         CERR_STIL_DEBUG << "pos2Entry() entry found" << std::endl;
         return true;
     }
@@ -823,13 +810,14 @@ bool STIL::positionToEntry(const char *entryStr, std::ifstream &inFile, dirList
     }
 }
 
-std::string STIL::readEntry(std::ifstream &inFile) const
+std::string STIL::readEntry(const textFile &inFile, std::size_t offset) const
 {
     std::string buffer;
 
     while (true)
     {
-        std::string line = getStilLine(inFile);
+        bool eol;
+        const std::string_view line = getStilLine(inFile, offset, eol);
 
         if (line.empty())
             break;
@@ -1194,21 +1182,25 @@ bool STIL::getOneField(std::string &result, const char *start, const char *end,
     return true;
 }
 
-std::string STIL::getStilLine(std::ifstream &infile) const
+std::string_view STIL::getStilLine(const textFile &infile, std::size_t &pos, bool &eol) const
 {
+    const char *data = infile.data.get();
+
     if (STIL_EOL2 != '\0')
     {
         // If there was a remaining EOL char from the previous read, eat it up.
 
-        auto temp = static_cast<char>(infile.peek());
-
-        if (temp == 0x0d || temp == 0x0a)
+        if ((pos < infile.size) && (data[pos] == 0x0d || data[pos] == 0x0a))
         {
-            infile.get(temp);
+            pos++;
         }
     }
 
-    std::string line;
-    std::getline(infile, line, STIL_EOL);
-    return line;
+    const std::size_t start = pos;
+    const void *end = (pos < infile.size) ? std::memchr(data + pos, STIL_EOL, infile.size - pos) : nullptr;
+
+    eol = (end != nullptr);
+    pos = eol ? static_cast<const char*>(end) - data + 1 : infile.size;
+
+    return std::string_view(data + start, pos - start - (eol ? 1 : 0));
 }
@@ -0,0 +1,250 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <catch.hpp>
+
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <stilview/stil.h>
+
+namespace
+{
+constexpr char HVSC_DIR[] = "TestSTIL";
+
+const std::string stilText =
+    "#  STIL v3.78\n"
+    "#\n"
+    "#  The SID Tune Information List\n"
+    "\n"
+    "### /DEMOS/A-F/ ##################################\n"
+    "/DEMOS/A-F/\n"
+    "COMMENT: Demo tunes, first part.\n"
+    "\n"
+    "/DEMOS/A-F/Alpha.sid\n"
+    "  TITLE: Alpha Theme\n"
+    " ARTIST: Someone\n"
+    "\n"
+    "/DEMOS/A-F/Beta.sid\n"
+    "(#1)\n"
+    "  TITLE: Beta Intro\n"
+    " AUTHOR: First Author\n"
+    "(#2)\n"
+    "  TITLE: Beta Main\n"
+    "COMMENT: The main part,\n"
+    "         two lines long.\n"
+    "(#4)\n"
+    "  TITLE: Beta End\n"
+    "\n"
+    "### /MUSICIANS/X/Xeno/ ################################\n"
+    "/MUSICIANS/X/Xeno/\n"
+    "COMMENT: All tunes converted by Xeno.\n"
+    "\n"
+    "/MUSICIANS/X/Xeno/Alpha.sid\n"
+    "COMMENT: Same name as a demo tune.\n"
+    "\n"
+    "/MUSICIANS/X/Xeno/Zulu.sid\n"
+    "COMMENT: Whole tune comment.\n"
+    "(#1)\n"
+    "  TITLE: Zulu One\n"
+    "(#3)\n"
+    "  TITLE: Zulu Three\n"
+    " ARTIST: Band\n";
+
+const std::string bugText =
+    "### /DEMOS/A-F/ ####\n"
+    "/DEMOS/A-F/Beta.sid\n"
+    "(#2)\n"
+    "BUG: Plays too fast.\n"
+    "\n"
+    "### /MUSICIANS/X/Xeno/ ####\n"
+    "/MUSICIANS/X/Xeno/Zulu.sid\n"
+    "BUG: Wrong length.\n";
+
+const std::vector<std::string> paths
+{
+    "/DEMOS/A-F/Alpha.sid",
+    "/DEMOS/A-F/alpha.SID",
+    "/DEMOS/A-F/Beta.sid",
+    "/DEMOS/A-F/Gamma.sid",
+    "/DEMOS/A-F/Zulu.sid",
+    "/MUSICIANS/X/Xeno/Alpha.sid",
+    "/MUSICIANS/X/Xeno/Zulu.sid",
+    "/MUSICIANS/Y/Nobody/Zulu.sid",
+};
+
+enum class eol_t
+{
+    LF,
+    CRLF,
+    UNTERMINATED    // no line end after the last line
+};
+
+std::string convert(const std::string &text, eol_t eol)
+{
+    std::string result;
+    for (char c : text)
+    {
+        if (c == '\n' && eol == eol_t::CRLF)
+            result += '\r';
+        result += c;
+    }
+    if (eol == eol_t::UNTERMINATED)
+        result.pop_back();
+    return result;
+}
+
+void writeHvsc(eol_t eol)
+{
+    const std::filesystem::path docs = std::filesystem::path(HVSC_DIR) / "DOCUMENTS";
+    std::filesystem::create_directories(docs);
+    std::ofstream(docs / "STIL.txt", std::ios::binary) << convert(stilText, eol);
+    std::ofstream(docs / "BUGlist.txt", std::ios::binary) << convert(bugText, eol);
+}
+
+bool equalNoCase(const std::string &a, const std::string &b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (std::size_t i = 0; i < a.size(); i++)
+    {
+        if (tolower(a[i]) != tolower(b[i]))
+            return false;
+    }
+    return true;
+}
+
+/*
+ * The lookup done before the entries were indexed:
+ * jump to the section of the entry, then scan it line by line
+ * up to the entry and copy its lines up to the next empty one.
+ */
+std::string scanEntry(const std::string &text, const std::string &path)
+{
+    const std::string dir = path.substr(0, path.rfind('/') + 1);
+
+    std::istringstream in(text);
+    std::string line;
+    bool inSection = false;
+    while (std::getline(in, line))
+    {
+        if (line.compare(0, 4, "### ") == 0)
+        {
+            inSection = line.compare(4, dir.size(), dir) == 0;
+            continue;
+        }
+
+        if (!inSection || line.empty() || line[0] != '/')
+            continue;
+
+        if (line.compare(0, dir.size(), dir) != 0)
+            break;
+
+        if (!equalNoCase(line, path))
+            continue;
+
+        std::string entry;
+        while (std::getline(in, line) && !line.empty())
+            entry += line + '\n';
+        return entry;
+    }
+
+    return std::string();
+}
+
+std::string str(const char *s)
+{
+    return s != nullptr ? s : "(null)";
+}
+
+void checkLookups()
+{
+    STIL stil;
+    REQUIRE(stil.setBaseDir(HVSC_DIR));
+
+    // Whole entries, against the section scan
+    for (const std::string &path : paths)
+    {
+        INFO(path);
+        const std::string expected = scanEntry(stilText, path);
+        const char *entry = stil.getEntry(path.c_str());
+        if (expected.empty())
+        {
+            CHECK(entry == nullptr);
+            CHECK(stil.getError() == STIL::NOT_IN_STIL);
+        }
+        else
+        {
+            CHECK(str(entry) == expected);
+            CHECK(stil.getError() == STIL::NO_STIL_ERROR);
+        }
+    }
+
+    // Entries with several tunes, as returned by the section scan
+    CHECK(str(stil.getEntry("/DEMOS/A-F/Beta.sid", 1, STIL::author)) == " AUTHOR: First Author\n");
+    CHECK(str(stil.getEntry("/DEMOS/A-F/Beta.sid", 2, STIL::comment)) ==
+        "COMMENT: The main part,\n         two lines long.\n");
+    CHECK(str(stil.getEntry("/DEMOS/A-F/Beta.sid", 4, STIL::title)) == "  TITLE: Beta End\n");
+    CHECK(stil.getEntry("/DEMOS/A-F/Beta.sid", 3) == nullptr);
+    CHECK(str(stil.getEntry("/DEMOS/A-F/Alpha.sid", 1)) == "  TITLE: Alpha Theme\n ARTIST: Someone\n");
+
+    // The last entry of the file
+    CHECK(str(stil.getEntry("/MUSICIANS/X/Xeno/Zulu.sid", 0, STIL::comment)) == "COMMENT: Whole tune comment.\n");
+    CHECK(str(stil.getEntry("/MUSICIANS/X/Xeno/Zulu.sid", 1)) == "  TITLE: Zulu One\n");
+    CHECK(str(stil.getEntry("/MUSICIANS/X/Xeno/Zulu.sid", 3, STIL::artist)) == " ARTIST: Band\n");
+    CHECK(stil.getEntry("/MUSICIANS/X/Xeno/Zulu.sid", 2) == nullptr);
+
+    // Section comments
+    CHECK(str(stil.getGlobalComment("/DEMOS/A-F/Beta.sid")) == "COMMENT: Demo tunes, first part.\n");
+    CHECK(str(stil.getGlobalComment("/MUSICIANS/X/Xeno/Alpha.sid")) == "COMMENT: All tunes converted by Xeno.\n");
+
+    // Bugs, the last entry of BUGlist.txt included
+    CHECK(str(stil.getBug("/DEMOS/A-F/Beta.sid", 2)) == "BUG: Plays too fast.\n");
+    CHECK(stil.getBug("/DEMOS/A-F/Beta.sid", 3) == nullptr);
+    CHECK(str(stil.getBug("/MUSICIANS/X/Xeno/Zulu.sid")) == "BUG: Wrong length.\n");
+    CHECK(stil.getBug("/DEMOS/A-F/Alpha.sid") == nullptr);
+    CHECK(stil.getError() == STIL::NOT_IN_BUG);
+}
+} // Anonymous namespace
+
+TEST_CASE("Test STIL lookups", "[stil]")
+{
+    writeHvsc(eol_t::LF);
+    checkLookups();
+    std::filesystem::remove_all(HVSC_DIR);
+}
+
+TEST_CASE("Test STIL lookups with CRLF line ends", "[stil]")
+{
+    writeHvsc(eol_t::CRLF);
+    checkLookups();
+    std::filesystem::remove_all(HVSC_DIR);
+}
+
+TEST_CASE("Test STIL lookups with an unterminated last line", "[stil]")
+{
+    writeHvsc(eol_t::UNTERMINATED);
+    checkLookups();
+    std::filesystem::remove_all(HVSC_DIR);
+}
@@ -0,0 +1,167 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef BENCHTUNE_H
+#define BENCHTUNE_H
+
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+#include <sidplayfp/SidTune.h>
+
+namespace bench
+{
+
+/**
+ * Build a small PSID tune to be used when no file is given.
+ *
+ * The init routine sets up a filtered sawtooth on voice 1 and
+ * a pulse on voice 2 of every SID, the play routine sweeps
+ * frequencies and filter cutoff once per frame.
+ *
+ * With readback the first SID also plays noise on voice 3 and
+ * the play routine feeds OSC3 and ENV3 back into the filter
+ * cutoff and the voice 2 frequency, so that the output depends
+ * on the values read.
+ *
+ * @param sids the number of SID chips to drive, from 1 to 3
+ * @param readback true to read OSC3 and ENV3 every frame
+ */
+inline std::vector<uint8_t> makeTune(unsigned int sids = 1, bool readback = false)
+{
+    // SID base addresses, low bytes of the high part ($d400, $d420, $d440)
+    constexpr uint8_t sidBase[] = { 0x00, 0x20, 0x40 };
+
+    std::vector<uint8_t> init;
+    std::vector<uint8_t> play;
+
+    const auto sta = [](std::vector<uint8_t>& code, uint8_t base, uint8_t reg)
+    {
+        code.insert(code.end(), { 0x8d, static_cast<uint8_t>(base + reg), 0xd4 });
+    };
+    const auto lda = [](std::vector<uint8_t>& code, uint8_t value)
+    {
+        code.insert(code.end(), { 0xa9, value });
+    };
+
+    for (unsigned int i = 0; i < sids; i++)
+    {
+        const uint8_t base = sidBase[i];
+        lda(init, 0x40); sta(init, base, 0x16); // cutoff
+        lda(init, 0xf1); sta(init, base, 0x17); // resonance, filter voice 1
+        lda(init, 0x1f); sta(init, base, 0x18); // low pass, volume 15
+        lda(init, 0x09); sta(init, base, 0x05); // voice 1 AD
+        lda(init, 0xf0); sta(init, base, 0x06); // voice 1 SR
+        sta(init, base, 0x0d);                  // voice 2 SR
+        lda(init, 0x08); sta(init, base, 0x0a); // voice 2 pulse width
+        lda(init, 0x21); sta(init, base, 0x04); // voice 1 sawtooth + gate
+        lda(init, 0x41); sta(init, base, 0x0b); // voice 2 pulse + gate
+    }
+    if (readback)
+    {
+        lda(init, 0x11); sta(init, 0x00, 0x0f); // voice 3 frequency
+        lda(init, 0x4a); sta(init, 0x00, 0x13); // voice 3 AD
+        lda(init, 0x96); sta(init, 0x00, 0x14); // voice 3 SR
+        lda(init, 0x81); sta(init, 0x00, 0x12); // voice 3 noise + gate
+    }
+    init.push_back(0x60); // RTS
+
+    play.insert(play.end(), { 0xe6, 0xfb }); // INC $FB
+    play.insert(play.end(), { 0xa5, 0xfb }); // LDA $FB
+    for (unsigned int i = 0; i < sids; i++)
+    {
+        sta(play, sidBase[i], 0x01);
+    }
+    play.insert(play.end(), { 0x49, 0xff }); // EOR #$FF
+    for (unsigned int i = 0; i < sids; i++)
+    {
+        sta(play, sidBase[i], 0x08);
+        sta(play, sidBase[i], 0x16);
+    }
+    if (readback)
+    {
+        play.insert(play.end(), { 0xad, 0x1b, 0xd4 }); // LDA $D41B
+        sta(play, 0x00, 0x15);
+        play.insert(play.end(), { 0xad, 0x1c, 0xd4 }); // LDA $D41C
+        sta(play, 0x00, 0x08);
+    }
+    play.push_back(0x60); // RTS
+
+    constexpr uint16_t loadAddr = 0x1000;
+    const uint16_t playAddr = static_cast<uint16_t>(loadAddr + init.size());
+
+    std::vector<uint8_t> tune(0x7c, 0);
+    tune[0] = 'P'; tune[1] = 'S'; tune[2] = 'I'; tune[3] = 'D';
+    tune[5] = sids > 2 ? 4 : sids > 1 ? 3 : 2;   // version
+    tune[7] = 0x7c;                              // data offset
+    tune[10] = loadAddr >> 8;                    // init address
+    tune[12] = playAddr >> 8;                    // play address
+    tune[13] = playAddr & 0xff;
+    tune[15] = 1;                                // songs
+    tune[17] = 1;                                // start song
+    tune[119] = 0x14;                            // PAL, 6581
+    tune[122] = sids > 1 ? 0x42 : 0;             // $d420
+    tune[123] = sids > 2 ? 0x44 : 0;             // $d440
+
+    tune.push_back(loadAddr & 0xff);
+    tune.push_back(loadAddr >> 8);
+    tune.insert(tune.end(), init.begin(), init.end());
+    tune.insert(tune.end(), play.begin(), play.end());
+
+    return tune;
+}
+
+/**
+ * Load the tune from the given file,
+ * fall back to the built-in tune if none is given.
+ */
+inline std::unique_ptr<SidTune> loadTune(const char* fileName, unsigned int sids = 1, bool readback = false)
+{
+    if (fileName != nullptr)
+        return std::make_unique<SidTune>(fileName);
+
+    const std::vector<uint8_t> data = makeTune(sids, readback);
+    return std::make_unique<SidTune>(data.data(), static_cast<uint_least32_t>(data.size()));
+}
+
+/**
+ * Simple wall-clock stopwatch.
+ */
+class timer
+{
+public:
+    timer() : start(std::chrono::steady_clock::now()) {}
+
+    /// Elapsed seconds since construction
+    double elapsed() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    const std::chrono::steady_clock::time_point start;
+};
+
+}
+
+#endif // BENCHTUNE_H
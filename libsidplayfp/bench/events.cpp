@@ -0,0 +1,172 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sidplayfp/sidplayfp.h>
+#include <sidplayfp/SidConfig.h>
+#include <sidplayfp/SidTune.h>
+
+#include "benchtune.h"
+
+/**
+ * Event scheduler throughput benchmark.
+ *
+ * Usage: bench-events [-t<seconds>] [-k<kernal>] [-b<basic>] [-c<chargen>] [file...]
+ *
+ * Runs each program for the given amount of emulated time without
+ * SID emulation, so that the time is spent in the CPU, CIA and VIC
+ * emulation and in the event scheduler. Pass the Lorenz testsuite
+ * programs together with the ROM dumps they need, otherwise the
+ * built-in tune is run with one, two and three SIDs.
+ *
+ * Build once with LIBSIDPLAYFP_USE_TIMING_WHEEL=OFF and once with ON
+ * to compare the scheduler implementations.
+ */
+namespace
+{
+bool loadRom(const char* path, std::vector<uint8_t>& buffer, std::size_t size)
+{
+    std::ifstream is(path, std::ios::binary);
+    if (!is.is_open())
+    {
+        std::cerr << "File " << path << " not found" << std::endl;
+        return false;
+    }
+    buffer.resize(size);
+    is.read(reinterpret_cast<char*>(buffer.data()), size);
+    return true;
+}
+
+bool run(sidplayfp& engine, SidTune& tune, const char* name, unsigned int seconds)
+{
+    if (!tune.getStatus())
+    {
+        std::cerr << name << ": " << tune.statusString() << std::endl;
+        return false;
+    }
+
+    tune.selectSong(0);
+    if (!engine.load(&tune))
+    {
+        std::cerr << name << ": " << engine.error() << std::endl;
+        return false;
+    }
+
+    const uint_least32_t lengthMs = seconds * 1000;
+
+    const bench::timer t;
+    while (engine.timeMs() < lengthMs)
+    {
+        engine.play(nullptr, 0);
+        if (!engine.isPlaying())
+            break;
+    }
+    const double elapsed = t.elapsed();
+
+    const double emulated = engine.timeMs() / 1000.;
+
+    std::cout << std::fixed << std::setprecision(3)
+              << std::left << std::setw(24) << name << std::right
+              << " " << emulated << " s in " << elapsed << " s, "
+              << std::setprecision(1) << emulated / elapsed << "x realtime" << std::endl;
+    return true;
+}
+} // Anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    unsigned int seconds = 20;
+    std::vector<uint8_t> kernal;
+    std::vector<uint8_t> basic;
+    std::vector<uint8_t> chargen;
+    std::vector<const char*> files;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        if (arg[0] == '-' && arg[1] != '\0')
+        {
+            bool ok = true;
+            switch (arg[1])
+            {
+            case 't': seconds = std::strtoul(arg + 2, nullptr, 10); break;
+            case 'k': ok = loadRom(arg + 2, kernal, 8192); break;
+            case 'b': ok = loadRom(arg + 2, basic, 8192); break;
+            case 'c': ok = loadRom(arg + 2, chargen, 4096); break;
+            default:
+                std::cerr << "Unknown option " << arg << std::endl;
+                return EXIT_FAILURE;
+            }
+            if (!ok)
+                return EXIT_FAILURE;
+        }
+        else
+        {
+            files.push_back(arg);
+        }
+    }
+
+    sidplayfp engine;
+
+    if (!kernal.empty())
+    {
+        engine.setRoms(kernal.data(),
+                       basic.empty() ? nullptr : basic.data(),
+                       chargen.empty() ? nullptr : chargen.data());
+    }
+
+    SidConfig cfg = engine.config();
+    cfg.powerOnDelay = 0x1267;
+    cfg.sidEmulation = nullptr;
+    if (!engine.config(cfg))
+    {
+        std::cerr << engine.error() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (files.empty())
+    {
+        for (unsigned int sids = 1; sids <= 3; sids++)
+        {
+            const std::unique_ptr<SidTune> tune = bench::loadTune(nullptr, sids);
+            const std::string name = "built-in, " + std::to_string(sids) + " SID";
+            if (!run(engine, *tune, name.c_str(), seconds))
+                return EXIT_FAILURE;
+        }
+    }
+
+    for (const char* file : files)
+    {
+        SidTune tune(file);
+        const char* name = std::strrchr(file, '/');
+        if (!run(engine, tune, name != nullptr ? name + 1 : file, seconds))
+            return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,118 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "FilterModelConfig.h"
+#include "FilterModelConfig8580.h"
+#include "FilterTables.h"
+#include "SID.h"
+
+/**
+ * Filter table startup benchmark.
+ *
+ * Usage: bench-filtertables [file]
+ *
+ * Builds the 6581 and 8580 filter model tables like the first SID
+ * created by a process does and saves them to the given file,
+ * residfp-filter.tables by default. Then maps the file back, checks
+ * that the contents match and creates a SID using the mapped tables.
+ * Reports the time taken by each step.
+ */
+namespace
+{
+using reSIDfp::FilterModelConfig;
+using reSIDfp::FilterModelConfig8580;
+using reSIDfp::FilterTables;
+
+using clock_type = std::chrono::steady_clock;
+
+void report(const char* step, clock_type::time_point start)
+{
+    const double ms = std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+    std::cout << std::left << std::setw(20) << step << std::right
+              << std::fixed << std::setprecision(2) << std::setw(10) << ms << " ms" << std::endl;
+}
+} // Anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    const char* path = argc > 1 ? argv[1] : "residfp-filter.tables";
+
+    std::vector<std::uint16_t> data6581(FilterModelConfig::TABLE_SIZE);
+    std::vector<std::uint16_t> data8580(FilterModelConfig8580::TABLE_SIZE);
+
+    std::cout << "tables: "
+              << (data6581.size() + data8580.size()) * sizeof(std::uint16_t) / 1024 << " KiB" << std::endl;
+
+    {
+        const clock_type::time_point start = clock_type::now();
+        FilterModelConfig::buildTables(data6581.data());
+        FilterModelConfig8580::buildTables(data8580.data());
+        report("build", start);
+    }
+
+    if (!FilterTables::save(path))
+    {
+        std::cerr << "Cannot write " << path << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    FilterTables::Data mapped6581;
+    FilterTables::Data mapped8580;
+    {
+        const clock_type::time_point start = clock_type::now();
+        if (!FilterTables::open(path, mapped6581, mapped8580))
+        {
+            std::cerr << "Cannot map " << path << std::endl;
+            return EXIT_FAILURE;
+        }
+        report("map", start);
+    }
+
+    {
+        // Page in the whole file, as a process using it eventually will
+        const clock_type::time_point start = clock_type::now();
+        const bool match =
+            std::memcmp(mapped6581.get(), data6581.data(), data6581.size() * sizeof(std::uint16_t)) == 0
+            && std::memcmp(mapped8580.get(), data8580.data(), data8580.size() * sizeof(std::uint16_t)) == 0;
+        report("read and compare", start);
+
+        if (!match)
+        {
+            std::cerr << "Mapped tables differ" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {
+        const clock_type::time_point start = clock_type::now();
+        FilterTables::load(path);
+        reSIDfp::SID sid;
+        report("first SID, mapped", start);
+    }
+
+    return EXIT_SUCCESS;
+}
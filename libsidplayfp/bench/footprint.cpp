@@ -0,0 +1,183 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include <sidplayfp/sidplayfp.h>
+#include <sidplayfp/SidConfig.h>
+#include <sidplayfp/SidInfo.h>
+#include <sidplayfp/SidTune.h>
+#include <sidplayfp/builders/residfp.h>
+
+#include "benchtune.h"
+
+/**
+ * Engine memory footprint report.
+ *
+ * Usage: bench-footprint [-S<sids>] [file]
+ *
+ * Counts the heap memory taken by a configured engine playing a tune,
+ * the built-in one if no file is given. The first engine also builds
+ * the tables shared by all the engines in the process, so the cost of
+ * each additional engine is reported separately, as is the cost
+ * of a single ReSIDfp emulation.
+ */
+namespace
+{
+std::atomic<std::size_t> liveBytes{0};
+
+/// Stored in front of every allocation
+struct block_t
+{
+    void* base;
+    std::size_t size;
+};
+
+void* allocate(std::size_t size, std::size_t align)
+{
+    align = std::max(align, alignof(std::max_align_t));
+    const std::size_t offset = (sizeof(block_t) + align - 1) / align * align;
+
+    char* const base = static_cast<char*>(std::malloc(size + offset + align));
+    if (base == nullptr)
+        throw std::bad_alloc();
+
+    char* p = base + offset;
+    p += (align - reinterpret_cast<std::uintptr_t>(p) % align) % align;
+
+    block_t* const block = reinterpret_cast<block_t*>(p) - 1;
+    block->base = base;
+    block->size = size;
+    liveBytes += size;
+    return p;
+}
+
+void release(void* p) noexcept
+{
+    if (p == nullptr)
+        return;
+
+    block_t* const block = static_cast<block_t*>(p) - 1;
+    liveBytes -= block->size;
+    std::free(block->base);
+}
+
+void report(const char* what, std::size_t bytes)
+{
+    std::cout << what << ": " << (bytes + 512) / 1024 << " KiB" << std::endl;
+}
+
+struct engine_t
+{
+    ReSIDfpBuilder builder{"footprint"};
+    sidplayfp player;
+};
+
+std::unique_ptr<engine_t> createEngine(SidTune& tune)
+{
+    auto engine = std::make_unique<engine_t>();
+    engine->builder.create(engine->player.info().maxsids());
+
+    SidConfig cfg;
+    cfg.frequency = 48000;
+    cfg.samplingMethod = SidConfig::SamplingMethod::ResampleInterpolate;
+    cfg.sidEmulation = &engine->builder;
+    if (!engine->player.config(cfg) || !engine->player.load(&tune))
+    {
+        std::cerr << engine->player.error() << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    // Play a bit so that everything is set up
+    std::vector<short> buffer(4096);
+    engine->player.play(buffer.data(), buffer.size());
+    return engine;
+}
+} // Anonymous namespace
+
+void* operator new(std::size_t size) { return allocate(size, 0); }
+void* operator new[](std::size_t size) { return allocate(size, 0); }
+void* operator new(std::size_t size, std::align_val_t align) { return allocate(size, static_cast<std::size_t>(align)); }
+void* operator new[](std::size_t size, std::align_val_t align) { return allocate(size, static_cast<std::size_t>(align)); }
+void operator delete(void* p) noexcept { release(p); }
+void operator delete[](void* p) noexcept { release(p); }
+void operator delete(void* p, std::size_t) noexcept { release(p); }
+void operator delete[](void* p, std::size_t) noexcept { release(p); }
+void operator delete(void* p, std::align_val_t) noexcept { release(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { release(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { release(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { release(p); }
+
+int main(int argc, char* argv[])
+{
+    unsigned int sids = 1;
+    const char* fileName = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        if (arg[0] == '-' && arg[1] == 'S')
+        {
+            const unsigned long value = std::strtoul(arg + 2, nullptr, 10);
+            sids = value < 1 ? 1 : value > 3 ? 3 : value;
+        }
+        else if (arg[0] == '-')
+        {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return EXIT_FAILURE;
+        }
+        else
+        {
+            fileName = arg;
+        }
+    }
+
+    std::unique_ptr<SidTune> tune = bench::loadTune(fileName, sids);
+    if (!tune->getStatus())
+    {
+        std::cerr << tune->statusString() << std::endl;
+        return EXIT_FAILURE;
+    }
+    tune->selectSong(0);
+
+    std::size_t before = liveBytes;
+    std::unique_ptr<engine_t> first = createEngine(*tune);
+    report("first engine, with shared tables", liveBytes - before);
+
+    before = liveBytes;
+    std::unique_ptr<engine_t> second = createEngine(*tune);
+    report("each additional engine", liveBytes - before);
+
+    {
+        before = liveBytes;
+        ReSIDfpBuilder builder("footprint");
+        builder.create(1);
+        report("each ReSIDfp emulation", liveBytes - before);
+    }
+
+    return EXIT_SUCCESS;
+}
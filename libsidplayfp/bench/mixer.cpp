@@ -0,0 +1,159 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "mixer.h"
+#include "sidemu.h"
+
+/**
+ * Mixer throughput benchmark.
+ *
+ * Usage: bench-mixer [seconds]
+ *
+ * Mixes the given amount of 48 kHz audio from fake chips producing
+ * pseudo-random samples, for one to three chips in mono and stereo,
+ * at normal speed and fast forwarding. The checksum of the 16 bit
+ * output allows comparing mixer implementations, it only depends
+ * on the fixed seeds.
+ */
+namespace
+{
+constexpr unsigned int RATE = 48000;
+
+/**
+ * Produces a slice of samples on each clock,
+ * about the amount of a 5000 cycles slice at 48 kHz.
+ * The samples are taken from a precomputed noise table
+ * and exceed 16 bits to exercise the clipping.
+ */
+class FakeSid final : public libsidplayfp::sidemu
+{
+public:
+    explicit FakeSid(std::uint32_t seed) :
+        sidemu(nullptr),
+        m_samples(BUFFERSIZE),
+        m_noise(NOISE_SIZE + 256),
+        m_seed(seed)
+    {
+        m_buffer = m_samples.data();
+        for (int& sample : m_noise)
+            sample = static_cast<int>(next() % 80001) - 40000;
+    }
+
+    void clock() override
+    {
+        // All the chips produce the same amount, like the real ones
+        const int count = 240 + static_cast<int>(m_clocks++ * 7 % 11);
+        const int* const src = m_noise.data() + (next() % NOISE_SIZE);
+        std::copy(src, src + count, m_buffer + m_bufferpos);
+        m_bufferpos += count;
+    }
+
+    void voice(unsigned int, bool) override {}
+    void model(SidConfig::SIDModel, bool) override {}
+    void reset(uint8_t) override {}
+    uint8_t read(uint_least8_t) override { return 0; }
+    void write(uint_least8_t, uint8_t) override {}
+
+private:
+    static constexpr std::uint32_t NOISE_SIZE = 1 << 16;
+
+    std::uint32_t next()
+    {
+        m_seed = m_seed * 1664525u + 1013904223u;
+        return m_seed >> 8;
+    }
+
+private:
+    std::vector<int> m_samples;
+    std::vector<int> m_noise;
+    std::uint32_t m_seed;
+    unsigned int m_clocks = 0;
+};
+
+std::uint32_t checksum(const short* data, std::size_t count, std::uint32_t h)
+{
+    for (std::size_t i = 0; i < count; i++)
+    {
+        h = (h ^ static_cast<std::uint16_t>(data[i])) * 16777619u;
+    }
+    return h;
+}
+} // Anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    const unsigned int seconds = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 600;
+
+    for (bool stereo : { false, true })
+    {
+        for (unsigned int chips = 1; chips <= libsidplayfp::Mixer::MAX_SIDS; chips++)
+        {
+            for (int ff : { 1, 4 })
+            {
+                std::vector<std::unique_ptr<FakeSid>> sids;
+                libsidplayfp::Mixer mixer;
+                for (unsigned int i = 0; i < chips; i++)
+                {
+                    sids.emplace_back(new FakeSid(i + 1));
+                    mixer.addSid(sids.back().get());
+                }
+                mixer.setStereo(stereo);
+                mixer.setVolume(libsidplayfp::Mixer::VOLUME_MAX, libsidplayfp::Mixer::VOLUME_MAX);
+                mixer.setFastForward(ff);
+
+                const std::size_t channels = stereo ? 2 : 1;
+                std::vector<short> buffer(4096 * channels);
+                const std::size_t total = static_cast<std::size_t>(seconds) * RATE * channels;
+                std::uint32_t sum = 2166136261u;
+
+                const auto start = std::chrono::steady_clock::now();
+                for (std::size_t done = 0; done < total; done += buffer.size())
+                {
+                    mixer.begin(buffer.data(), buffer.size());
+                    while (mixer.notFinished())
+                    {
+                        mixer.clockChips();
+                        mixer.doMix();
+                    }
+                    sum = checksum(buffer.data(), buffer.size(), sum);
+                }
+                const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+                std::cout << (stereo ? "stereo" : "mono  ") << " " << chips << " SID "
+                          << "ff " << std::setw(2) << ff << ": "
+                          << std::fixed << std::setprecision(1) << std::setw(7)
+                          << total / elapsed / 1e6 << " Msamples/s (checksum "
+                          << std::hex << std::setw(8) << std::setfill('0') << sum
+                          << std::dec << std::setfill(' ') << ")" << std::endl;
+            }
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
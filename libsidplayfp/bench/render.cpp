@@ -0,0 +1,154 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+#include <sidplayfp/sidplayfp.h>
+#include <sidplayfp/sidsink.h>
+#include <sidplayfp/SidConfig.h>
+#include <sidplayfp/SidInfo.h>
+#include <sidplayfp/SidTune.h>
+#include <sidplayfp/builders/residfp.h>
+
+#include "benchtune.h"
+
+/**
+ * Offline rendering throughput benchmark.
+ *
+ * Usage: bench-render [-t<seconds>] [-b<blocksize>] [-s<song>] [-f<frequency>] [-S<sids>] [-j] [-r] [file]
+ *
+ * Reports how many seconds of audio are rendered per wall-clock second.
+ * Without a file a small built-in tune is used,
+ * -r makes it read back OSC3 and ENV3.
+ * With -j the SID chips are clocked on separate threads,
+ * the checksum must not change.
+ */
+namespace
+{
+class countingSink final : public sidsink
+{
+public:
+    bool write(const short* buffer, std::size_t count) override
+    {
+        for (std::size_t i = 0; i < count; i++)
+            checksum = checksum * 31 + static_cast<unsigned short>(buffer[i]);
+        blocks++;
+        return true;
+    }
+
+    unsigned long blocks = 0;
+    unsigned int checksum = 0;
+};
+} // Anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    unsigned int seconds = 60;
+    std::size_t blockSize = 0;
+    unsigned int song = 0;
+    unsigned int frequency = 48000;
+    unsigned int sids = 1;
+    bool threaded = false;
+    bool readback = false;
+    const char* fileName = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        if (arg[0] == '-' && arg[1] != '\0')
+        {
+            const unsigned long value = std::strtoul(arg + 2, nullptr, 10);
+            switch (arg[1])
+            {
+            case 't': seconds = value; break;
+            case 'b': blockSize = value; break;
+            case 's': song = value; break;
+            case 'f': frequency = value; break;
+            case 'S': sids = value < 1 ? 1 : value > 3 ? 3 : value; break;
+            case 'j': threaded = true; break;
+            case 'r': readback = true; break;
+            default:
+                std::cerr << "Unknown option " << arg << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else
+        {
+            fileName = arg;
+        }
+    }
+
+    sidplayfp engine;
+
+    ReSIDfpBuilder rs("bench");
+    rs.create(engine.info().maxsids());
+    if (!rs.getStatus())
+    {
+        std::cerr << rs.error() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::unique_ptr<SidTune> tune = bench::loadTune(fileName, sids, readback);
+    if (!tune->getStatus())
+    {
+        std::cerr << tune->statusString() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    SidConfig cfg;
+    cfg.frequency = frequency;
+    cfg.samplingMethod = SidConfig::SamplingMethod::ResampleInterpolate;
+    cfg.playback = SidConfig::PlaybackMode::Mono;
+    // Fixed delay for reproducible output
+    cfg.powerOnDelay = 0x1267;
+    cfg.threadedSids = threaded;
+    cfg.sidEmulation = &rs;
+    if (!engine.config(cfg))
+    {
+        std::cerr << engine.error() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    countingSink sink;
+
+    const bench::timer t;
+    std::size_t samples = 0;
+    const bool rendered = engine.renderToSink(tune.get(), song, seconds * 1000, sink, samples, blockSize);
+    const double elapsed = t.elapsed();
+
+    if (!rendered)
+    {
+        std::cerr << engine.error() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const double audioSeconds = static_cast<double>(samples) / frequency;
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "rendered " << audioSeconds << " s of audio in " << elapsed << " s ("
+              << sink.blocks << " blocks, checksum " << std::hex << sink.checksum << std::dec << ")" << std::endl
+              << "throughput " << std::setprecision(1) << audioSeconds / elapsed << " s audio / s wall clock" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,119 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#  else
+#    include <x86intrin.h>
+#  endif
+#  define HAVE_RDTSC
+#endif
+
+#include "resample/Convolve.h"
+#include "resample/TwoPassSincResampler.h"
+
+/**
+ * Resampler convolution kernel benchmark.
+ *
+ * Usage: bench-resampler [seconds]
+ *
+ * Feeds the given amount of PAL clock cycles into the two pass
+ * resampler with every kernel supported by the running CPU and reports
+ * the cost per output sample, in TSC cycles on x86 or nanoseconds elsewhere.
+ */
+namespace
+{
+constexpr double CLOCK = 985248.;
+
+inline unsigned long long ticks()
+{
+#ifdef HAVE_RDTSC
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+} // Anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    const unsigned int seconds = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10;
+    const int cycles = static_cast<int>(CLOCK * seconds);
+
+    // Sawtooth with some noise, a rough approximation of SID output
+    std::vector<short> input(4096);
+    unsigned int seed = 1;
+    for (std::size_t i = 0; i < input.size(); i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        input[i] = static_cast<short>(((i * 97) & 0x7fff) - 0x4000 + ((seed >> 16) & 0x3ff));
+    }
+
+#ifdef HAVE_RDTSC
+    const char* unit = "TSC cycles";
+#else
+    const char* unit = "ns";
+#endif
+
+    for (double rate : { 44100., 48000., 96000. })
+    {
+        // Build the FIR tables outside of the timed loop
+        reSIDfp::TwoPassSincResampler::create(CLOCK, rate, 20000.);
+
+        for (const auto& kernel : reSIDfp::getConvolveKernels())
+        {
+            auto r = reSIDfp::TwoPassSincResampler::create(CLOCK, rate, 20000., kernel.convolve);
+            r->reset();
+
+            unsigned long samples = 0;
+            int checksum = 0;
+
+            const auto startTime = std::chrono::steady_clock::now();
+            const unsigned long long start = ticks();
+            for (int i = 0; i < cycles; i++)
+            {
+                if (r->input(input[i & (input.size() - 1)]))
+                {
+                    checksum += r->getOutput();
+                    samples++;
+                }
+            }
+            const unsigned long long end = ticks();
+            const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+            std::cout << std::fixed << std::setprecision(0)
+                      << std::setw(6) << rate << " Hz " << std::setw(7) << kernel.name << ": "
+                      << std::setprecision(1) << std::setw(8) << static_cast<double>(end - start) / samples
+                      << ' ' << unit << " per output sample, "
+                      << std::setprecision(2) << cycles / CLOCK / elapsed << "x realtime"
+                      << " (checksum " << checksum << ")" << std::endl;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
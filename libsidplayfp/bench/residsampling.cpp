@@ -0,0 +1,90 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+#include <sidplayfp/SidConfig.h>
+#include <sidplayfp/builders/resid.h>
+
+#include "builders/resid-builder/resid-emu.h"
+
+/**
+ * reSID sampling setup latency benchmark.
+ *
+ * Usage: bench-residsampling [instances]
+ *
+ * Sets the resampling parameters on the given number of fresh reSID
+ * instances for each sample rate and method, reporting the time
+ * taken by the first one, which computes the FIR tables, and the
+ * average time taken by the following ones. The first instance is
+ * kept alive meanwhile, as the cache only holds tables still in use.
+ */
+namespace
+{
+constexpr float CLOCK = 985248.f;
+
+double setup(libsidplayfp::ReSID& sid, float rate, bool fast)
+{
+    const auto start = std::chrono::steady_clock::now();
+    sid.sampling(CLOCK, rate, SidConfig::SamplingMethod::ResampleInterpolate, fast);
+    const double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    if (!sid.getStatus())
+    {
+        std::cerr << sid.error() << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    return elapsed;
+}
+} // Anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    const unsigned int instances = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100;
+
+    ReSIDBuilder builder("bench");
+
+    for (bool fast : { false, true })
+    {
+        for (float rate : { 44100.f, 48000.f, 96000.f })
+        {
+            libsidplayfp::ReSID owner(&builder);
+            const double first = setup(owner, rate, fast);
+
+            double total = 0.;
+            for (unsigned int i = 0; i < instances; i++)
+            {
+                libsidplayfp::ReSID sid(&builder);
+                total += setup(sid, rate, fast);
+            }
+
+            std::cout << std::fixed << std::setprecision(0)
+                      << std::setw(6) << rate << " Hz " << (fast ? "fast" : "    ") << ": "
+                      << std::setprecision(3) << "first " << std::setw(8) << first << " ms, "
+                      << "next " << std::setw(8) << total / instances << " ms" << std::endl;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
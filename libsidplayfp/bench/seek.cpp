@@ -0,0 +1,159 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <sidplayfp/sidplayfp.h>
+#include <sidplayfp/SidConfig.h>
+#include <sidplayfp/SidInfo.h>
+#include <sidplayfp/SidTune.h>
+#include <sidplayfp/builders/residfp.h>
+
+#include "benchtune.h"
+
+/**
+ * Seek speed benchmark.
+ *
+ * Usage: bench-seek [-t<seconds>] [-s<song>] [-S<sids>] [-r] [file]
+ *
+ * Moves to the given position, 150 seconds by default, once by
+ * fast forwarding at the maximum speed like the console player
+ * used to do and once with sidplayfp::seek, and reports how many
+ * seconds of the tune are skipped per wall-clock second.
+ * Without a file a small built-in tune is used,
+ * -r makes it read back OSC3 and ENV3.
+ */
+namespace
+{
+void report(const char* method, double seconds, double elapsed)
+{
+    std::cout << std::fixed << std::setprecision(3)
+              << std::left << std::setw(14) << method << std::right
+              << seconds << " s in " << elapsed << " s, "
+              << std::setprecision(1) << seconds / elapsed << "x realtime" << std::endl;
+}
+} // Anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    unsigned int seconds = 150;
+    unsigned int song = 0;
+    unsigned int sids = 1;
+    bool readback = false;
+    const char* fileName = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        if (arg[0] == '-' && arg[1] != '\0')
+        {
+            const unsigned long value = std::strtoul(arg + 2, nullptr, 10);
+            switch (arg[1])
+            {
+            case 't': seconds = value; break;
+            case 's': song = value; break;
+            case 'S': sids = value < 1 ? 1 : value > 3 ? 3 : value; break;
+            case 'r': readback = true; break;
+            default:
+                std::cerr << "Unknown option " << arg << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else
+        {
+            fileName = arg;
+        }
+    }
+
+    sidplayfp engine;
+
+    ReSIDfpBuilder rs("bench");
+    rs.create(engine.info().maxsids());
+    if (!rs.getStatus())
+    {
+        std::cerr << rs.error() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::unique_ptr<SidTune> tune = bench::loadTune(fileName, sids, readback);
+    if (!tune->getStatus())
+    {
+        std::cerr << tune->statusString() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    SidConfig cfg;
+    cfg.frequency = 48000;
+    cfg.samplingMethod = SidConfig::SamplingMethod::ResampleInterpolate;
+    cfg.playback = SidConfig::PlaybackMode::Mono;
+    cfg.powerOnDelay = 0x1267;
+    cfg.sidEmulation = &rs;
+    if (!engine.config(cfg))
+    {
+        std::cerr << engine.error() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const uint_least32_t target = seconds * 1000;
+
+    tune->selectSong(song);
+    if (!engine.load(tune.get()))
+    {
+        std::cerr << engine.error() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    {
+        std::vector<short> buffer(4096);
+        engine.fastForward(3200);
+
+        const bench::timer t;
+        while (engine.timeMs() < target)
+        {
+            if (engine.play(buffer.data(), buffer.size()) < buffer.size() && !engine.isPlaying())
+                break;
+        }
+        report("fast forward", engine.timeMs() / 1000., t.elapsed());
+
+        engine.fastForward(100);
+    }
+
+    if (!engine.load(tune.get()))
+    {
+        std::cerr << engine.error() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    {
+        const bench::timer t;
+        if (!engine.seek(target))
+        {
+            std::cerr << engine.error() << std::endl;
+            return EXIT_FAILURE;
+        }
+        report("seek", engine.timeMs() / 1000., t.elapsed());
+    }
+
+    return EXIT_SUCCESS;
+}
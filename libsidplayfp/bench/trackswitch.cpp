@@ -0,0 +1,144 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <sidplayfp/sidplayfp.h>
+#include <sidplayfp/SidConfig.h>
+#include <sidplayfp/SidInfo.h>
+#include <sidplayfp/SidTune.h>
+#include <sidplayfp/builders/residfp.h>
+
+#include "benchtune.h"
+
+/**
+ * Track switch latency benchmark.
+ *
+ * Usage: bench-trackswitch [-n<switches>] [-f<frequency>] [-S<sids>] [-m] [file] [file]
+ *
+ * Loads two tunes in turn, like a playlist server switching tracks,
+ * and reports the time taken by sidplayfp::load plus the first
+ * 20 ms of audio. Without files the built-in tune is used, once
+ * with one SID and once with the given number of SIDs.
+ * With -m the second tune uses the other SID model,
+ * so the chips have to be reconfigured on each switch.
+ */
+int main(int argc, char* argv[])
+{
+    unsigned int switches = 2000;
+    unsigned int frequency = 48000;
+    unsigned int sids = 1;
+    bool otherModel = false;
+    std::vector<const char*> fileNames;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        if (arg[0] == '-' && arg[1] != '\0')
+        {
+            const unsigned long value = std::strtoul(arg + 2, nullptr, 10);
+            switch (arg[1])
+            {
+            case 'n': switches = value; break;
+            case 'f': frequency = value; break;
+            case 'S': sids = value < 1 ? 1 : value > 3 ? 3 : value; break;
+            case 'm': otherModel = true; break;
+            default:
+                std::cerr << "Unknown option " << arg << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else
+        {
+            fileNames.push_back(arg);
+        }
+    }
+
+    sidplayfp engine;
+
+    ReSIDfpBuilder rs("bench");
+    rs.create(engine.info().maxsids());
+    if (!rs.getStatus())
+    {
+        std::cerr << rs.error() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::unique_ptr<SidTune> tunes[2];
+    for (int i = 0; i < 2; i++)
+    {
+        if (fileNames.size() > static_cast<std::size_t>(i))
+        {
+            tunes[i] = bench::loadTune(fileNames[i]);
+        }
+        else
+        {
+            std::vector<uint8_t> data = bench::makeTune(i == 0 ? 1 : sids);
+            if (i == 1 && otherModel)
+                data[119] = 0x24; // PAL, 8580
+            tunes[i] = std::make_unique<SidTune>(data.data(), static_cast<uint_least32_t>(data.size()));
+        }
+        if (!tunes[i]->getStatus())
+        {
+            std::cerr << tunes[i]->statusString() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    SidConfig cfg;
+    cfg.frequency = frequency;
+    cfg.samplingMethod = SidConfig::SamplingMethod::ResampleInterpolate;
+    cfg.playback = SidConfig::PlaybackMode::Mono;
+    cfg.powerOnDelay = 0x1267;
+    cfg.sidEmulation = &rs;
+    if (!engine.config(cfg))
+    {
+        std::cerr << engine.error() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<short> buffer(frequency / 50);
+
+    double loadTime = 0.;
+    const bench::timer total;
+    for (unsigned int i = 0; i < switches; i++)
+    {
+        const bench::timer t;
+        if (!engine.load(tunes[i & 1].get()))
+        {
+            std::cerr << engine.error() << std::endl;
+            return EXIT_FAILURE;
+        }
+        loadTime += t.elapsed();
+
+        engine.play(buffer.data(), buffer.size());
+    }
+    const double elapsed = total.elapsed();
+
+    std::cout << std::fixed << std::setprecision(1)
+              << switches << " switches, load " << loadTime * 1e6 / switches << " us, "
+              << "load + 20 ms of audio " << elapsed * 1e6 / switches << " us" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -186,6 +186,20 @@ public:
      * available only for reSID.
      */
     bool fastSampling = false;
+
+    /**
+     * Clock the SID chips of multi-SID tunes in parallel,
+     * one thread per chip. The output is unchanged.
+     * Available only for emulated SIDs.
+     */
+    bool threadedSids = false;
+
+    /**
+     * Also produce the output of each voice of each SID,
+     * in a single pass, see sidplayfp::play.
+     * Available only for reSIDfp.
+     */
+    bool voiceOutputs = false;
 };
 
 #endif // SIDCONFIG_H
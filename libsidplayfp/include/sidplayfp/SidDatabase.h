@@ -26,7 +26,9 @@
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <string_view>
+#include <vector>
 
 #include <sidplayfp/siddefs.h>
 
@@ -35,6 +37,7 @@ class SidTune;
 namespace libsidplayfp
 {
 class iniParser;
+class songlengthIndex;
 }
 
 /**
@@ -50,11 +53,36 @@ public:
     /**
      * Open the songlength DataBase.
      *
+     * If an up to date index compiled with #compile is found
+     * next to the database, named as the database plus ".idx",
+     * it is used instead of parsing the text file.
+     * The filename may also name a compiled index directly.
+     *
      * @param filename songlengthDB file name with full path.
      * @return false in case of errors, true otherwise.
      */
     bool open(const char *filename);
 
+    /**
+     * Compile the songlength DataBase into a binary index
+     * that opens without parsing and is shared between processes.
+     *
+     * @param filename songlengthDB file name with full path.
+     * @param indexFile the index file to write.
+     * @return false in case of errors, true otherwise.
+     */
+    static bool compile(const char *filename, const char *indexFile);
+
+    /**
+     * Format the lengths of a tune as a line of the songlength DataBase,
+     * in the "md5=m:ss.SSS m:ss.SSS ..." form.
+     *
+     * @param md5 the md5 hash of the tune.
+     * @param lengthsMs the length of each subtune in milliseconds.
+     * @return the line, without line terminator.
+     */
+    static std::string formatEntry(std::string_view md5, const std::vector<std::uint_least32_t> &lengthsMs);
+
     /**
      * Close the songlength DataBase.
      */
@@ -103,6 +131,7 @@ public:
 
 private:
     std::unique_ptr<libsidplayfp::iniParser> m_parser;
+    std::unique_ptr<libsidplayfp::songlengthIndex> m_index;
 
     const char* errorString;
 };
@@ -28,6 +28,7 @@
 
 #include <sidplayfp/siddefs.h>
 
+class SidTuneCache;
 class SidTuneInfo;
 
 namespace libsidplayfp
@@ -81,13 +82,23 @@ public:
     /**
      * The SidTune class does not copy the list of file name extensions,
      * so make sure you keep it. If the provided pointer is 0, the
-     * default list will be activated. This is a static list which
-     * is used by all SidTune objects.
+     * default list will be activated. The list only applies to this
+     * object, so that tunes can be loaded from several threads at once.
      *
      * @param fileNameExt
      */
     void setFileNameExtensions(const char* const* fileNameExt);
 
+    /**
+     * Use a cache of parsed tunes for the following loads.
+     * The SidTune class does not take ownership of the cache,
+     * so make sure it outlives this object. Pass 0 to stop
+     * using the cache.
+     *
+     * @param cache
+     */
+    void setCache(SidTuneCache* cache);
+
     /**
      * Load a sidtune into an existing object from a file.
      *
@@ -167,7 +178,7 @@ public:
     const uint_least8_t* c64Data() const;
 
 private:
-    /// Filename extensions to append for various file types.
+    /// Default filename extensions to append for various file types.
     static const char* const* fileNameExtensions;
 
     std::unique_ptr<libsidplayfp::SidTuneBase> tune;
@@ -175,6 +186,11 @@ private:
     const char* m_statusString;
 
     bool m_status = false;
+
+    SidTuneCache* m_cache = nullptr;
+
+    /// Filename extensions used by this object.
+    const char* const* m_fileNameExtensions = fileNameExtensions;
 };
 
 #endif  /* SIDTUNE_H */
@@ -0,0 +1,93 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef SIDTUNECACHE_H
+#define SIDTUNECACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <sidplayfp/siddefs.h>
+
+namespace libsidplayfp
+{
+class tuneCache;
+}
+
+/**
+ * SidTuneCache
+ * A cache of parsed tunes that can be shared by several #SidTune objects.
+ *
+ * Tunes are keyed by a hash of the whole file contents and a match
+ * is confirmed by comparing the bytes, so a tune loaded again,
+ * even under a different name, is not parsed anew.
+ * A file is still read in full before the lookup, only a tune
+ * read from a buffer has its data not copied.
+ * Only PSID/RSID tunes are cached, the other formats depend on
+ * the file name or on a second file.
+ * The cache can be used from several threads at once.
+ */
+class SID_EXTERN SidTuneCache
+{
+    friend class SidTune;
+
+public:
+    /**
+     * @param capacity the maximum number of tunes to keep,
+     *        the least recently used one is dropped first.
+     */
+    explicit SidTuneCache(std::size_t capacity = 256);
+    ~SidTuneCache();
+
+    SidTuneCache(const SidTuneCache&) = delete;
+    SidTuneCache& operator=(const SidTuneCache&) = delete;
+
+    /**
+     * Drop all the cached tunes.
+     * Tunes already loaded are not affected.
+     */
+    void clear();
+
+    /**
+     * Number of cached tunes.
+     */
+    std::size_t size() const;
+
+    /**
+     * Maximum number of cached tunes.
+     */
+    std::size_t capacity() const;
+
+    /**
+     * Number of loads served from the cache.
+     */
+    std::uint64_t hits() const;
+
+    /**
+     * Number of loads that had to parse the tune.
+     */
+    std::uint64_t misses() const;
+
+private:
+    std::unique_ptr<libsidplayfp::tuneCache> m_cache;
+};
+
+#endif // SIDTUNECACHE_H
@@ -23,6 +23,8 @@
 #ifndef RESIDFP_H
 #define RESIDFP_H
 
+#include <cstddef>
+
 #include "sidplayfp/sidbuilder.h"
 #include "sidplayfp/siddefs.h"
 
@@ -52,6 +54,41 @@ public:
 
     const char *credits() const;
 
+    /**
+     * Precompute the resampler tables for the given
+     * output frequencies and all the supported C64 models,
+     * so that the first tune played at those rates
+     * doesn't pay for building them.
+     * The tables are shared process-wide, this can be called
+     * once at startup from any thread.
+     *
+     * @param frequencies the sampling frequencies
+     * @param count the number of frequencies
+     */
+    static void prewarm(const unsigned int* frequencies, std::size_t count);
+
+    /**
+     * Build the filter model tables and save them to a file
+     * for #loadFilterTables.
+     *
+     * @param path the file name
+     * @return false if the file could not be written
+     */
+    static bool saveFilterTables(const char* path);
+
+    /**
+     * Map the filter model tables from a file written by
+     * #saveFilterTables instead of building them when the first
+     * SID is created. The file is mapped read-only so the
+     * tables are shared by all the processes using it.
+     * Must be called before the first #create, files written
+     * by a different version of the library are rejected.
+     *
+     * @param path the file name
+     * @return true if the tables from the file are used
+     */
+    static bool loadFilterTables(const char* path);
+
     /// @name global settings
     /// Settings that affect all SIDs.
     //@{
@@ -26,13 +26,16 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
+#include <vector>
 
 #include <sidplayfp/siddefs.h>
 
 class EventContext;
 class SidConfig;
+class SidDatabase;
 class SidInfo;
 class SidTune;
+class sidsink;
 
 // Private Sidplayer
 namespace libsidplayfp
@@ -95,6 +98,44 @@ public:
      */
     bool load(SidTune *tune);
 
+    /**
+     * Move the loaded tune to the given time from its start.
+     * The machine is emulated exactly up to that point but the
+     * SIDs skip audio production, which is much faster than
+     * fast forwarding. Seeking backwards restarts the tune.
+     * Check #error for detailed message if something goes wrong.
+     *
+     * @param ms the position in milliseconds
+     * @return true on success, false otherwise.
+     */
+    bool seek(uint_least32_t ms);
+
+    /**
+     * Save the state of the emulated machine, including the SIDs.
+     * The state can only be restored into an engine with the
+     * same tune, subtune and configuration loaded, and by
+     * the same build of the library.
+     * Only supported by the software emulations (ReSID and ReSIDfp).
+     * Check #error for detailed message if something goes wrong.
+     *
+     * @param state the buffer receiving the state
+     * @return true on success, false otherwise.
+     */
+    bool saveState(std::vector<uint8_t> &state);
+
+    /**
+     * Restore a state saved with #saveState.
+     * Playback continues from the saved point, producing the same
+     * output as the engine it was saved from.
+     * On failure the tune is restarted.
+     * Check #error for detailed message if something goes wrong.
+     *
+     * @param data the saved state
+     * @param size the size of the state in bytes
+     * @return true on success, false otherwise.
+     */
+    bool loadState(const uint8_t *data, std::size_t size);
+
     /**
      * Run the emulation and produce samples to play if a buffer is given.
      *
@@ -107,6 +148,139 @@ public:
      */
     std::size_t play(short *buffer, std::size_t count);
 
+    /**
+     * Run the emulation and produce 32 bit samples.
+     * The samples are neither clipped to 16 bits before mixing
+     * nor dithered, the 16 bit full scale maps to the 32 bit one.
+     *
+     * @param buffer pointer to the buffer to fill with samples.
+     * @param count the size of the buffer measured in 32 bit samples
+     * @return the number of produced samples.
+     */
+    std::size_t play(int32_t *buffer, std::size_t count);
+
+    /**
+     * Run the emulation and produce floating point samples.
+     * The samples are neither clipped nor dithered,
+     * the 16 bit full scale maps to [-1.0,1.0].
+     * The chips still produce integer samples at 16 bit resolution,
+     * so only the headroom and the mix gain precision.
+     *
+     * @param buffer pointer to the buffer to fill with samples.
+     * @param count the size of the buffer measured in samples
+     * @return the number of produced samples.
+     */
+    std::size_t play(float *buffer, std::size_t count);
+
+    /**
+     * Run the emulation producing the mixed samples and,
+     * if enabled with SidConfig::voiceOutputs, the output
+     * of each voice of each SID in a single pass.
+     * The voices are taken before the filter and the volume control,
+     * each one through its own resampler, and are neither mixed
+     * nor dithered.
+     *
+     * @param buffer pointer to the buffer to fill with mixed samples.
+     * @param count the size of the buffer measured in samples
+     * @param voices three buffers per SID in SID order, each receiving
+     *               one sample per mixed frame, that is count/channels
+     * @return the number of produced mixed samples.
+     */
+    std::size_t play(short *buffer, std::size_t count, short *const *voices);
+
+    /**
+     * 32 bit variant of the voice output #play.
+     */
+    std::size_t play(int32_t *buffer, std::size_t count, int32_t *const *voices);
+
+    /**
+     * Floating point variant of the voice output #play.
+     */
+    std::size_t play(float *buffer, std::size_t count, float *const *voices);
+
+    /**
+     * Run the emulation without producing samples,
+     * same as passing a null 16 bit buffer.
+     */
+    std::size_t play(std::nullptr_t, std::size_t count);
+
+    /**
+     * Render a subtune offline as fast as possible.
+     * The tune is loaded, the subtune selected and the emulation
+     * run from the start, delivering the samples to the sink
+     * in blocks of the requested size. The engine is left stopped.
+     * A sink returning false ends the rendering early,
+     * this is not an error.
+     * Check #error for detailed message if something goes wrong,
+     * the samples rendered before the failure have been delivered.
+     *
+     * @param tune the SidTune to render
+     * @param song the subtune to render (0 = default starting song)
+     * @param lengthMs the length of audio to render in milliseconds
+     * @param sink the receiver of the rendered samples
+     * @param rendered set to the number of rendered samples
+     * @param blockSize the size of each block in 16 bit samples,
+     *                  0 selects a sensible default
+     * @return true on success, false on error
+     */
+    bool renderToSink(SidTune* tune, unsigned int song, uint_least32_t lengthMs,
+                      sidsink& sink, std::size_t& rendered, std::size_t blockSize = 0);
+
+    /**
+     * Render a subtune offline as fast as possible,
+     * taking its length from the songlength database.
+     *
+     * @param tune the SidTune to render
+     * @param song the subtune to render (0 = default starting song)
+     * @param database the songlength database
+     * @param sink the receiver of the rendered samples
+     * @param rendered set to the number of rendered samples
+     * @param blockSize the size of each block in 16 bit samples,
+     *                  0 selects a sensible default
+     * @return true on success, false on error
+     */
+    bool renderToSink(SidTune* tune, unsigned int song, SidDatabase& database,
+                      sidsink& sink, std::size_t& rendered, std::size_t blockSize = 0);
+
+    /**
+     * Render a subtune offline into a caller supplied buffer.
+     * Rendering stops when either the buffer is full or
+     * the requested length has been reached.
+     * Check #error for detailed message if something goes wrong,
+     * the buffer then holds the samples rendered before the failure.
+     *
+     * @param tune the SidTune to render
+     * @param song the subtune to render (0 = default starting song)
+     * @param lengthMs the length of audio to render in milliseconds
+     * @param buffer pointer to the buffer to fill with samples
+     * @param count the size of the buffer measured in 16 bit samples
+     * @param rendered set to the number of rendered samples
+     * @return true on success, false on error
+     */
+    bool renderToBuffer(SidTune* tune, unsigned int song, uint_least32_t lengthMs,
+                        short* buffer, std::size_t count, std::size_t& rendered);
+
+    /**
+     * Estimate the length of a subtune missing from
+     * the songlength database.
+     * The emulation runs as fast as possible with the SIDs
+     * not producing audio. The tune ends where a silence
+     * lasting the given time starts, or where the machine
+     * gets back to a state it has already been in, as the
+     * tune is then starting over. The engine is left stopped.
+     * Check #error for detailed message if something goes wrong.
+     *
+     * @param tune the SidTune to analyse
+     * @param song the subtune (0 = default starting song)
+     * @param maxLengthMs give up after this time
+     * @param silenceMs the length of the silence ending a tune
+     * @return the length in milliseconds, 0 if no end was found
+     *         within maxLengthMs, -1 on error
+     */
+    int_least32_t estimateLength(SidTune* tune, unsigned int song,
+                                 uint_least32_t maxLengthMs = 600000,
+                                 uint_least32_t silenceMs = 3000);
+
     /**
      * Check if the engine is playing or stopped.
      *
@@ -0,0 +1,51 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef SIDSINK_H
+#define SIDSINK_H
+
+#include <cstddef>
+
+#include <sidplayfp/siddefs.h>
+
+/**
+ * Base class for receivers of offline rendered audio.
+ *
+ * Used with sidplayfp::renderToSink, which calls #write
+ * once for every rendered block.
+ */
+class SID_EXTERN sidsink
+{
+public:
+    virtual ~sidsink() = default;
+
+    /**
+     * Receive a block of rendered samples.
+     * Stereo samples are interleaved.
+     *
+     * @param buffer the rendered samples, valid only during the call
+     * @param count the number of 16 bit samples in the buffer
+     * @return false to stop rendering, which is not
+     *         reported as an error, true to continue
+     */
+    virtual bool write(const short* buffer, std::size_t count) = 0;
+};
+
+#endif // SIDSINK_H
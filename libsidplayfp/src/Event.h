@@ -60,6 +60,21 @@ private:
     /// The next event in sequence.
     Event* next = nullptr;
 
+#ifdef EVENT_TIMING_WHEEL
+    /// The previous event in the same timing wheel slot.
+    Event* prev = nullptr;
+
+    /// Special values for heapIndex.
+    static constexpr int NOT_PENDING = -2;
+    static constexpr int IN_WHEEL = -1;
+
+    /// Position in the overflow heap, or one of the special values above.
+    int heapIndex = NOT_PENDING;
+
+    /// Insertion order, used to keep FIFO ordering in the overflow heap.
+    uint_least64_t sequence = 0;
+#endif
+
     /// The clock this event fires.
     event_clock_t triggerTime{};
 
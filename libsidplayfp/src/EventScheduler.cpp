@@ -22,9 +22,237 @@
 
 #include "EventScheduler.h"
 
+#include <algorithm>
+#include <cstdint>
+
+#include "Snapshot.h"
+
 namespace libsidplayfp
 {
 
+namespace
+{
+/// Sanity limit for corrupted snapshots, the c64 has a couple dozen events.
+constexpr std::uint32_t MAX_SNAPSHOT_EVENTS = 1024;
+}
+
+void EventScheduler::serialize(Snapshot& s)
+{
+    event_clock_t time = currentTime;
+    s(time);
+
+    std::uint32_t count = 0;
+    if (!s.loading())
+    {
+        pendingEvents(snapshotEvents);
+        count = static_cast<std::uint32_t>(snapshotEvents.size());
+    }
+    s(count);
+
+    if (s.loading())
+    {
+        s.check(count <= MAX_SNAPSHOT_EVENTS);
+        if (!s.good())
+            return;
+
+        reset();
+        currentTime = time;
+        snapshotEvents.assign(count, nullptr);
+    }
+}
+
+void EventScheduler::serialize(Snapshot& s, Event& event)
+{
+    std::int32_t index = -1;
+    if (!s.loading())
+    {
+        const auto it = std::find(snapshotEvents.begin(), snapshotEvents.end(), &event);
+        if (it != snapshotEvents.end())
+            index = static_cast<std::int32_t>(it - snapshotEvents.begin());
+    }
+    s(index);
+
+    if (index < 0)
+        return;
+
+    event_clock_t time = event.triggerTime;
+    s(time);
+
+    if (s.loading())
+    {
+        const bool valid = static_cast<std::size_t>(index) < snapshotEvents.size()
+            && snapshotEvents[index] == nullptr
+            && time >= currentTime;
+        s.check(valid);
+        if (valid)
+        {
+            event.triggerTime = time;
+            snapshotEvents[index] = &event;
+        }
+    }
+}
+
+void EventScheduler::commit(Snapshot& s)
+{
+    if (s.loading())
+    {
+        s.check(std::find(snapshotEvents.begin(), snapshotEvents.end(), nullptr) == snapshotEvents.end());
+        if (s.good())
+        {
+            // Events due at the same time are queued after each other
+            for (Event *event : snapshotEvents)
+                schedule(*event);
+        }
+    }
+
+    snapshotEvents.clear();
+}
+
+#ifdef EVENT_TIMING_WHEEL
+
+void EventScheduler::reset()
+{
+    for (slot_t &slot : wheel)
+    {
+        for (Event *scan = slot.first; scan != nullptr; scan = scan->next)
+            scan->heapIndex = Event::NOT_PENDING;
+        slot.first = slot.last = nullptr;
+    }
+    occupied.fill(0);
+
+    for (Event *event : overflow)
+        event->heapIndex = Event::NOT_PENDING;
+    overflow.clear();
+
+    sequence = 0;
+    currentTime = 0;
+}
+
+void EventScheduler::cancel(const Event &event)
+{
+    // Only the scheduler bookkeeping fields are touched
+    Event &e = const_cast<Event&>(event);
+
+    if (e.heapIndex == Event::IN_WHEEL)
+        wheelRemove(e);
+    else if (e.heapIndex >= 0)
+        heapRemove(e.heapIndex);
+}
+
+bool EventScheduler::isPending(const Event &event) const
+{
+    return event.heapIndex != Event::NOT_PENDING;
+}
+
+void EventScheduler::pendingEvents(std::vector<Event*>& events) const
+{
+    std::vector<Event*> far(overflow);
+    std::sort(far.begin(), far.end(), before);
+    auto next = far.begin();
+
+    events.clear();
+
+    // The wheel covers the near future starting from the current slot
+    const unsigned int start = static_cast<unsigned int>(currentTime) & WHEEL_MASK;
+    for (unsigned int i = 0; i < WHEEL_SIZE; i++)
+    {
+        for (Event *event = wheel[(start + i) & WHEEL_MASK].first; event != nullptr; event = event->next)
+        {
+            // Far events were queued before any wheel event due at the same time
+            while (next != far.end() && (*next)->triggerTime <= event->triggerTime)
+                events.push_back(*next++);
+
+            events.push_back(event);
+        }
+    }
+
+    events.insert(events.end(), next, far.end());
+}
+
+void EventScheduler::wheelRemove(Event &event)
+{
+    const unsigned int index = static_cast<unsigned int>(event.triggerTime) & WHEEL_MASK;
+    slot_t &slot = wheel[index];
+
+    if (event.prev != nullptr)
+        event.prev->next = event.next;
+    else
+        slot.first = event.next;
+
+    if (event.next != nullptr)
+        event.next->prev = event.prev;
+    else
+        slot.last = event.prev;
+
+    if (slot.first == nullptr)
+        occupied[index >> 6] &= ~(uint64_t(1) << (index & 63));
+
+    event.heapIndex = Event::NOT_PENDING;
+}
+
+void EventScheduler::heapInsert(Event &event)
+{
+    event.sequence = sequence++;
+    event.heapIndex = static_cast<int>(overflow.size());
+    overflow.push_back(&event);
+    heapUp(event.heapIndex);
+}
+
+void EventScheduler::heapRemove(int index)
+{
+    overflow[index]->heapIndex = Event::NOT_PENDING;
+
+    Event *last = overflow.back();
+    overflow.pop_back();
+
+    if (index < static_cast<int>(overflow.size()))
+    {
+        overflow[index] = last;
+        last->heapIndex = index;
+        heapUp(index);
+        heapDown(last->heapIndex);
+    }
+}
+
+void EventScheduler::heapUp(int index)
+{
+    Event *event = overflow[index];
+    while (index > 0)
+    {
+        const int parent = (index - 1) / 2;
+        if (!before(event, overflow[parent]))
+            break;
+        overflow[index] = overflow[parent];
+        overflow[index]->heapIndex = index;
+        index = parent;
+    }
+    overflow[index] = event;
+    event->heapIndex = index;
+}
+
+void EventScheduler::heapDown(int index)
+{
+    const int size = static_cast<int>(overflow.size());
+    Event *event = overflow[index];
+    while (true)
+    {
+        int child = 2 * index + 1;
+        if (child >= size)
+            break;
+        if (child + 1 < size && before(overflow[child + 1], overflow[child]))
+            child++;
+        if (!before(overflow[child], event))
+            break;
+        overflow[index] = overflow[child];
+        overflow[index]->heapIndex = index;
+        index = child;
+    }
+    overflow[index] = event;
+    event->heapIndex = index;
+}
+
+#else
+
 void EventScheduler::reset()
 {
     firstEvent = nullptr;
@@ -46,6 +274,14 @@ void EventScheduler::cancel(const Event &event)
     }
 }
 
+void EventScheduler::pendingEvents(std::vector<Event*>& events) const
+{
+    events.clear();
+
+    for (Event *scan = firstEvent; scan != nullptr; scan = scan->next)
+        events.push_back(scan);
+}
+
 bool EventScheduler::isPending(const Event &event) const
 {
     Event *scan = firstEvent;
@@ -60,4 +296,6 @@ bool EventScheduler::isPending(const Event &event) const
     return false;
 }
 
+#endif
+
 }
@@ -25,9 +25,18 @@
 
 #include "Event.h"
 
+#include <vector>
+
+#ifdef EVENT_TIMING_WHEEL
+#  include <array>
+#  include <cstdint>
+#endif
+
 namespace libsidplayfp
 {
 
+class Snapshot;
+
 /**
  * C64 system runs actions at system clock high and low
  * states. The PHI1 corresponds to the auxiliary chip activity
@@ -54,6 +63,13 @@ enum class EventPhase
  * Scheduling an event for a phi1 clock when system is in phi2 causes the
  * event to be moved to the next phi1 cycle. Correspondingly, requesting
  * a phi1 time when system is in phi2 returns the value of the next phi1.
+ *
+ * When built with EVENT_TIMING_WHEEL the linked list is replaced
+ * by a timing wheel covering the near future, with a binary heap
+ * for the events scheduled further away. Insertion and cancellation
+ * then take constant time, or logarithmic for the far events,
+ * regardless of how many events are pending.
+ * Events due at the same time still fire in insertion order.
  */
 class EventScheduler
 {
@@ -100,15 +116,104 @@ public:
      */
     void reset();
 
+    /**
+     * Save or restore the time and the number of pending events.
+     *
+     * The events are not known to the scheduler, so each component
+     * then passes its own events to serialize(Snapshot&, Event&)
+     * and, when restoring, commit() puts them back in the queue.
+     */
+    void serialize(Snapshot& s);
+
+    /**
+     * Save or restore the pending state of an event.
+     *
+     * The position in the queue is stored, rather than just the time,
+     * as events due at the same time must fire in the same order.
+     *
+     * @param s the snapshot
+     * @param event the event
+     */
+    void serialize(Snapshot& s, Event& event);
+
+    /**
+     * Finish saving or restoring. The restored events are queued
+     * in their original order, the snapshot is marked as inconsistent
+     * if some of the pending events were not restored.
+     *
+     * @param s the snapshot
+     */
+    void commit(Snapshot& s);
+
     /**
      * Fire next event, advance system time to that event.
      */
     void clock()
     {
+#ifdef EVENT_TIMING_WHEEL
+        Event *event = nextWheelEvent();
+
+        // Far events were queued before any wheel event due at the same time
+        if (!overflow.empty() && (event == nullptr || overflow.front()->triggerTime <= event->triggerTime))
+        {
+            event = overflow.front();
+            heapRemove(0);
+        }
+        else
+        {
+            // The earliest event is always the first of its slot
+            const unsigned int index = static_cast<unsigned int>(event->triggerTime) & WHEEL_MASK;
+            slot_t &slot = wheel[index];
+            slot.first = event->next;
+            if (slot.first != nullptr)
+                slot.first->prev = nullptr;
+            else
+            {
+                slot.last = nullptr;
+                occupied[index >> 6] &= ~(uint64_t(1) << (index & 63));
+            }
+            event->heapIndex = Event::NOT_PENDING;
+        }
+
+        currentTime = event->triggerTime;
+        event->event();
+#else
         Event &event = *firstEvent;
         firstEvent = firstEvent->next;
         currentTime = event.triggerTime;
         event.event();
+#endif
+    }
+
+    /**
+     * Let the event being fired run again after the given cycles
+     * without going through the queue.
+     *
+     * This is possible only when no pending event is due before,
+     * or at the same time as, the event would fire if rescheduled,
+     * so the order of execution is unchanged.
+     *
+     * @param cycles how many cycles from now
+     * @return true if time was advanced, false if the event must be rescheduled
+     */
+    bool advance(unsigned int cycles)
+    {
+        const event_clock_t time = currentTime + (cycles << 1);
+
+#ifdef EVENT_TIMING_WHEEL
+        if (!overflow.empty() && overflow.front()->triggerTime <= time)
+            return false;
+
+        const Event *event = nextWheelEvent();
+        if (event != nullptr && event->triggerTime <= time)
+            return false;
+#else
+        if (firstEvent != nullptr && firstEvent->triggerTime <= time)
+            return false;
+#endif
+
+        currentTime = time;
+        return true;
     }
 
     /**
@@ -150,6 +255,130 @@ public:
     EventPhase phase() const { return static_cast<EventPhase>(currentTime & 1); }
 
 private:
+#ifdef EVENT_TIMING_WHEEL
+    /// Number of half cycles covered by the timing wheel, must be a power of 2.
+    static constexpr unsigned int WHEEL_SIZE = 512;
+
+    static constexpr unsigned int WHEEL_MASK = WHEEL_SIZE - 1;
+
+    /// Number of words in the slot occupancy bitmap.
+    static constexpr unsigned int WHEEL_WORDS = WHEEL_SIZE / 64;
+
+    /// A timing wheel slot, events are kept in insertion order.
+    struct slot_t
+    {
+        Event* first;
+        Event* last;
+    };
+
+    /**
+     * Add event to the timing wheel or to the overflow heap.
+     *
+     * @param event The event to add
+     */
+    void schedule(Event& event)
+    {
+        if (event.triggerTime - currentTime < WHEEL_SIZE)
+        {
+            const unsigned int index = static_cast<unsigned int>(event.triggerTime) & WHEEL_MASK;
+            slot_t &slot = wheel[index];
+
+            event.next = nullptr;
+            event.prev = slot.last;
+            event.heapIndex = Event::IN_WHEEL;
+
+            if (slot.last != nullptr)
+                slot.last->next = &event;
+            else
+            {
+                slot.first = &event;
+                occupied[index >> 6] |= uint64_t(1) << (index & 63);
+            }
+            slot.last = &event;
+        }
+        else
+        {
+            heapInsert(event);
+        }
+    }
+
+    /**
+     * Find the earliest event in the timing wheel.
+     *
+     * All the events in the wheel are due within WHEEL_SIZE half cycles,
+     * so scanning the slots from the current time gives them in order.
+     *
+     * @return the event or nullptr if the wheel is empty
+     */
+    Event* nextWheelEvent() const
+    {
+        const unsigned int start = static_cast<unsigned int>(currentTime) & WHEEL_MASK;
+
+        // Most events are due within a couple of cycles, probe those slots directly
+        for (unsigned int i = 0; i < 4; i++)
+        {
+            Event *event = wheel[(start + i) & WHEEL_MASK].first;
+            if (event != nullptr)
+                return event;
+        }
+
+        unsigned int word = start >> 6;
+        uint64_t bits = occupied[word] & (~uint64_t(0) << (start & 63));
+
+        // One extra iteration to check the slots before start in the first word
+        for (unsigned int i = 0; i <= WHEEL_WORDS; i++)
+        {
+            if (bits != 0)
+                return wheel[((word << 6) + lowestBit(bits)) & WHEEL_MASK].first;
+
+            word = (word + 1) % WHEEL_WORDS;
+            bits = occupied[word];
+        }
+
+        return nullptr;
+    }
+
+    static unsigned int lowestBit(uint64_t bits)
+    {
+#if defined(__GNUC__)
+        return __builtin_ctzll(bits);
+#else
+        unsigned int n = 0;
+        while ((bits & 1) == 0)
+        {
+            bits >>= 1;
+            n++;
+        }
+        return n;
+#endif
+    }
+
+    void wheelRemove(Event &event);
+
+    void heapInsert(Event &event);
+    void heapRemove(int index);
+    void heapUp(int index);
+    void heapDown(int index);
+
+    /// Heap ordering, earlier trigger time first then insertion order.
+    static bool before(const Event *a, const Event *b)
+    {
+        return a->triggerTime < b->triggerTime
+            || (a->triggerTime == b->triggerTime && a->sequence < b->sequence);
+    }
+
+    /// Events due within WHEEL_SIZE half cycles.
+    std::array<slot_t, WHEEL_SIZE> wheel {};
+
+    /// One bit for each non empty slot.
+    std::array<uint64_t, WHEEL_WORDS> occupied {};
+
+    /// Binary heap of the events due later.
+    std::vector<Event*> overflow;
+
+    /// Insertion counter for the heap.
+    uint_least64_t sequence = 0;
+#else
     /**
      * Scan the event queue and schedule event for execution.
      *
@@ -173,6 +402,15 @@ private:
 
     /// The first event of the chain.
     Event* firstEvent = nullptr;
+#endif
+
+    /**
+     * Collect the pending events in the order they will fire.
+     */
+    void pendingEvents(std::vector<Event*>& events) const;
+
+    /// Pending events being saved or restored, in firing order.
+    std::vector<Event*> snapshotEvents;
 
     /// EventScheduler's current clock.
     event_clock_t currentTime{};
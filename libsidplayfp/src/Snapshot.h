@@ -0,0 +1,128 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace libsidplayfp
+{
+
+/**
+ * Binary machine state, either being saved or restored.
+ *
+ * Components describe their state once by passing each field
+ * to operator(), the direction is chosen when constructing the object,
+ * so that saving and restoring can't get out of step.
+ * The configuration is not part of the state and must be the same
+ * when restoring. The format is that of the host and is not meant
+ * to be exchanged between different builds.
+ */
+class Snapshot
+{
+public:
+    /**
+     * Save the state at the end of the given buffer.
+     */
+    explicit Snapshot(std::vector<uint8_t>& out) :
+        m_out(&out) {}
+
+    /**
+     * Restore the state from the given data.
+     */
+    Snapshot(const uint8_t* data, std::size_t size) :
+        m_in(data),
+        m_end(data + size) {}
+
+    bool loading() const { return m_out == nullptr; }
+
+    /**
+     * False if the data was too short or inconsistent.
+     */
+    bool good() const { return m_status; }
+
+    /**
+     * True when all the data has been consumed.
+     */
+    bool atEnd() const { return m_in == m_end; }
+
+    /**
+     * Mark the data as inconsistent if the condition is false.
+     */
+    void check(bool condition) { m_status = m_status && condition; }
+
+    template<typename T>
+    void operator()(T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain data can be stored");
+        io(&value, sizeof(T));
+    }
+
+    void io(void* data, std::size_t size)
+    {
+        if (m_out != nullptr)
+        {
+            const uint8_t* const p = static_cast<const uint8_t*>(data);
+            m_out->insert(m_out->end(), p, p + size);
+        }
+        else
+        {
+            const uint8_t* const p = consume(size);
+            if (p != nullptr)
+                std::memcpy(data, p, size);
+        }
+    }
+
+    /**
+     * Skip over a block of data being restored.
+     *
+     * @param size the block size
+     * @return the block, or nullptr if the data is too short
+     */
+    const uint8_t* consume(std::size_t size)
+    {
+        if (!m_status || size > static_cast<std::size_t>(m_end - m_in))
+        {
+            m_status = false;
+            return nullptr;
+        }
+
+        const uint8_t* const p = m_in;
+        m_in += size;
+        return p;
+    }
+
+private:
+    std::vector<uint8_t>* const m_out = nullptr;
+
+    const uint8_t* m_in = nullptr;
+    const uint8_t* const m_end = nullptr;
+
+    bool m_status = true;
+};
+
+}
+
+#endif // SNAPSHOT_H
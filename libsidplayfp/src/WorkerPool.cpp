@@ -0,0 +1,110 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "WorkerPool.h"
+
+#include <cassert>
+
+namespace libsidplayfp
+{
+
+WorkerPool::WorkerPool(unsigned int threads)
+{
+    m_threads.reserve(threads);
+    for (unsigned int i = 0; i < threads; i++)
+    {
+        m_threads.emplace_back(&WorkerPool::worker, this, i + 1);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_start.notify_all();
+
+    for (std::thread &t : m_threads)
+    {
+        t.join();
+    }
+}
+
+void WorkerPool::run(unsigned int count, const job_t &job)
+{
+    assert(count <= size() + 1);
+
+    if (count > 1)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_job = &job;
+            m_count = count;
+            m_pending = count - 1;
+            m_generation++;
+        }
+        m_start.notify_all();
+    }
+
+    if (count > 0)
+        job(0);
+
+    if (count > 1)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return m_pending == 0; });
+        m_job = nullptr;
+    }
+}
+
+void WorkerPool::worker(unsigned int index)
+{
+    unsigned long generation = 0;
+
+    for (;;)
+    {
+        const job_t *job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_start.wait(lock, [this, generation] { return m_quit || m_generation != generation; });
+            if (m_quit)
+                return;
+
+            generation = m_generation;
+            if (index >= m_count)
+                continue;
+
+            job = m_job;
+        }
+
+        (*job)(index);
+
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            last = --m_pending == 0;
+        }
+        if (last)
+            m_done.notify_one();
+    }
+}
+
+}
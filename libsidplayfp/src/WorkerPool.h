@@ -0,0 +1,100 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace libsidplayfp
+{
+
+/**
+ * A small set of persistent threads running the same job
+ * on different indices.
+ *
+ * The threads are started once and then sleep between jobs,
+ * so that dispatching a job costs a couple of context switches
+ * rather than a thread creation.
+ */
+class WorkerPool
+{
+public:
+    using job_t = std::function<void(unsigned int)>;
+
+public:
+    /**
+     * Start the worker threads.
+     *
+     * @param threads the number of threads, in addition to the caller
+     */
+    explicit WorkerPool(unsigned int threads);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * Number of worker threads.
+     */
+    unsigned int size() const { return static_cast<unsigned int>(m_threads.size()); }
+
+    /**
+     * Run job(i) for every i in [0, count) and wait for completion.
+     * Index 0 runs on the calling thread, index i on worker i-1.
+     * The job must not throw.
+     *
+     * @param count number of indices, at most size() + 1
+     * @param job the job to run
+     */
+    void run(unsigned int count, const job_t &job);
+
+private:
+    void worker(unsigned int index);
+
+private:
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_start;
+    std::condition_variable m_done;
+
+    /// The job being run, valid while m_pending is not zero
+    const job_t *m_job = nullptr;
+
+    /// Number of indices in the current job
+    unsigned int m_count = 0;
+
+    /// Number of workers still running the current job
+    unsigned int m_pending = 0;
+
+    /// Incremented for each job so that workers don't run it twice
+    unsigned long m_generation = 0;
+
+    bool m_quit = false;
+};
+
+}
+
+#endif // WORKERPOOL_H
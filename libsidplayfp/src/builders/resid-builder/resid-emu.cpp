@@ -22,10 +22,13 @@
 
 #include "resid-emu.h"
 
+#include <algorithm>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "resid/siddefs.h"
+#include "Snapshot.h"
 
 namespace libsidplayfp
 {
@@ -53,13 +56,15 @@ ReSID::ReSID(sidbuilder *builder) :
     m_sid(*(new reSID::SID)),
     m_voiceMask(0x07)
 {
-    m_buffer = new short[OUTPUTBUFFERSIZE];
+    m_buffer = new int[BUFFERSIZE];
+    m_samples = new short[OUTPUTBUFFERSIZE];
     reset(0);
 }
 
 ReSID::~ReSID()
 {
     delete &m_sid;
+    delete[] m_samples;
     delete[] m_buffer;
 }
 
@@ -72,6 +77,7 @@ void ReSID::bias(double dac_bias)
 void ReSID::reset(uint8_t volume)
 {
     m_accessClk = 0;
+    m_writes.clear();
     m_sid.reset();
     m_sid.write(0x18, volume);
 }
@@ -84,15 +90,73 @@ uint8_t ReSID::read(uint_least8_t addr)
 
 void ReSID::write(uint_least8_t addr, uint8_t data)
 {
+    if (m_deferWrites)
+    {
+        m_writes.push_back({ eventScheduler->getTime(EventPhase::ClockPHI1), addr, data });
+        return;
+    }
+
     clock();
     m_sid.write(addr, data);
 }
 
+bool ReSID::deferWrites(bool enable)
+{
+    m_deferWrites = enable;
+    return true;
+}
+
+void ReSID::clockTo(event_clock_t clk)
+{
+    auto cycles = static_cast<reSID::cycle_count>(clk - m_accessClk);
+    m_accessClk = clk;
+
+    if (m_silent)
+        m_sid.clock_silent(cycles);
+    else
+    {
+        // reSID produces 16 bit samples
+        const int room = std::min<int>(OUTPUTBUFFERSIZE, BUFFERSIZE - m_bufferpos);
+        const int samples = m_sid.clock(cycles, m_samples, room, 1);
+        std::copy(m_samples, m_samples + samples, m_buffer + m_bufferpos);
+        m_bufferpos += samples;
+    }
+}
+
 void ReSID::clock()
 {
-    auto cycles = static_cast<reSID::cycle_count>(eventScheduler->getTime(m_accessClk, EventPhase::ClockPHI1));
-    m_accessClk += cycles;
-    m_bufferpos += m_sid.clock(cycles, m_buffer + m_bufferpos, OUTPUTBUFFERSIZE - m_bufferpos, 1);
+    // Replay the queued writes at the cycle they happened
+    for (const write_t &w : m_writes)
+    {
+        clockTo(w.clk);
+        m_sid.write(w.addr, w.data);
+    }
+    m_writes.clear();
+
+    clockTo(eventScheduler->getTime(EventPhase::ClockPHI1));
+}
+
+bool ReSID::serialize(Snapshot& s)
+{
+    serializeCommon(s);
+
+    if (!s.loading())
+    {
+        std::vector<unsigned char> state;
+        m_sid.save_state(state);
+        std::uint32_t size = static_cast<std::uint32_t>(state.size());
+        s(size);
+        s.io(state.data(), size);
+    }
+    else
+    {
+        std::uint32_t size = 0;
+        s(size);
+        const uint8_t* data = s.consume(size);
+        s.check(data != nullptr && m_sid.load_state(data, size));
+    }
+
+    return true;
 }
 
 void ReSID::filter(bool enable)
@@ -137,6 +201,11 @@ void ReSID::voice(unsigned int num, bool mute)
     m_sid.set_voice_mask(m_voiceMask);
 }
 
+uint8_t ReSID::envelope(unsigned int num) const
+{
+    return m_sid.read_state().envelope_counter[num];
+}
+
 // Set the emulated SID model
 void ReSID::model(SidConfig::SIDModel model, bool digiboost)
 {
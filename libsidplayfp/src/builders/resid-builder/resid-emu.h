@@ -43,6 +43,11 @@ class ReSID final : public sidemu
 private:
     reSID::SID   &m_sid;
     uint8_t       m_voiceMask;
+    short        *m_samples;
+    bool          m_silent = false;
+
+private:
+    void clockTo(event_clock_t clk);
 
 public:
     static const char* getCredits();
@@ -62,11 +67,19 @@ public:
     // Standard SID emu functions
     void clock() override;
 
+    bool deferWrites(bool enable) override;
+
+    bool serialize(Snapshot& s) override;
+
+    void silent(bool enable) override { m_silent = enable; }
+
     void sampling(float systemclock, float freq,
         SidConfig::SamplingMethod method, bool fast) override;
 
     void voice(unsigned int num, bool mute) override;
 
+    uint8_t envelope(unsigned int num) const override;
+
     void model(SidConfig::SIDModel model, bool digiboost) override;
 
     // Specific to resid
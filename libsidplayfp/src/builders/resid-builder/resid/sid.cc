@@ -24,6 +24,11 @@
 
 #include "sid.h"
 #include <cmath>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <vector>
 
 #ifndef round
 #define round(x) (x>=0.0?floor(x+0.5):ceil(x-0.5))
@@ -32,6 +37,29 @@
 namespace reSID
 {
 
+// ----------------------------------------------------------------------------
+// FIR table cache.
+// The tables only depend on the sampling parameters, which are the same
+// for all the chips in a machine and seldom change, so they are computed
+// once and shared read-only by all the instances.
+// The cache only holds weak references, a table is freed together with
+// the last chip using it and expired entries are dropped on insertion.
+// Key: filter length, filter resolution, clock frequency, sample frequency,
+// filter scale. The pass frequency only affects the filter length.
+// ----------------------------------------------------------------------------
+namespace
+{
+typedef std::tuple<int, int, double, double, double> fir_key;
+
+typedef std::map<fir_key, std::weak_ptr<const std::vector<short> > > fir_map;
+
+fir_map fir_cache;
+
+// Guards fir_cache.
+std::mutex fir_cache_lock;
+}
+
+
 // ----------------------------------------------------------------------------
 // Constructor.
 // ----------------------------------------------------------------------------
@@ -42,9 +70,6 @@ SID::SID()
   fir = nullptr;
   fir_N = 0;
   fir_RES = 0;
-  fir_beta = 0;
-  fir_f_cycles_per_sample = 0;
-  fir_filter_scale = 0;
 
   sid_model = MOS6581;
   voice[0].set_sync_source(&voice[2]);
@@ -67,7 +92,6 @@ SID::SID()
 SID::~SID()
 {
   delete[] sample;
-  delete[] fir;
 }
 
 
@@ -428,6 +452,98 @@ void SID::write_state(const State& state)
 }
 
 
+// ----------------------------------------------------------------------------
+// Complete state, stored as the raw components.
+// Pointers are kept or rebuilt when loading, the remaining fields
+// are plain data.
+// ----------------------------------------------------------------------------
+namespace {
+
+template<class T>
+void save_raw(std::vector<unsigned char>& out, const T& value, size_t count = 1)
+{
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(&value);
+  out.insert(out.end(), p, p + sizeof(T)*count);
+}
+
+template<class T>
+void load_raw(const unsigned char*& data, T& value, size_t count = 1)
+{
+  std::memcpy(&value, data, sizeof(T)*count);
+  data += sizeof(T)*count;
+}
+
+}
+
+void SID::save_state(std::vector<unsigned char>& out) const
+{
+  const bool resampling = sample != nullptr;
+  save_raw(out, cycles_per_sample);
+  save_raw(out, resampling);
+
+  for (int i = 0; i < 3; i++) {
+    save_raw(out, voice[i]);
+  }
+  save_raw(out, filter);
+  save_raw(out, extfilt);
+
+  save_raw(out, bus_value);
+  save_raw(out, bus_value_ttl);
+  save_raw(out, write_pipeline);
+  save_raw(out, write_address);
+
+  save_raw(out, sample_offset);
+  save_raw(out, sample_index);
+  save_raw(out, sample_prev);
+  save_raw(out, sample_now);
+  if (resampling) {
+    save_raw(out, *sample, RINGSIZE*2);
+  }
+}
+
+bool SID::load_state(const unsigned char* data, size_t size)
+{
+  // Sampling parameters must match, all the rest has a fixed size
+  std::vector<unsigned char> current;
+  save_state(current);
+  if (size != current.size()
+      || std::memcmp(data, current.data(), sizeof(cycles_per_sample) + sizeof(bool)) != 0) {
+    return false;
+  }
+
+  data += sizeof(cycles_per_sample) + sizeof(bool);
+
+  for (int i = 0; i < 3; i++) {
+    WaveformGenerator& wave = voice[i].wave;
+    const WaveformGenerator* sync_source = wave.sync_source;
+    WaveformGenerator* sync_dest = wave.sync_dest;
+
+    load_raw(data, voice[i]);
+
+    wave.sync_source = sync_source;
+    wave.sync_dest = sync_dest;
+    wave.wave = WaveformGenerator::model_wave[wave.sid_model][wave.waveform & 0x7];
+  }
+  load_raw(data, filter);
+  load_raw(data, extfilt);
+
+  load_raw(data, bus_value);
+  load_raw(data, bus_value_ttl);
+  load_raw(data, write_pipeline);
+  load_raw(data, write_address);
+
+  load_raw(data, sample_offset);
+  load_raw(data, sample_index);
+  load_raw(data, sample_prev);
+  load_raw(data, sample_now);
+  if (sample != nullptr) {
+    load_raw(data, *sample, RINGSIZE*2);
+  }
+
+  return true;
+}
+
+
 // ----------------------------------------------------------------------------
 // Mask for voices routed into the filter / audio output stage.
 // Used to physically connect/disconnect EXT IN, and for test purposed
@@ -560,8 +676,8 @@ bool SID::set_sampling_parameters(double clock_freq, sampling_method method,
   if (method != SAMPLE_RESAMPLE && method != SAMPLE_RESAMPLE_FASTMEM)
   {
     delete[] sample;
-    delete[] fir;
     sample = nullptr;
+    fir_table.reset();
     fir = nullptr;
     return true;
   }
@@ -613,21 +729,29 @@ bool SID::set_sampling_parameters(double clock_freq, sampling_method method,
   int n = (int)ceil(log(res/f_cycles_per_sample)/log(2.0f));
   int fir_RES_new = 1 << n;
 
-  /* Determine if we need to recalculate table, or whether we can reuse earlier cached copy.
-   * This pays off on slow hardware such as current Android devices.
-   */
-  if (fir && fir_RES_new == fir_RES && fir_N_new == fir_N && beta == fir_beta && f_cycles_per_sample == fir_f_cycles_per_sample && fir_filter_scale == filter_scale) {
-      return true;
-  }
   fir_RES = fir_RES_new;
   fir_N = fir_N_new;
-  fir_beta = beta;
-  fir_f_cycles_per_sample = f_cycles_per_sample;
-  fir_filter_scale = filter_scale;
 
-  // Allocate memory for FIR tables.
-  delete[] fir;
-  fir = new short[fir_N*fir_RES];
+  // The tables are expensive to compute, look them up in the cache first.
+  // This pays off on slow hardware such as current Android devices.
+  const fir_key key(fir_N, fir_RES, clock_freq, sample_freq, filter_scale);
+
+  {
+    std::lock_guard<std::mutex> lock(fir_cache_lock);
+    fir_map::const_iterator it = fir_cache.find(key);
+    if (it != fir_cache.end()) {
+      std::shared_ptr<const std::vector<short> > cached = it->second.lock();
+      if (cached) {
+        fir_table = cached;
+        fir = fir_table->data();
+        return true;
+      }
+    }
+  }
+
+  // Compute the tables outside the lock so that other sampling
+  // parameters can be set up concurrently.
+  std::shared_ptr<std::vector<short> > table(new std::vector<short>(fir_N*fir_RES));
 
   // Calculate fir_RES FIR tables for linear interpolation.
   for (int i = 0; i < fir_RES; i++) {
@@ -642,10 +766,31 @@ bool SID::set_sampling_parameters(double clock_freq, sampling_method method,
       double Kaiser = fabs(temp) <= 1 ? I0(beta*sqrt(1 - temp*temp))/I0beta : 0;
       double sincwt = fabs(wt) >= 1e-6 ? sin(wt)/wt : 1;
       double val = (1 << FIR_SHIFT)*filter_scale*f_samples_per_cycle*wc/pi*sincwt*Kaiser;
-      fir[fir_offset + j] = (short)round(val);
+      (*table)[fir_offset + j] = (short)round(val);
     }
   }
 
+  std::lock_guard<std::mutex> lock(fir_cache_lock);
+
+  // Drop the tables no longer used by any chip.
+  for (fir_map::iterator it = fir_cache.begin(); it != fir_cache.end();) {
+    if (it->second.expired())
+      it = fir_cache.erase(it);
+    else
+      ++it;
+  }
+
+  // If another thread got here first use its table.
+  std::weak_ptr<const std::vector<short> >& entry = fir_cache[key];
+  std::shared_ptr<const std::vector<short> > cached = entry.lock();
+  if (cached) {
+    fir_table = cached;
+  } else {
+    fir_table = table;
+    entry = fir_table;
+  }
+  fir = fir_table->data();
+
   return true;
 }
 
@@ -672,6 +817,37 @@ void SID::adjust_sampling_frequency(double sample_freq)
 // SID clocking - 1 cycle.
 // ----------------------------------------------------------------------------
 void SID::clock()
+{
+    clock_voices();
+
+    // Clock filter.
+    filter.clock(voice[0].output(), voice[1].output(), voice[2].output());
+
+    // Clock external filter.
+    extfilt.clock(filter.output());
+
+    clock_bus();
+}
+
+// ----------------------------------------------------------------------------
+// SID clocking without the filters - delta_t cycles.
+// Only the state visible through the registers is kept up to date,
+// exactly as the sampling clock functions do, to skip ahead quickly
+// when no audio is needed.
+// ----------------------------------------------------------------------------
+void SID::clock_silent(cycle_count delta_t)
+{
+    for (; delta_t > 0; delta_t--) {
+        clock_voices();
+        clock_bus();
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Envelope and oscillator clocking - 1 cycle.
+// ----------------------------------------------------------------------------
+RESID_INLINE
+void SID::clock_voices()
 {
     int i;
 
@@ -694,13 +870,14 @@ void SID::clock()
     for (i = 0; i < 3; i++) {
         voice[i].wave.set_waveform_output();
     }
+}
 
-    // Clock filter.
-    filter.clock(voice[0].output(), voice[1].output(), voice[2].output());
-
-    // Clock external filter.
-    extfilt.clock(filter.output());
-
+// ----------------------------------------------------------------------------
+// Write pipeline and bus clocking - 1 cycle.
+// ----------------------------------------------------------------------------
+RESID_INLINE
+void SID::clock_bus()
+{
     // Pipelined writes on the MOS8580.
     if (unlikely(write_pipeline)) {
         write();
@@ -972,7 +1149,7 @@ int SID::clock_resample(cycle_count& delta_t, short* buf, int n, int interleave)
 
     int fir_offset = sample_offset*fir_RES >> FIXP_SHIFT;
     int fir_offset_rmd = sample_offset*fir_RES & FIXP_MASK;
-    short* fir_start = fir + fir_offset*fir_N;
+    const short* fir_start = fir + fir_offset*fir_N;
     short* sample_start = sample + sample_index - fir_N - 1 + RINGSIZE;
 
     // Convolution with filter impulse response.
@@ -1047,7 +1224,7 @@ int SID::clock_resample_fastmem(cycle_count& delta_t, short* buf, int n, int int
     sample_offset = next_sample_offset & FIXP_MASK;
 
     int fir_offset = sample_offset*fir_RES >> FIXP_SHIFT;
-    short* fir_start = fir + fir_offset*fir_N;
+    const short* fir_start = fir + fir_offset*fir_N;
     short* sample_start = sample + sample_index - fir_N + RINGSIZE;
 
     // Convolution with filter impulse response.
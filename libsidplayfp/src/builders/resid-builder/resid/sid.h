@@ -32,6 +32,9 @@
 #include "extfilt.h"
 #include "pot.h"
 
+#include <memory>
+#include <vector>
+
 namespace reSID
 {
 
@@ -53,6 +56,7 @@ public:
 
   void clock();
   void clock(cycle_count delta_t);
+  void clock_silent(cycle_count delta_t);
   int clock(cycle_count& delta_t, short* buf, int n, int interleave = 1);
   void reset();
 
@@ -94,6 +98,12 @@ public:
   State read_state();
   void write_state(const State& state);
 
+  // Complete state, including the filters and the resampler, to be
+  // restored into a chip with the same model and sampling parameters
+  // by the same build.
+  void save_state(std::vector<unsigned char>& out) const;
+  bool load_state(const unsigned char* data, size_t size);
+
   // 16-bit input (EXT IN).
   void input(short in_sample);
 
@@ -107,6 +117,8 @@ public:
   int clock_resample(cycle_count& delta_t, short* buf, int n, int interleave);
   int clock_resample_fastmem(cycle_count& delta_t, short* buf, int n, int interleave);
   void write();
+  void clock_voices();
+  void clock_bus();
 
   chip_model sid_model;
   Voice voice[3];
@@ -156,15 +168,14 @@ public:
   short sample_prev, sample_now;
   int fir_N;
   int fir_RES;
-  double fir_beta;
-  double fir_f_cycles_per_sample;
-  double fir_filter_scale;
 
   // Ring buffer with overflow for contiguous storage of RINGSIZE samples.
   short* sample;
 
-  // FIR_RES filter tables (FIR_N*FIR_RES).
-  short* fir;
+  // FIR_RES filter tables (FIR_N*FIR_RES), shared between the instances
+  // using the same sampling parameters.
+  std::shared_ptr<const std::vector<short> > fir_table;
+  const short* fir;
 };
 
 } // namespace reSID
@@ -26,6 +26,7 @@
 #include <new>
 
 #include "residfp-emu.h"
+#include "c64/c64.h"
 
 ReSIDfpBuilder::~ReSIDfpBuilder()
 {   // Remove all SID emulations
@@ -61,6 +62,40 @@ unsigned int ReSIDfpBuilder::create(unsigned int sids)
 
 }
 
+void ReSIDfpBuilder::prewarm(const unsigned int *frequencies, std::size_t count)
+{
+    using libsidplayfp::c64;
+
+    constexpr c64::Model models[] =
+    {
+        c64::Model::PAL_B,
+        c64::Model::NTSC_M,
+        c64::Model::PAL_N,
+        c64::Model::PAL_M,
+    };
+
+    for (c64::Model model : models)
+    {
+        // Same conversions as done by the player
+        const float systemclock = static_cast<float>(c64::getCpuFreq(model));
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            libsidplayfp::ReSIDfp::prewarm(systemclock, static_cast<float>(frequencies[i]));
+        }
+    }
+}
+
+bool ReSIDfpBuilder::saveFilterTables(const char *path)
+{
+    return libsidplayfp::ReSIDfp::saveFilterTables(path);
+}
+
+bool ReSIDfpBuilder::loadFilterTables(const char *path)
+{
+    return libsidplayfp::ReSIDfp::loadFilterTables(path);
+}
+
 const char *ReSIDfpBuilder::credits() const
 {
     return libsidplayfp::ReSIDfp::getCredits();
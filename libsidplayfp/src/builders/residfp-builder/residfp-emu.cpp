@@ -25,8 +25,11 @@
 #include <algorithm>
 #include <sstream>
 #include <string>
+#include <vector>
 
+#include "residfp/FilterTables.h"
 #include "residfp/siddefs-fp.h"
+#include "Snapshot.h"
 
 #ifdef HAVE_CONFIG_H
 #  include "config.h"
@@ -34,6 +37,18 @@
 
 namespace libsidplayfp
 {
+namespace
+{
+/**
+ * Get the highest accurate frequency for the resampler.
+ * Half frequency is rounded to the nearest multiple of 5000.
+ */
+double highestAccurateFrequency(float freq)
+{
+    const int halfFreq = 5000*((static_cast<int>(freq)+5000)/10000);
+    return std::min(halfFreq, 20000);
+}
+} // Anonymous namespace
 
 const char* ReSIDfp::getCredits()
 {
@@ -57,14 +72,19 @@ const char* ReSIDfp::getCredits()
 
 ReSIDfp::ReSIDfp(sidbuilder *builder) :
     sidemu(builder),
-    m_sid(*(new reSIDfp::SID))
+    m_sid(*(new reSIDfp::SID)),
+    m_shadow(*(new reSIDfp::SID))
 {
-    m_buffer = new short[OUTPUTBUFFERSIZE];
+    // Queuing saves work even when clocked on a single thread
+    m_deferWrites = true;
+
+    m_buffer = new int[BUFFERSIZE];
     reset(0);
 }
 
 ReSIDfp::~ReSIDfp()
 {
+    delete &m_shadow;
     delete &m_sid;
     delete[] m_buffer;
 }
@@ -83,27 +103,179 @@ void ReSIDfp::filter8580Curve(double filterCurve)
 void ReSIDfp::reset(uint8_t volume)
 {
     m_accessClk = 0;
+    m_shadowClk = 0;
+    m_shadowPos = 0;
+    m_shadowActive = false;
+    m_shadowRead = false;
+    m_writes.clear();
     m_sid.reset();
     m_sid.write(0x18, volume);
+    m_shadow.reset();
+    m_shadow.write(0x18, volume);
 }
 
 uint8_t ReSIDfp::read(uint_least8_t addr)
 {
-    clock();
-    return m_sid.read(addr);
+    if (!m_deferWrites)
+    {
+        clock();
+        return m_sid.read(addr);
+    }
+
+    if (!m_shadowActive)
+    {
+        // Catch up once and continue silently from here
+        clock();
+        m_shadow.copyVoiceState(m_sid);
+        m_shadowClk = m_accessClk;
+        m_shadowActive = true;
+    }
+    else
+    {
+        clockShadow(eventScheduler->getTime(EventPhase::ClockPHI1));
+    }
+
+    m_shadowRead = true;
+    return m_shadow.read(addr);
 }
 
 void ReSIDfp::write(uint_least8_t addr, uint8_t data)
 {
-    clock();
-    m_sid.write(addr, data);
+    if (!m_deferWrites)
+    {
+        clock();
+        m_sid.write(addr, data);
+        return;
+    }
+
+    m_writes.push_back({ eventScheduler->getTime(EventPhase::ClockPHI1), addr, data });
+}
+
+bool ReSIDfp::deferWrites(bool enable)
+{
+    if (!enable && m_deferWrites)
+    {
+        // Apply the queue and hand the bus state back to the audio chip
+        if (eventScheduler != nullptr)
+            clock();
+        m_shadowActive = false;
+    }
+
+    m_deferWrites = enable;
+    return true;
+}
+
+void ReSIDfp::clockTo(event_clock_t clk)
+{
+    const event_clock_t cycles = clk - m_accessClk;
+    m_accessClk = clk;
+
+    if (m_silent && m_coarse)
+        m_sid.clockEnvelopes(static_cast<unsigned int>(cycles));
+    else if (m_silent)
+        m_sid.clockSilent(static_cast<unsigned int>(cycles), true);
+    else if (m_voiceBuffer[0] != nullptr)
+    {
+        int* const voiceBuf[3] =
+        {
+            m_voiceBuffer[0] + m_bufferpos,
+            m_voiceBuffer[1] + m_bufferpos,
+            m_voiceBuffer[2] + m_bufferpos
+        };
+        m_bufferpos += m_sid.clock(static_cast<std::uint32_t>(cycles), m_buffer + m_bufferpos, voiceBuf);
+    }
+    else
+        m_bufferpos += m_sid.clock(static_cast<std::uint32_t>(cycles), m_buffer + m_bufferpos);
+}
+
+void ReSIDfp::clockShadow(event_clock_t clk)
+{
+    for (; m_shadowPos < m_writes.size(); m_shadowPos++)
+    {
+        const write_t &w = m_writes[m_shadowPos];
+        m_shadow.clockSilent(static_cast<unsigned int>(w.clk - m_shadowClk));
+        m_shadowClk = w.clk;
+        m_shadow.write(w.addr, w.data);
+    }
+
+    m_shadow.clockSilent(static_cast<unsigned int>(clk - m_shadowClk));
+    m_shadowClk = clk;
 }
 
 void ReSIDfp::clock()
 {
-    const event_clock_t cycles = eventScheduler->getTime(m_accessClk, EventPhase::ClockPHI1);
-    m_accessClk += cycles;
-    m_bufferpos += m_sid.clock(static_cast<std::uint32_t>(cycles), m_buffer + m_bufferpos);
+    const event_clock_t now = eventScheduler->getTime(EventPhase::ClockPHI1);
+
+    // Keep the shadow chip in step before dropping the queue,
+    // or drop it if it wasn't used during the last slice
+    if (m_shadowActive)
+    {
+        if (m_shadowRead)
+            clockShadow(now);
+        else
+            m_shadowActive = false;
+    }
+    m_shadowRead = false;
+
+    // Replay the queued writes at the cycle they happened
+    for (const write_t &w : m_writes)
+    {
+        clockTo(w.clk);
+        m_sid.write(w.addr, w.data);
+    }
+    m_writes.clear();
+    m_shadowPos = 0;
+
+    clockTo(now);
+
+    // Reads change the bus value, which the audio chip never sees
+    if (m_shadowActive)
+        m_sid.copyBusState(m_shadow);
+}
+
+bool ReSIDfp::serialize(Snapshot& s)
+{
+    serializeCommon(s);
+
+    if (!s.loading())
+    {
+        std::vector<unsigned char> state;
+        m_sid.saveState(state);
+        std::uint32_t size = static_cast<std::uint32_t>(state.size());
+        s(size);
+        s.io(state.data(), size);
+    }
+    else
+    {
+        std::uint32_t size = 0;
+        s(size);
+        const uint8_t* data = s.consume(size);
+        s.check(data != nullptr && m_sid.loadState(data, size));
+
+        // The shadow chip is restarted at the next read
+        m_shadowActive = false;
+        m_shadowRead = false;
+        m_shadowPos = 0;
+    }
+
+    return true;
+}
+
+bool ReSIDfp::voiceOutputs(bool enable)
+{
+    m_sid.enableVoiceOutputs(enable);
+
+    if (enable)
+        m_voiceSamples.assign(3 * BUFFERSIZE, 0);
+    else
+        std::vector<int>().swap(m_voiceSamples);
+
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        m_voiceBuffer[i] = enable ? m_voiceSamples.data() + i * BUFFERSIZE : nullptr;
+    }
+
+    return true;
 }
 
 void ReSIDfp::filter(bool enable)
@@ -130,9 +302,7 @@ void ReSIDfp::sampling(float systemclock, float freq, SidConfig::SamplingMethod
 
     try
     {
-        // Round half frequency to the nearest multiple of 5000
-        const int halfFreq = 5000*((static_cast<int>(freq)+5000)/10000);
-        m_sid.setSamplingParameters(systemclock, sampleMethod, freq, std::min(halfFreq, 20000));
+        m_sid.setSamplingParameters(systemclock, sampleMethod, freq, highestAccurateFrequency(freq));
     }
     catch (reSIDfp::SIDError const &)
     {
@@ -144,6 +314,21 @@ void ReSIDfp::sampling(float systemclock, float freq, SidConfig::SamplingMethod
     m_status = true;
 }
 
+void ReSIDfp::prewarm(float systemclock, float freq)
+{
+    reSIDfp::SID::prewarmResampler(systemclock, freq, highestAccurateFrequency(freq));
+}
+
+bool ReSIDfp::saveFilterTables(const char* path)
+{
+    return reSIDfp::FilterTables::save(path);
+}
+
+bool ReSIDfp::loadFilterTables(const char* path)
+{
+    return reSIDfp::FilterTables::load(path);
+}
+
 // Set the emulated SID model
 void ReSIDfp::model(SidConfig::SIDModel model, bool digiboost)
 {
@@ -164,8 +349,27 @@ void ReSIDfp::model(SidConfig::SIDModel model, bool digiboost)
             return;
     }
 
-    m_sid.setChipModel(chipModel);
+    // Pooled chips are usually handed out again for the same model,
+    // don't rebuild the tables then
+    if (m_sid.getChipModel() != chipModel)
+    {
+        m_sid.setChipModel(chipModel);
+        m_shadow.setChipModel(chipModel);
+    }
     m_status = true;
 }
 
+bool ReSIDfp::hasModel(SidConfig::SIDModel model) const
+{
+    switch (model)
+    {
+    case SidConfig::SIDModel::MOS6581:
+        return m_sid.getChipModel() == reSIDfp::MOS6581;
+    case SidConfig::SIDModel::MOS8580:
+        return m_sid.getChipModel() == reSIDfp::MOS8580;
+    default:
+        return false;
+    }
+}
+
 }
@@ -23,7 +23,9 @@
 #ifndef RESIDFP_EMU_H
 #define RESIDFP_EMU_H
 
+#include <cstddef>
 #include <cstdint>
+#include <vector>
 
 #include <sidplayfp/SidConfig.h>
 
@@ -40,9 +42,56 @@ class ReSIDfp final : public sidemu
 private:
     reSIDfp::SID &m_sid;
 
+    /**
+     * Silently clocked copy of the chip used to answer reads,
+     * so that m_sid is clocked only once per mixer slice.
+     * Started at a read and dropped after a slice without reads.
+     */
+    reSIDfp::SID &m_shadow;
+
+    event_clock_t m_shadowClk{};
+
+    bool m_shadowActive = false;
+
+    /// A read happened since the last clock() call
+    bool m_shadowRead = false;
+
+    bool m_silent = false;
+
+    /// Keep only the envelopes and the oscillator phases while silent
+    bool m_coarse = false;
+
+    /// Next queued write to be applied to the shadow chip
+    std::size_t m_shadowPos = 0;
+
+    /// Storage of the voice output buffers
+    std::vector<int> m_voiceSamples;
+
+private:
+    void clockTo(event_clock_t clk);
+    void clockShadow(event_clock_t clk);
+
 public:
     static const char* getCredits();
 
+    /**
+     * Precompute the resampling tables for the given parameters.
+     *
+     * @param systemclock the system clock frequency
+     * @param freq the output sampling frequency
+     */
+    static void prewarm(float systemclock, float freq);
+
+    /**
+     * Save the filter model tables to a file.
+     */
+    static bool saveFilterTables(const char* path);
+
+    /**
+     * Use the filter model tables stored in a file.
+     */
+    static bool loadFilterTables(const char* path);
+
 public:
     explicit ReSIDfp(sidbuilder *builder);
     ~ReSIDfp();
@@ -58,13 +107,27 @@ public:
     // Standard SID emu functions
     void clock() override;
 
+    bool deferWrites(bool enable) override;
+
+    bool serialize(Snapshot& s) override;
+
+    void silent(bool enable) override { m_silent = enable; }
+
+    void coarse(bool enable) override { m_coarse = enable; }
+
+    bool voiceOutputs(bool enable) override;
+
     void sampling(float systemclock, float freq,
                   SidConfig::SamplingMethod method, bool fast) override;
 
     void voice(unsigned int num, bool mute) override { m_sid.mute(num, mute); }
 
+    uint8_t envelope(unsigned int num) const override { return m_sid.readEnvelope(num); }
+
     void model(SidConfig::SIDModel model, bool digiboost) override;
 
+    bool hasModel(SidConfig::SIDModel model) const override;
+
     // Specific to resid
     void filter(bool enable);
     void filter6581Curve(double filterCurve);
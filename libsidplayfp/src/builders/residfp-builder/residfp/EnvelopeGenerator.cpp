@@ -23,6 +23,7 @@
 
 #include "EnvelopeGenerator.h"
 
+#include <algorithm>
 #include <array>
 
 #include "Dac.h"
@@ -33,6 +34,45 @@ namespace
 {
 constexpr unsigned int DAC_BITS = 8;
 
+/// The rate counter runs through all the non zero 15 bit values
+constexpr unsigned int LFSR_PERIOD = 0x7fff;
+
+inline unsigned int clockLfsr(unsigned int lfsr)
+{
+    // XOR on last 2 bits
+    const unsigned int feedback = ((lfsr << 14) ^ (lfsr << 13)) & 0x4000;
+    return (lfsr >> 1) | feedback;
+}
+
+/**
+ * Map the rate counter sequence to positions and back,
+ * so that it can be moved forward many cycles at once.
+ */
+struct LfsrSequence
+{
+    std::array<unsigned short, LFSR_PERIOD> value;
+    std::array<unsigned short, LFSR_PERIOD + 1> position;
+
+    LfsrSequence()
+    {
+        unsigned int lfsr = 0x7fff;
+        for (unsigned int i = 0; i < LFSR_PERIOD; i++)
+        {
+            value[i] = static_cast<unsigned short>(lfsr);
+            position[lfsr] = static_cast<unsigned short>(i);
+            lfsr = clockLfsr(lfsr);
+        }
+        // Never reached
+        position[0] = 0;
+    }
+};
+
+const LfsrSequence& lfsrSequence()
+{
+    static const LfsrSequence sequence;
+    return sequence;
+}
+
 /**
  * Lookup table to convert from attack, decay, or release value to rate
  * counter period.
@@ -263,9 +303,7 @@ void EnvelopeGenerator::clock()
     if (likely(lfsr != rate))
     {
         // it wasn't a match, clock the LFSR once
-        // by performing XOR on last 2 bits
-        const unsigned int feedback = ((lfsr << 14) ^ (lfsr << 13)) & 0x4000;
-        lfsr = (lfsr >> 1) | feedback;
+        lfsr = clockLfsr(lfsr);
     }
     else
     {
@@ -297,6 +335,36 @@ void EnvelopeGenerator::reset()
     rate = adsrtable[release];
 }
 
+void EnvelopeGenerator::serialize(Snapshot& s)
+{
+    s(lfsr);
+    s(rate);
+    s(exponential_counter);
+    s(exponential_counter_period);
+    s(state_pipeline);
+    s(envelope_pipeline);
+    s(exponential_pipeline);
+    s(state);
+    s(next_state);
+    s(counter_enabled);
+    s(gate);
+    s(resetLfsr);
+    s(envelope_counter);
+    s(attack);
+    s(decay);
+    s(sustain);
+    s(release);
+    s(env3);
+
+    if (s.loading())
+    {
+        s.check(lfsr <= 0x7fff
+            && state <= State::Release && next_state <= State::Release
+            && attack <= 0x0f && decay <= 0x0f && release <= 0x0f
+            && (sustain >> 4) == (sustain & 0x0f));
+    }
+}
+
 void EnvelopeGenerator::writeCONTROL_REG(unsigned char control)
 {
     const bool gate_next = (control & 0x01) != 0;
@@ -370,4 +438,40 @@ void EnvelopeGenerator::writeSUSTAIN_RELEASE(unsigned char sustain_release)
     }
 }
 
+void EnvelopeGenerator::clock(unsigned int n, float* buf)
+{
+    for (unsigned int i = 0; i < n; i++)
+    {
+        clock();
+        buf[i] = output();
+    }
+}
+
+void EnvelopeGenerator::clock(unsigned int n)
+{
+    const LfsrSequence &sequence = lfsrSequence();
+
+    while (n != 0)
+    {
+        if (likely(!state_pipeline && !envelope_pipeline && !exponential_pipeline && !resetLfsr && lfsr != rate))
+        {
+            // Nothing but the rate counter moves until it matches the rate period
+            const unsigned int pos = sequence.position[lfsr];
+            const unsigned int steps = rate != 0
+                ? (sequence.position[rate] + LFSR_PERIOD - pos) % LFSR_PERIOD
+                : n;
+            const unsigned int k = std::min(n, steps);
+
+            lfsr = sequence.value[(pos + k) % LFSR_PERIOD];
+            env3 = envelope_counter;
+            n -= k;
+        }
+        else
+        {
+            clock();
+            n--;
+        }
+    }
+}
+
 } // namespace reSIDfp
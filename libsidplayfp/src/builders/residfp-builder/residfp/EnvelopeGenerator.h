@@ -26,6 +26,7 @@
 
 #include <array>
 #include "siddefs-fp.h"
+#include "Snapshot.h"
 
 namespace reSIDfp
 {
@@ -58,6 +59,24 @@ public:
      */
     void clock();
 
+    /**
+     * Clock the generator for a block of cycles, producing the output
+     * of each cycle. Same as calling clock() and output() in turn.
+     *
+     * @param n number of cycles
+     * @param buf output buffer, n values
+     */
+    void clock(unsigned int n, float* buf);
+
+    /**
+     * Clock the generator for a block of cycles without output.
+     * Same as calling clock() n times, but the stretches where
+     * only the rate counter runs are skipped at once.
+     *
+     * @param n number of cycles
+     */
+    void clock(unsigned int n);
+
     /**
      * Get the Envelope Generator output.
      * DAC imperfections are emulated by using envelope_counter as an index
@@ -70,6 +89,11 @@ public:
      */
     void reset();
 
+    /**
+     * Save or restore the state.
+     */
+    void serialize(Snapshot& s);
+
     /**
      * Write control register.
      *
@@ -23,6 +23,8 @@
 #ifndef EXTERNALFILTER_H
 #define EXTERNALFILTER_H
 
+#include "Snapshot.h"
+
 namespace reSIDfp
 {
 
@@ -70,6 +72,15 @@ public:
      */
     void reset();
 
+    /**
+     * Save or restore the state.
+     */
+    void serialize(Snapshot& s)
+    {
+        s(Vlp);
+        s(Vhp);
+    }
+
 private:
     /// Lowpass filter voltage
     int Vlp = 0;
@@ -47,6 +47,30 @@ void Filter::reset()
     writeRES_FILT(0);
 }
 
+void Filter::serialize(Snapshot& s)
+{
+    s(Vhp);
+    s(Vbp);
+    s(Vlp);
+    s(ve);
+    s(fc);
+    s(vol);
+    s(lp);
+    s(bp);
+    s(hp);
+    s(voice3off);
+    s(filt);
+
+    if (s.loading())
+    {
+        s.check(fc <= 0x7ff && vol <= 0x0f);
+
+        // Derive the table pointers from the registers
+        updatedCenterFrequency();
+        writeRES_FILT(filt);
+    }
+}
+
 void Filter::writeFC_LO(unsigned char fc_lo)
 {
     fc = (fc & 0x7f8) | (fc_lo & 0x007);
@@ -23,6 +23,8 @@
 #ifndef FILTER_H
 #define FILTER_H
 
+#include "Snapshot.h"
+
 namespace reSIDfp
 {
 
@@ -57,6 +59,11 @@ public:
      */
     void reset();
 
+    /**
+     * Save or restore the state.
+     */
+    virtual void serialize(Snapshot& s);
+
     /**
      * Write Frequency Cutoff Low register.
      *
@@ -43,6 +43,13 @@ Filter6581::Filter6581() :
 
 Filter6581::~Filter6581() = default;
 
+void Filter6581::serialize(Snapshot& s)
+{
+    Filter::serialize(s);
+    hpIntegrator->serialize(s);
+    bpIntegrator->serialize(s);
+}
+
 void Filter6581::updatedCenterFrequency()
 {
     const std::uint16_t Vw = f0_dac[fc];
@@ -52,7 +59,7 @@ void Filter6581::updatedCenterFrequency()
 
 void Filter6581::updatedMixing()
 {
-    currentGain = gain[vol].get();
+    currentGain = gain[vol];
 
     unsigned int ni = 0;
     unsigned int no = 0;
@@ -65,13 +72,13 @@ void Filter6581::updatedMixing()
 
     (filtE ? ni : no)++;
 
-    currentSummer = summer[ni].get();
+    currentSummer = summer[ni];
 
     if (lp) no++;
     if (bp) no++;
     if (hp) no++;
 
-    currentMixer = mixer[no].get();
+    currentMixer = mixer[no];
 }
 
 int Filter6581::clock(int voice1, int voice2, int voice3)
@@ -325,6 +325,8 @@ public:
 
     void input(int sample) override { ve = (sample * voiceScaleS14 * 3 >> 10) + mixer[0][0]; }
 
+    void serialize(Snapshot& s) override;
+
     /**
      * Set filter curve type based on single parameter.
      *
@@ -343,7 +345,7 @@ protected:
      *
      * In the MOS 6581, 1/Q is controlled linearly by res.
      */
-    void updateResonance(unsigned char res) override { currentResonance = gain[~res & 0xf].get(); }
+    void updateResonance(unsigned char res) override { currentResonance = gain[~res & 0xf]; }
 
     void updatedMixing() override;
 
@@ -78,6 +78,13 @@ int Filter8580::clock(int voice1, int voice2, int voice3)
     return currentGain[currentMixer[Vo]] - (1 << 15);
 }
 
+void Filter8580::serialize(Snapshot& s)
+{
+    Filter::serialize(s);
+    hpIntegrator->serialize(s);
+    bpIntegrator->serialize(s);
+}
+
 void Filter8580::updatedCenterFrequency()
 {
     double wl;
@@ -105,7 +112,7 @@ void Filter8580::updatedCenterFrequency()
 
 void Filter8580::updatedMixing()
 {
-    currentGain = gain_vol[vol].get();
+    currentGain = gain_vol[vol];
 
     unsigned int ni = 0;
     unsigned int no = 0;
@@ -118,13 +125,13 @@ void Filter8580::updatedMixing()
 
     (filtE ? ni : no)++;
 
-    currentSummer = summer[ni].get();
+    currentSummer = summer[ni];
 
     if (lp) no++;
     if (bp) no++;
     if (hp) no++;
 
-    currentMixer = mixer[no].get();
+    currentMixer = mixer[no];
 }
 
 void Filter8580::setFilterCurve(double curvePosition)
@@ -284,6 +284,8 @@ public:
 
     void input(int sample) override { ve = (sample * voiceScaleS14 * 3 >> 14) + mixer[0][0]; }
 
+    void serialize(Snapshot& s) override;
+
     /**
      * Set filter curve type based on single parameter.
      *
@@ -307,7 +309,7 @@ protected:
      *
      * @param res the new resonance value
      */
-    void updateResonance(unsigned char res) override { currentResonance = gain_res[res].get(); }
+    void updateResonance(unsigned char res) override { currentResonance = gain_res[res]; }
 
     void updatedMixing() override;
 
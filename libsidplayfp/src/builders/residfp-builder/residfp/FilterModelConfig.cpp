@@ -81,20 +81,81 @@ constexpr std::array<Spline::Point, OPAMP_SIZE> opamp_voltage{{
 
 std::unique_ptr<FilterModelConfig> FilterModelConfig::instance(nullptr);
 
+FilterTables::Data FilterModelConfig::tables;
+
 FilterModelConfig* FilterModelConfig::getInstance()
 {
     if (!instance)
     {
-        instance.reset(new FilterModelConfig());
+        if (!tables)
+        {
+            std::uint16_t* data = new std::uint16_t[TABLE_SIZE];
+            buildTables(data);
+            tables.reset(data, std::default_delete<std::uint16_t[]>());
+        }
+
+        instance.reset(new FilterModelConfig(tables.get()));
     }
 
     return instance.get();
 }
 
-FilterModelConfig::FilterModelConfig() : dac(DAC_BITS)
+bool FilterModelConfig::setTables(const FilterTables::Data& data)
+{
+    if (instance)
+        return false;
+
+    tables = data;
+    return true;
+}
+
+std::uint32_t FilterModelConfig::parameterHash()
+{
+    constexpr double parameters[] =
+    {
+        C, Vdd, Vth, Ut, k, uCox, WL_vcr, WL_snake, vmin, vmax
+    };
+
+    const std::uint32_t h = FilterTables::hash(opamp_voltage.data(), sizeof(opamp_voltage));
+    return FilterTables::hash(parameters, sizeof(parameters), h);
+}
+
+FilterModelConfig::FilterModelConfig(const std::uint16_t* data) : dac(DAC_BITS)
 {
     dac.kinkedDac(MOS6581);
 
+    // Same layout as buildTables
+    opamp_rev = data;
+    data += FilterTables::TABLE_ENTRIES;
+
+    for (std::size_t i = 0; i < summer.size(); i++)
+    {
+        summer[i] = data;
+        data += FilterTables::summerSize(i);
+    }
+
+    for (std::size_t i = 0; i < mixer.size(); i++)
+    {
+        mixer[i] = data;
+        data += FilterTables::mixerSize(i);
+    }
+
+    for (std::size_t n8 = 0; n8 < gain.size(); n8++)
+    {
+        gain[n8] = data;
+        data += FilterTables::TABLE_ENTRIES;
+    }
+
+    vcr_kVg = data;
+    data += FilterTables::TABLE_ENTRIES;
+
+    vcr_n_Ids_term = data;
+}
+
+void FilterModelConfig::buildTables(std::uint16_t* data)
+{
+    [[maybe_unused]] std::uint16_t* const begin = data;
+
     // Convert op-amp voltage transfer to 16 bit values.
 
     std::array<Spline::Point, OPAMP_SIZE> scaled_voltage;
@@ -108,7 +169,10 @@ FilterModelConfig::FilterModelConfig() : dac(DAC_BITS)
 
     const Spline s(scaled_voltage.data(), scaled_voltage.size());
 
-    for (std::size_t x = 0; x < opamp_rev.size(); x++)
+    std::uint16_t* const opamp_rev = data;
+    data += FilterTables::TABLE_ENTRIES;
+
+    for (std::size_t x = 0; x < FilterTables::TABLE_ENTRIES; x++)
     {
         const Spline::Point out = s.evaluate(double(x));
         double tmp = out.x;
@@ -131,20 +195,21 @@ FilterModelConfig::FilterModelConfig() : dac(DAC_BITS)
     // entirely accurate, since the input for each transistor is different,
     // and transistors are not linear components. However modeling all
     // transistors separately would be extremely costly.
-    for (std::size_t i = 0; i < summer.size(); i++)
+    for (std::size_t i = 0; i < std::tuple_size<SummerTable>::value; i++)
     {
         const std::size_t idiv = 2 + i;        // 2 - 6 input "resistors".
-        const std::size_t size = idiv << 16;
+        const std::size_t size = FilterTables::summerSize(i);
         const auto n = static_cast<double>(idiv);
         opampModel.reset();
-        summer[i] = std::make_unique<std::uint16_t[]>(size);
+        std::uint16_t* const summer = data;
+        data += size;
 
         for (std::size_t vi = 0; vi < size; vi++)
         {
             const double vin = vmin + vi / N16 / idiv; /* vmin .. vmax */
             const double tmp = (opampModel.solve(n, vin) - vmin) * N16;
             assert(tmp > -0.5 && tmp < 65535.5);
-            summer[i][vi] = static_cast<unsigned short>(tmp + 0.5);
+            summer[vi] = static_cast<unsigned short>(tmp + 0.5);
         }
     }
 
@@ -153,20 +218,21 @@ FilterModelConfig::FilterModelConfig() : dac(DAC_BITS)
     //
     // All "on", transistors are modeled as one - see comments above for
     // the filter summer.
-    for (std::size_t i = 0; i < mixer.size(); i++)
+    for (std::size_t i = 0; i < std::tuple_size<MixerTable>::value; i++)
     {
         const std::size_t idiv = (i == 0) ? 1 : i;
-        const std::size_t size = (i == 0) ? 1 : i << 16;
+        const std::size_t size = FilterTables::mixerSize(i);
         const double n = i * 8.0 / 6.0;
         opampModel.reset();
-        mixer[i] = std::make_unique<std::uint16_t[]>(size);
+        std::uint16_t* const mixer = data;
+        data += size;
 
         for (std::size_t vi = 0; vi < size; vi++)
         {
             const double vin = vmin + vi / N16 / idiv; /* vmin .. vmax */
             const double tmp = (opampModel.solve(n, vin) - vmin) * N16;
             assert(tmp > -0.5 && tmp < 65535.5);
-            mixer[i][vi] = static_cast<unsigned short>(tmp + 0.5);
+            mixer[vi] = static_cast<unsigned short>(tmp + 0.5);
         }
     }
 
@@ -175,26 +241,30 @@ FilterModelConfig::FilterModelConfig() : dac(DAC_BITS)
     // From die photographs of the bandpass and volume "resistor" ladders
     // it follows that gain ~ vol/8 and 1/Q ~ ~res/8 (assuming ideal
     // op-amps and ideal "resistors").
-    for (std::size_t n8 = 0; n8 < gain.size(); n8++)
+    for (std::size_t n8 = 0; n8 < std::tuple_size<GainTable>::value; n8++)
     {
-        constexpr std::size_t size = 1 << 16;
+        constexpr std::size_t size = FilterTables::TABLE_ENTRIES;
         const double n = n8 / 8.0;
         opampModel.reset();
-        gain[n8] = std::make_unique<std::uint16_t[]>(size);
+        std::uint16_t* const gain = data;
+        data += size;
 
         for (std::size_t vi = 0; vi < size; vi++)
         {
             const double vin = vmin + vi / N16; /* vmin .. vmax */
             const double tmp = (opampModel.solve(n, vin) - vmin) * N16;
             assert(tmp > -0.5 && tmp < 65535.5);
-            gain[n8][vi] = static_cast<unsigned short>(tmp + 0.5);
+            gain[vi] = static_cast<unsigned short>(tmp + 0.5);
         }
     }
 
     constexpr double nkVddt = N16 * kVddt;
     constexpr double nVmin = N16 * vmin;
 
-    for (std::size_t i = 0; i < vcr_kVg.size(); i++)
+    std::uint16_t* const vcr_kVg = data;
+    data += FilterTables::TABLE_ENTRIES;
+
+    for (std::size_t i = 0; i < FilterTables::TABLE_ENTRIES; i++)
     {
         // The table index is right-shifted 16 times in order to fit in
         // 16 bits; the argument to sqrt is thus multiplied by (1 << 16).
@@ -225,9 +295,12 @@ FilterModelConfig::FilterModelConfig() : dac(DAC_BITS)
     constexpr double N15 = norm * ((1 << 15) - 1);
     constexpr double n_Is = N15 * 1.0e-6 / C * Is;
 
+    std::uint16_t* const vcr_n_Ids_term = data;
+    data += FilterTables::TABLE_ENTRIES;
+
     // kVg_Vx = k*Vg - Vx
     // I.e. if k != 1.0, Vg must be scaled accordingly.
-    for (std::size_t kVg_Vx = 0; kVg_Vx < vcr_n_Ids_term.size(); kVg_Vx++)
+    for (std::size_t kVg_Vx = 0; kVg_Vx < FilterTables::TABLE_ENTRIES; kVg_Vx++)
     {
         const double log_term = std::log1p(exp((kVg_Vx / N16 - kVt) / (2. * Ut)));
         // Scaled by m*2^15
@@ -235,6 +308,8 @@ FilterModelConfig::FilterModelConfig() : dac(DAC_BITS)
         assert(tmp > -0.5 && tmp < 65535.5);
         vcr_n_Ids_term[kVg_Vx] = static_cast<unsigned short>(tmp + 0.5);
     }
+
+    assert(data == begin + TABLE_SIZE);
 }
 
 FilterModelConfig::~FilterModelConfig() = default;
@@ -24,10 +24,12 @@
 #define FILTERMODELCONFIG_H
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 
 #include "Dac.h"
+#include "FilterTables.h"
 
 namespace reSIDfp
 {
@@ -41,13 +43,43 @@ class FilterModelConfig
 {
 public:
     using DACPtr = std::unique_ptr<const std::uint16_t[]>;
-    using GainTable = std::array<std::unique_ptr<std::uint16_t[]>, 16>;
-    using MixerTable = std::array<std::unique_ptr<std::uint16_t[]>, 8>;
-    using OpAmpTable = std::array<std::uint16_t, 1 << 16>;
-    using SummerTable = std::array<std::unique_ptr<std::uint16_t[]>, 5>;
+    using GainTable = std::array<const std::uint16_t*, 16>;
+    using MixerTable = std::array<const std::uint16_t*, 8>;
+    using SummerTable = std::array<const std::uint16_t*, 5>;
+
+    /**
+     * Number of entries of the lookup tables, stored back to back:
+     * op-amp, summer, mixer, gain and VCR tables.
+     */
+    static constexpr std::size_t TABLE_SIZE =
+        FilterTables::TABLE_ENTRIES
+        + FilterTables::summersSize(std::tuple_size<SummerTable>::value)
+        + FilterTables::mixersSize(std::tuple_size<MixerTable>::value)
+        + FilterTables::TABLE_ENTRIES * std::tuple_size<GainTable>::value
+        + FilterTables::TABLE_ENTRIES * 2;
 
     static FilterModelConfig* getInstance();
 
+    /**
+     * Compute the lookup tables.
+     *
+     * @param data buffer of #TABLE_SIZE entries
+     */
+    static void buildTables(std::uint16_t* data);
+
+    /**
+     * Hash of the model parameters the tables are computed from.
+     */
+    static std::uint32_t parameterHash();
+
+    /**
+     * Use precomputed lookup tables instead of building them.
+     *
+     * @param data the tables, as produced by #buildTables
+     * @return false if the tables are already in use
+     */
+    static bool setTables(const FilterTables::Data& data);
+
     /**
      * The digital range of one voice is 20 bits; create a scaling term
      * for multiplication which fits in 11 bits.
@@ -90,7 +122,7 @@ public:
     std::unique_ptr<Integrator> buildIntegrator();
 
 private:
-    FilterModelConfig();
+    explicit FilterModelConfig(const std::uint16_t* data);
     ~FilterModelConfig();
 
     double getDacZero(double adjustment) const { return dac_zero - (adjustment - 0.5) * 2.0; }
@@ -98,6 +130,9 @@ private:
     static constexpr unsigned int DAC_BITS = 11;
 
     static std::unique_ptr<FilterModelConfig> instance;
+
+    /// Lookup tables, built on first use or set from outside
+    static FilterTables::Data tables;
     // This allows access to the private constructor
     friend std::unique_ptr<FilterModelConfig>::deleter_type;
 
@@ -143,12 +178,12 @@ private:
 
     /// VCR - 6581 only.
     //@{
-    OpAmpTable vcr_kVg;
-    OpAmpTable vcr_n_Ids_term;
+    const std::uint16_t* vcr_kVg;
+    const std::uint16_t* vcr_n_Ids_term;
     //@}
 
     /// Reverse op-amp transfer function.
-    OpAmpTable opamp_rev;
+    const std::uint16_t* opamp_rev;
 };
 
 } // namespace reSIDfp
@@ -113,18 +113,81 @@ constexpr std::array<Spline::Point, OPAMP_SIZE> opamp_voltage{{
 
 std::unique_ptr<FilterModelConfig8580> FilterModelConfig8580::instance(nullptr);
 
+FilterTables::Data FilterModelConfig8580::tables;
+
 FilterModelConfig8580* FilterModelConfig8580::getInstance()
 {
     if (instance == nullptr)
     {
-        instance.reset(new FilterModelConfig8580());
+        if (!tables)
+        {
+            std::uint16_t* data = new std::uint16_t[TABLE_SIZE];
+            buildTables(data);
+            tables.reset(data, std::default_delete<std::uint16_t[]>());
+        }
+
+        instance.reset(new FilterModelConfig8580(tables.get()));
     }
 
     return instance.get();
 }
 
-FilterModelConfig8580::FilterModelConfig8580()
+bool FilterModelConfig8580::setTables(const FilterTables::Data& data)
+{
+    if (instance)
+        return false;
+
+    tables = data;
+    return true;
+}
+
+std::uint32_t FilterModelConfig8580::parameterHash()
+{
+    constexpr double parameters[] =
+    {
+        C, Vdd, Vth, Ut, k, uCox, vmin, vmax
+    };
+
+    std::uint32_t h = FilterTables::hash(opamp_voltage.data(), sizeof(opamp_voltage));
+    h = FilterTables::hash(resGain.data(), sizeof(resGain), h);
+    return FilterTables::hash(parameters, sizeof(parameters), h);
+}
+
+FilterModelConfig8580::FilterModelConfig8580(const std::uint16_t* data)
 {
+    // Same layout as buildTables
+    opamp_rev = data;
+    data += FilterTables::TABLE_ENTRIES;
+
+    for (std::size_t i = 0; i < summer.size(); i++)
+    {
+        summer[i] = data;
+        data += FilterTables::summerSize(i);
+    }
+
+    for (std::size_t i = 0; i < mixer.size(); i++)
+    {
+        mixer[i] = data;
+        data += FilterTables::mixerSize(i);
+    }
+
+    for (std::size_t n8 = 0; n8 < gain_vol.size(); n8++)
+    {
+        gain_vol[n8] = data;
+        data += FilterTables::TABLE_ENTRIES;
+    }
+
+    for (std::size_t n8 = 0; n8 < gain_res.size(); n8++)
+    {
+        gain_res[n8] = data;
+        data += FilterTables::TABLE_ENTRIES;
+    }
+}
+
+void FilterModelConfig8580::buildTables(std::uint16_t* data)
+{
+    [[maybe_unused]] std::uint16_t* const begin = data;
+
     // Convert op-amp voltage transfer to 16 bit values.
 
     std::array<Spline::Point, OPAMP_SIZE> scaled_voltage;
@@ -138,7 +201,10 @@ FilterModelConfig8580::FilterModelConfig8580()
 
     const Spline s(scaled_voltage.data(), scaled_voltage.size());
 
-    for (std::size_t x = 0; x < opamp_rev.size(); x++)
+    std::uint16_t* const opamp_rev = data;
+    data += FilterTables::TABLE_ENTRIES;
+
+    for (std::size_t x = 0; x < FilterTables::TABLE_ENTRIES; x++)
     {
         const Spline::Point out = s.evaluate(double(x));
         double tmp = out.x;
@@ -161,20 +227,21 @@ FilterModelConfig8580::FilterModelConfig8580()
     // entirely accurate, since the input for each transistor is different,
     // and transistors are not linear components. However modeling all
     // transistors separately would be extremely costly.
-    for (std::size_t i = 0; i < summer.size(); i++)
+    for (std::size_t i = 0; i < std::tuple_size<SummerTable>::value; i++)
     {
         const std::size_t idiv = 2 + i;        // 2 - 6 input "resistors".
-        const std::size_t size = idiv << 16;
+        const std::size_t size = FilterTables::summerSize(i);
         const auto n = static_cast<double>(idiv);
         opampModel.reset();
-        summer[i] = std::make_unique<std::uint16_t[]>(size);
+        std::uint16_t* const summer = data;
+        data += size;
 
         for (std::size_t vi = 0; vi < size; vi++)
         {
             const double vin = vmin + vi / N16 / idiv; /* vmin .. vmax */
             const double tmp = (opampModel.solve(n, vin) - vmin) * N16;
             assert(tmp > -0.5 && tmp < 65535.5);
-            summer[i][vi] = static_cast<std::uint16_t>(tmp + 0.5);
+            summer[vi] = static_cast<std::uint16_t>(tmp + 0.5);
         }
     }
 
@@ -183,20 +250,21 @@ FilterModelConfig8580::FilterModelConfig8580()
     //
     // All "on", transistors are modeled as one - see comments above for
     // the filter summer.
-    for (std::size_t i = 0; i < mixer.size(); i++)
+    for (std::size_t i = 0; i < std::tuple_size<MixerTable>::value; i++)
     {
         const std::size_t idiv = (i == 0) ? 1 : i;
-        const std::size_t size = (i == 0) ? 1 : i << 16;
+        const std::size_t size = FilterTables::mixerSize(i);
         const double n = i * 8.0 / 6.0;
         opampModel.reset();
-        mixer[i] = std::make_unique<std::uint16_t[]>(size);
+        std::uint16_t* const mixer = data;
+        data += size;
 
         for (std::size_t vi = 0; vi < size; vi++)
         {
             const double vin = vmin + vi / N16 / idiv; /* vmin .. vmax */
             const double tmp = (opampModel.solve(n, vin) - vmin) * N16;
             assert(tmp > -0.5 && tmp < 65535.5);
-            mixer[i][vi] = static_cast<std::uint16_t>(tmp + 0.5);
+            mixer[vi] = static_cast<std::uint16_t>(tmp + 0.5);
         }
     }
 
@@ -204,19 +272,20 @@ FilterModelConfig8580::FilterModelConfig8580()
     // necessitate 16 gain tables.
     // From die photographs of the volume "resistor" ladders
     // it follows that gain ~ vol/8 (assuming ideal op-amps
-    for (std::size_t n8 = 0; n8 < gain_vol.size(); n8++)
+    for (std::size_t n8 = 0; n8 < std::tuple_size<GainTable>::value; n8++)
     {
-        constexpr std::size_t size = 1 << 16;
+        constexpr std::size_t size = FilterTables::TABLE_ENTRIES;
         const double n = n8 / 8.0;
         opampModel.reset();
-        gain_vol[n8] = std::make_unique<std::uint16_t[]>(size);
+        std::uint16_t* const gain_vol = data;
+        data += size;
 
         for (std::size_t vi = 0; vi < size; vi++)
         {
             const double vin = vmin + vi / N16; /* vmin .. vmax */
             const double tmp = (opampModel.solve(n, vin) - vmin) * N16;
             assert(tmp > -0.5 && tmp < 65535.5);
-            gain_vol[n8][vi] = static_cast<std::uint16_t>(tmp + 0.5);
+            gain_vol[vi] = static_cast<std::uint16_t>(tmp + 0.5);
         }
     }
 
@@ -225,20 +294,23 @@ FilterModelConfig8580::FilterModelConfig8580()
     // From die photographs of the bandpass and volume "resistor" ladders
     // it follows that 1/Q ~ 2^((4 - res)/8) (assuming ideal
     // op-amps and ideal "resistors").
-    for (std::size_t n8 = 0; n8 < gain_res.size(); n8++)
+    for (std::size_t n8 = 0; n8 < std::tuple_size<GainTable>::value; n8++)
     {
-        constexpr std::size_t size = 1 << 16;
+        constexpr std::size_t size = FilterTables::TABLE_ENTRIES;
         opampModel.reset();
-        gain_res[n8] = std::make_unique<std::uint16_t[]>(size);
+        std::uint16_t* const gain_res = data;
+        data += size;
 
         for (std::size_t vi = 0; vi < size; vi++)
         {
             const double vin = vmin + vi / N16; /* vmin .. vmax */
             const double tmp = (opampModel.solve(resGain[n8], vin) - vmin) * N16;
             assert(tmp > -0.5 && tmp < 65535.5);
-            gain_res[n8][vi] = static_cast<std::uint16_t>(tmp + 0.5);
+            gain_res[vi] = static_cast<std::uint16_t>(tmp + 0.5);
         }
     }
+
+    assert(data == begin + TABLE_SIZE);
 }
 
 FilterModelConfig8580::~FilterModelConfig8580() = default;
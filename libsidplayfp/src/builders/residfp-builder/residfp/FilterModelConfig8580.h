@@ -24,8 +24,12 @@
 #define FILTERMODELCONFIG8580_H
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 
+#include "FilterTables.h"
+
 namespace reSIDfp
 {
 
@@ -37,13 +41,42 @@ class Integrator8580;
 class FilterModelConfig8580
 {
 public:
-    using GainTable = std::array<std::unique_ptr<std::uint16_t[]>, 16>;
-    using MixerTable = std::array<std::unique_ptr<std::uint16_t[]>, 8>;
-    using OpAmpTable = std::array<std::uint16_t, 1 << 16>;
-    using SummerTable = std::array<std::unique_ptr<std::uint16_t[]>, 5>;
+    using GainTable = std::array<const std::uint16_t*, 16>;
+    using MixerTable = std::array<const std::uint16_t*, 8>;
+    using SummerTable = std::array<const std::uint16_t*, 5>;
+
+    /**
+     * Number of entries of the lookup tables, stored back to back:
+     * op-amp, summer, mixer, volume and resonance gain tables.
+     */
+    static constexpr std::size_t TABLE_SIZE =
+        FilterTables::TABLE_ENTRIES
+        + FilterTables::summersSize(std::tuple_size<SummerTable>::value)
+        + FilterTables::mixersSize(std::tuple_size<MixerTable>::value)
+        + FilterTables::TABLE_ENTRIES * std::tuple_size<GainTable>::value * 2;
 
     static FilterModelConfig8580* getInstance();
 
+    /**
+     * Compute the lookup tables.
+     *
+     * @param data buffer of #TABLE_SIZE entries
+     */
+    static void buildTables(std::uint16_t* data);
+
+    /**
+     * Hash of the model parameters the tables are computed from.
+     */
+    static std::uint32_t parameterHash();
+
+    /**
+     * Use precomputed lookup tables instead of building them.
+     *
+     * @param data the tables, as produced by #buildTables
+     * @return false if the tables are already in use
+     */
+    static bool setTables(const FilterTables::Data& data);
+
     /**
      * The digital range of one voice is 20 bits; create a scaling term
      * for multiplication which fits in 11 bits.
@@ -78,11 +111,14 @@ public:
     std::unique_ptr<Integrator8580> buildIntegrator();
 
 private:
-    FilterModelConfig8580();
+    explicit FilterModelConfig8580(const std::uint16_t* data);
     ~FilterModelConfig8580();
 
     static std::unique_ptr<FilterModelConfig8580> instance;
 
+    /// Lookup tables, built on first use or set from outside
+    static FilterTables::Data tables;
+
     // This allows access to the private constructor
     friend std::unique_ptr<FilterModelConfig8580>::deleter_type;
 
@@ -121,7 +157,7 @@ private:
     //@}
 
     /// Reverse op-amp transfer function.
-    OpAmpTable opamp_rev;
+    const std::uint16_t* opamp_rev;
 };
 
 } // namespace reSIDfp
@@ -0,0 +1,149 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "FilterTables.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "FilterModelConfig.h"
+#include "FilterModelConfig8580.h"
+
+#include "utils/mapFile.h"
+
+namespace reSIDfp
+{
+namespace
+{
+/// Bumped when the file layout changes
+constexpr std::uint32_t FILE_VERSION = 1;
+
+constexpr char MAGIC[8] = { 'r', 'e', 'S', 'I', 'D', 'f', 'p', 'T' };
+
+struct header_t
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint32_t hash6581;
+    std::uint32_t hash8580;
+    std::uint64_t size6581;
+    std::uint64_t size8580;
+};
+
+header_t makeHeader()
+{
+    header_t header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FILE_VERSION;
+    header.byteOrder = 0x01020304;
+    header.hash6581 = FilterModelConfig::parameterHash();
+    header.hash8580 = FilterModelConfig8580::parameterHash();
+    header.size6581 = FilterModelConfig::TABLE_SIZE;
+    header.size8580 = FilterModelConfig8580::TABLE_SIZE;
+    return header;
+}
+
+constexpr std::size_t FILE_SIZE = sizeof(header_t)
+    + (FilterModelConfig::TABLE_SIZE + FilterModelConfig8580::TABLE_SIZE) * sizeof(std::uint16_t);
+
+} // Anonymous namespace
+
+std::uint32_t FilterTables::hash(const void* data, std::size_t size, std::uint32_t h)
+{
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; i++)
+    {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return h;
+}
+
+bool FilterTables::save(const char* path)
+{
+    std::vector<std::uint16_t> data(FilterModelConfig::TABLE_SIZE + FilterModelConfig8580::TABLE_SIZE);
+    FilterModelConfig::buildTables(data.data());
+    FilterModelConfig8580::buildTables(data.data() + FilterModelConfig::TABLE_SIZE);
+
+    const header_t header = makeHeader();
+
+    // Write a temporary file and move it in place, so that processes
+    // mapping the old file keep it and no one sees a partial one
+    const std::string tmpPath = std::string(path) + ".tmp";
+
+    std::ofstream f(tmpPath, std::ios::out | std::ios::binary | std::ios::trunc);
+    f.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    f.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(std::uint16_t));
+    f.close();
+
+    if (f.fail())
+    {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+
+#ifdef _WIN32
+    // rename doesn't replace existing files here
+    std::remove(path);
+#endif
+    if (std::rename(tmpPath.c_str(), path) != 0)
+    {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool FilterTables::open(const char* path, Data& data6581, Data& data8580)
+{
+    std::size_t size = 0;
+    std::shared_ptr<const char> file = libsidplayfp::mapFile(path, size);
+    if (!file || size != FILE_SIZE)
+        return false;
+
+    const header_t expected = makeHeader();
+    if (std::memcmp(file.get(), &expected, sizeof(header_t)) != 0)
+        return false;
+
+    const std::uint16_t* tables = reinterpret_cast<const std::uint16_t*>(file.get() + sizeof(header_t));
+
+    // The tables keep the whole file alive
+    data6581 = Data(file, tables);
+    data8580 = Data(file, tables + FilterModelConfig::TABLE_SIZE);
+    return true;
+}
+
+bool FilterTables::load(const char* path)
+{
+    Data data6581;
+    Data data8580;
+    if (!open(path, data6581, data8580))
+        return false;
+
+    const bool ok6581 = FilterModelConfig::setTables(data6581);
+    const bool ok8580 = FilterModelConfig8580::setTables(data8580);
+    return ok6581 && ok8580;
+}
+
+} // namespace reSIDfp
@@ -0,0 +1,125 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef FILTERTABLES_H
+#define FILTERTABLES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace reSIDfp
+{
+
+/**
+ * Precomputed lookup tables of the 6581 and 8580 filter models.
+ *
+ * The tables take a while to build and some MB of memory in every
+ * process. They can be saved once to a file which is then mapped
+ * read-only, so that all the processes using it share the same pages.
+ * The file is tied to the model parameters and to the host byte order,
+ * files not matching the running library are rejected.
+ */
+class FilterTables
+{
+public:
+    /// Shared, read-only table data
+    using Data = std::shared_ptr<const std::uint16_t>;
+
+    /// Entries of the op-amp, gain and VCR tables
+    static constexpr std::size_t TABLE_ENTRIES = 1 << 16;
+
+    /**
+     * Entries of a summer table, for 2 - 6 input "resistors".
+     *
+     * @param i the table index
+     */
+    static constexpr std::size_t summerSize(std::size_t i) { return (2 + i) * TABLE_ENTRIES; }
+
+    /**
+     * Entries of a mixer table, for 0 - 7 input "resistors".
+     *
+     * @param i the table index
+     */
+    static constexpr std::size_t mixerSize(std::size_t i) { return (i == 0) ? 1 : i * TABLE_ENTRIES; }
+
+    /**
+     * Entries of the first n summer tables.
+     */
+    static constexpr std::size_t summersSize(std::size_t n)
+    {
+        std::size_t size = 0;
+        for (std::size_t i = 0; i < n; i++)
+            size += summerSize(i);
+        return size;
+    }
+
+    /**
+     * Entries of the first n mixer tables.
+     */
+    static constexpr std::size_t mixersSize(std::size_t n)
+    {
+        std::size_t size = 0;
+        for (std::size_t i = 0; i < n; i++)
+            size += mixerSize(i);
+        return size;
+    }
+
+    /**
+     * Build the tables of both models and write them to a file.
+     *
+     * @param path the file name
+     * @return false if the file could not be written
+     */
+    static bool save(const char* path);
+
+    /**
+     * Map a file written by #save without using it.
+     *
+     * @param path the file name
+     * @param data6581 receives the 6581 tables
+     * @param data8580 receives the 8580 tables
+     * @return false if the file is missing or doesn't match the library
+     */
+    static bool open(const char* path, Data& data6581, Data& data8580);
+
+    /**
+     * Use the tables from a file written by #save.
+     * Must be called before the first filter is created,
+     * otherwise the tables already in use are kept.
+     *
+     * @param path the file name
+     * @return true if the tables from the file are used
+     */
+    static bool load(const char* path);
+
+    /**
+     * FNV-1a hash, used to identify the model parameters.
+     *
+     * @param data the data to hash
+     * @param size size of the data in bytes
+     * @param h the hash of the preceding data
+     */
+    static std::uint32_t hash(const void* data, std::size_t size, std::uint32_t h = 2166136261u);
+};
+
+} // namespace reSIDfp
+
+#endif
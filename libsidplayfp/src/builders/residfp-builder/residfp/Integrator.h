@@ -25,6 +25,7 @@
 
 #include <cstdint>
 #include "FilterModelConfig.h"
+#include "Snapshot.h"
 
 namespace reSIDfp
 {
@@ -151,9 +152,9 @@ namespace reSIDfp
 class Integrator
 {
 public:
-    Integrator(const FilterModelConfig::OpAmpTable& vcr_kVg,
-               const FilterModelConfig::OpAmpTable& vcr_n_Ids_term,
-               const FilterModelConfig::OpAmpTable& opamp_rev,
+    Integrator(const std::uint16_t* vcr_kVg,
+               const std::uint16_t* vcr_n_Ids_term,
+               const std::uint16_t* opamp_rev,
                std::uint16_t kVddt, std::uint16_t n_snake) :
         vcr_kVg(vcr_kVg),
         vcr_n_Ids_term(vcr_n_Ids_term),
@@ -165,10 +166,16 @@ public:
 
     int solve(int vi);
 
+    void serialize(Snapshot& s)
+    {
+        s(vx);
+        s(vc);
+    }
+
 private:
-    const FilterModelConfig::OpAmpTable& vcr_kVg;
-    const FilterModelConfig::OpAmpTable& vcr_n_Ids_term;
-    const FilterModelConfig::OpAmpTable& opamp_rev;
+    const std::uint16_t* const vcr_kVg;
+    const std::uint16_t* const vcr_n_Ids_term;
+    const std::uint16_t* const opamp_rev;
 
     std::uint32_t Vddt_Vw_2 = 0;
     int vx = 0;
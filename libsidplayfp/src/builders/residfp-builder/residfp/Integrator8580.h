@@ -26,6 +26,7 @@
 #include <cassert>
 #include <cstdint>
 #include "FilterModelConfig8580.h"
+#include "Snapshot.h"
 
 namespace reSIDfp
 {
@@ -51,7 +52,7 @@ namespace reSIDfp
 class Integrator8580
 {
 public:
-    explicit Integrator8580(const FilterModelConfig8580::OpAmpTable& opamp_rev,
+    explicit Integrator8580(const std::uint16_t* opamp_rev,
                             double Vth, double denorm, double C, double k,
                             double uCox, double vmin, double N16) :
         opamp_rev(opamp_rev),
@@ -94,8 +95,14 @@ public:
 
     int solve(int vi) const;
 
+    void serialize(Snapshot& s)
+    {
+        s(vx);
+        s(vc);
+    }
+
 private:
-    const FilterModelConfig8580::OpAmpTable& opamp_rev;
+    const std::uint16_t* const opamp_rev;
 
     mutable int vx = 0;
     mutable int vc = 0;
@@ -32,6 +32,7 @@
 #include "Filter6581.h"
 #include "Filter8580.h"
 #include "Potentiometer.h"
+#include "Snapshot.h"
 #include "Voice.h"
 #include "WaveformCalculator.h"
 #include "resample/Resampler.h"
@@ -113,15 +114,6 @@ void SID::ageBusValue(unsigned int n)
     }
 }
 
-int SID::output() const
-{
-    const int v1 = voices[0]->output(voices[2]->wave());
-    const int v2 = voices[1]->output(voices[0]->wave());
-    const int v3 = voices[2]->output(voices[1]->wave());
-
-    return externalFilter->clock(filter->clock(v1, v2, v3));
-}
-
 void SID::voiceSync(bool sync)
 {
     if (sync)
@@ -203,6 +195,12 @@ void SID::reset()
         resampler->reset();
     }
 
+    for (auto& voice : voiceResampler)
+    {
+        if (voice)
+            voice->reset();
+    }
+
     busValue = 0;
     busValueTtl = 0;
     voiceSync(false);
@@ -249,6 +247,11 @@ unsigned char SID::read(int offset)
     return busValue;
 }
 
+unsigned char SID::readEnvelope(unsigned int voice) const
+{
+    return voices[voice]->envelope()->readENV();
+}
+
 void SID::write(int offset, unsigned char value)
 {
     busValue = value;
@@ -370,54 +373,145 @@ void SID::write(int offset, unsigned char value)
 
 void SID::setSamplingParameters(double clockFrequency, SamplingMethod method, double samplingFrequency, double highestAccurateFrequency)
 {
+    if (method != DECIMATE && method != RESAMPLE)
+        throw SIDError("Unknown sampling method");
+
+    // Same parameters, the resamplers only need to start over
+    if (resampler
+        && clockFrequency == sampling.clockFrequency
+        && samplingFrequency == sampling.samplingFrequency
+        && highestAccurateFrequency == sampling.highestAccurateFrequency
+        && method == sampling.method)
+    {
+        resampler->reset();
+        for (auto& voice : voiceResampler)
+        {
+            if (voice)
+                voice->reset();
+        }
+        return;
+    }
+
     externalFilter->setClockFrequency(clockFrequency);
 
-    switch (method)
+    sampling.clockFrequency = clockFrequency;
+    sampling.samplingFrequency = samplingFrequency;
+    sampling.highestAccurateFrequency = highestAccurateFrequency;
+    sampling.method = method;
+
+    resampler = createResampler();
+
+    for (auto& voice : voiceResampler)
     {
-    case DECIMATE:
-        resampler = std::make_unique<ZeroOrderResampler>(clockFrequency, samplingFrequency);
-        break;
+        if (voice)
+            voice = createResampler();
+    }
+}
 
-    case RESAMPLE:
-        resampler = TwoPassSincResampler::create(clockFrequency, samplingFrequency, highestAccurateFrequency);
-        break;
+std::unique_ptr<Resampler> SID::createResampler() const
+{
+    if (sampling.method == DECIMATE)
+        return std::make_unique<ZeroOrderResampler>(sampling.clockFrequency, sampling.samplingFrequency);
 
-    default:
-        throw SIDError("Unknown sampling method");
+    return TwoPassSincResampler::create(sampling.clockFrequency, sampling.samplingFrequency, sampling.highestAccurateFrequency);
+}
+
+void SID::enableVoiceOutputs(bool enable)
+{
+    for (auto& voice : voiceResampler)
+    {
+        voice = enable ? createResampler() : nullptr;
     }
 }
 
+void SID::prewarmResampler(double clockFrequency, double samplingFrequency, double highestAccurateFrequency)
+{
+    // Tables are cached on construction
+    TwoPassSincResampler::create(clockFrequency, samplingFrequency, highestAccurateFrequency);
+}
+
+namespace
+{
+/// Clip the sample to 16 bits
+inline void store(short& dest, const Resampler& resampler) { dest = resampler.getOutput(); }
+
+/// Keep the full sample
+inline void store(int& dest, const Resampler& resampler) { dest = resampler.output(); }
+} // Anonymous namespace
+
 int SID::clock(unsigned int cycles, short* buf)
+{
+    return clockSamples(cycles, buf, nullptr);
+}
+
+int SID::clock(unsigned int cycles, int* buf)
+{
+    return clockSamples(cycles, buf, nullptr);
+}
+
+int SID::clock(unsigned int cycles, int* buf, int* const* voiceBuf)
+{
+    return clockSamples(cycles, buf, voiceOutputsEnabled() ? voiceBuf : nullptr);
+}
+
+void SID::resampleVoices(int v1, int v2, int v3, int* const* voiceBuf, int pos)
+{
+    // Scale the ideal range [-2048*255, 2047*255] to 16 bits
+    if (voiceResampler[0]->input(v1 >> 4))
+        voiceBuf[0][pos] = voiceResampler[0]->output();
+    if (voiceResampler[1]->input(v2 >> 4))
+        voiceBuf[1][pos] = voiceResampler[1]->output();
+    if (voiceResampler[2]->input(v3 >> 4))
+        voiceBuf[2][pos] = voiceResampler[2]->output();
+}
+
+template<typename T>
+int SID::clockSamples(unsigned int cycles, T* buf, int* const* voiceBuf)
 {
     ageBusValue(cycles);
     int s = 0;
 
+    // Voice buffers at the current position
+    int* voicePos[3];
+    const auto voicesAt = [voiceBuf, &voicePos](int pos) -> int* const*
+    {
+        if (voiceBuf == nullptr)
+            return nullptr;
+        for (int i = 0; i < 3; i++)
+            voicePos[i] = voiceBuf[i] + pos;
+        return voicePos;
+    };
+
     while (cycles != 0)
     {
         unsigned int delta_t = std::min(nextVoiceSync, cycles);
 
         if (likely(delta_t > 0))
         {
-            for (unsigned int i = 0; i < delta_t; i++)
-            {
-                // clock waveform generators
-                voices[0]->wave()->clock();
-                voices[1]->wave()->clock();
-                voices[2]->wave()->clock();
+            cycles -= delta_t;
+            nextVoiceSync -= delta_t;
 
-                // clock envelope generators
-                voices[0]->envelope()->clock();
-                voices[1]->envelope()->clock();
-                voices[2]->envelope()->clock();
+            // Voices only interact through ring modulation within a sync period,
+            // it can be resolved in advance unless the accumulators are altered
+            // by the waveform output.
+            const bool block = blockClocking
+                && !voices[0]->wave()->outputAltersAccumulator()
+                && !voices[1]->wave()->outputAltersAccumulator()
+                && !voices[2]->wave()->outputAltersAccumulator();
 
-                if (unlikely(resampler->input(output())))
+            if (likely(block))
+            {
+                while (delta_t != 0)
                 {
-                    buf[s++] = resampler->getOutput();
+                    const unsigned int n = std::min(delta_t, BLOCK_SIZE);
+                    s += clockBlock(n, buf + s, voicesAt(s));
+                    delta_t -= n;
                 }
             }
-
-            cycles -= delta_t;
-            nextVoiceSync -= delta_t;
+            else
+            {
+                s += clockCycles(delta_t, buf + s, voicesAt(s));
+            }
         }
 
         if (unlikely(nextVoiceSync == 0))
@@ -429,33 +523,158 @@ int SID::clock(unsigned int cycles, short* buf)
     return s;
 }
 
-void SID::clockSilent(unsigned int cycles)
+template<typename T>
+int SID::clockCycles(unsigned int cycles, T* buf, int* const* voiceBuf)
+{
+    int s = 0;
+
+    for (unsigned int i = 0; i < cycles; i++)
+    {
+        // clock waveform generators
+        voices[0]->wave()->clock();
+        voices[1]->wave()->clock();
+        voices[2]->wave()->clock();
+
+        // clock envelope generators
+        voices[0]->envelope()->clock();
+        voices[1]->envelope()->clock();
+        voices[2]->envelope()->clock();
+
+        const int v1 = voices[0]->output(voices[2]->wave());
+        const int v2 = voices[1]->output(voices[0]->wave());
+        const int v3 = voices[2]->output(voices[1]->wave());
+
+        if (unlikely(voiceBuf != nullptr))
+        {
+            resampleVoices(v1, v2, v3, voiceBuf, s);
+        }
+
+        if (unlikely(resampler->input(externalFilter->clock(filter->clock(v1, v2, v3)))))
+        {
+            store(buf[s++], *resampler);
+        }
+    }
+
+    return s;
+}
+
+template<typename T>
+int SID::clockBlock(unsigned int cycles, T* buf, int* const* voiceBuf)
+{
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        voices[i]->wave()->predictAccumulator(cycles, accumulatorBuffer[i].data());
+        voices[i]->envelope()->clock(cycles, envelopeBuffer[i].data());
+    }
+
+    // Each voice is ring modulated by the previous one
+    voices[0]->wave()->clock(cycles, accumulatorBuffer[2].data(), waveformBuffer[0].data());
+    voices[1]->wave()->clock(cycles, accumulatorBuffer[0].data(), waveformBuffer[1].data());
+    voices[2]->wave()->clock(cycles, accumulatorBuffer[1].data(), waveformBuffer[2].data());
+
+    int s = 0;
+
+    for (unsigned int i = 0; i < cycles; i++)
+    {
+        const int v1 = static_cast<int>(waveformBuffer[0][i] * envelopeBuffer[0][i]);
+        const int v2 = static_cast<int>(waveformBuffer[1][i] * envelopeBuffer[1][i]);
+        const int v3 = static_cast<int>(waveformBuffer[2][i] * envelopeBuffer[2][i]);
+
+        if (unlikely(voiceBuf != nullptr))
+        {
+            resampleVoices(v1, v2, v3, voiceBuf, s);
+        }
+
+        if (unlikely(resampler->input(externalFilter->clock(filter->clock(v1, v2, v3)))))
+        {
+            store(buf[s++], *resampler);
+        }
+    }
+
+    return s;
+}
+
+void SID::clockSilent(unsigned int cycles, bool allEnvelopes)
 {
     ageBusValue(cycles);
 
+    // The envelopes don't depend on the oscillators,
+    // clock ENV3 only unless asked otherwise
+    if (allEnvelopes)
+    {
+        voices[0]->envelope()->clock(cycles);
+        voices[1]->envelope()->clock(cycles);
+    }
+    voices[2]->envelope()->clock(cycles);
+
     while (cycles != 0)
     {
-        int delta_t = std::min(nextVoiceSync, cycles);
+        unsigned int delta_t = std::min(nextVoiceSync, cycles);
 
         if (delta_t > 0)
         {
-            for (int i = 0; i < delta_t; i++)
-            {
-                // clock waveform generators (can affect OSC3)
-                voices[0]->wave()->clock();
-                voices[1]->wave()->clock();
-                voices[2]->wave()->clock();
+            cycles -= delta_t;
+            nextVoiceSync -= delta_t;
 
-                voices[0]->wave()->output(voices[2]->wave());
-                voices[1]->wave()->output(voices[0]->wave());
-                voices[2]->wave()->output(voices[1]->wave());
+            const bool block = blockClocking
+                && !voices[0]->wave()->outputAltersAccumulator()
+                && !voices[1]->wave()->outputAltersAccumulator()
+                && !voices[2]->wave()->outputAltersAccumulator();
 
-                // clock ENV3 only
-                voices[2]->envelope()->clock();
+            if (likely(block))
+            {
+                while (delta_t != 0)
+                {
+                    const unsigned int n = std::min(delta_t, BLOCK_SIZE);
+                    clockSilentBlock(n);
+                    delta_t -= n;
+                }
+            }
+            else
+            {
+                for (unsigned int i = 0; i < delta_t; i++)
+                {
+                    // clock waveform generators (can affect OSC3)
+                    voices[0]->wave()->clock();
+                    voices[1]->wave()->clock();
+                    voices[2]->wave()->clock();
+
+                    voices[0]->wave()->output(voices[2]->wave());
+                    voices[1]->wave()->output(voices[0]->wave());
+                    voices[2]->wave()->output(voices[1]->wave());
+                }
             }
+        }
+
+        if (nextVoiceSync == 0)
+        {
+            voiceSync(true);
+        }
+    }
+}
+
+void SID::clockEnvelopes(unsigned int cycles)
+{
+    ageBusValue(cycles);
+
+    for (auto& voice : voices)
+    {
+        voice->envelope()->clock(cycles);
+    }
 
+    while (cycles != 0)
+    {
+        const unsigned int delta_t = std::min(nextVoiceSync, cycles);
+
+        if (delta_t > 0)
+        {
             cycles -= delta_t;
             nextVoiceSync -= delta_t;
+
+            for (auto& voice : voices)
+            {
+                voice->wave()->skip(delta_t);
+            }
         }
 
         if (nextVoiceSync == 0)
@@ -465,4 +684,83 @@ void SID::clockSilent(unsigned int cycles)
     }
 }
 
+void SID::clockSilentBlock(unsigned int cycles)
+{
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        voices[i]->wave()->predictAccumulator(cycles, accumulatorBuffer[i].data());
+    }
+
+    // Each voice is ring modulated by the previous one
+    voices[0]->wave()->clock(cycles, accumulatorBuffer[2].data(), waveformBuffer[0].data());
+    voices[1]->wave()->clock(cycles, accumulatorBuffer[0].data(), waveformBuffer[1].data());
+    voices[2]->wave()->clock(cycles, accumulatorBuffer[1].data(), waveformBuffer[2].data());
+}
+
+void SID::copyVoiceState(const SID &source)
+{
+    for (std::size_t i = 0; i < voices.size(); i++)
+    {
+        *voices[i]->wave() = *source.voices[i]->wave();
+        *voices[i]->envelope() = *source.voices[i]->envelope();
+    }
+
+    copyBusState(source);
+    nextVoiceSync = source.nextVoiceSync;
+}
+
+void SID::copyBusState(const SID &source)
+{
+    busValue = source.busValue;
+    busValueTtl = source.busValueTtl;
+}
+
+void SID::serialize(Snapshot& s)
+{
+    ChipModel chipModel = model;
+    bool resampling = resampler != nullptr;
+    bool voiceOutputs = voiceOutputsEnabled();
+    s(chipModel);
+    s(resampling);
+    s(voiceOutputs);
+    s.check(chipModel == model && resampling == (resampler != nullptr) && voiceOutputs == voiceOutputsEnabled());
+    if (!s.good())
+        return;
+
+    s(busValue);
+    s(busValueTtl);
+    s(nextVoiceSync);
+
+    for (std::unique_ptr<Voice> &voice : voices)
+    {
+        voice->wave()->serialize(s);
+        voice->envelope()->serialize(s);
+    }
+
+    filter->serialize(s);
+    externalFilter->serialize(s);
+
+    if (resampler)
+        resampler->serialize(s);
+
+    for (auto& voice : voiceResampler)
+    {
+        if (voice)
+            voice->serialize(s);
+    }
+}
+
+void SID::saveState(std::vector<unsigned char>& out)
+{
+    Snapshot s(out);
+    serialize(s);
+}
+
+bool SID::loadState(const unsigned char* data, std::size_t size)
+{
+    Snapshot s(data, size);
+    serialize(s);
+    return s.good() && s.atEnd();
+}
+
 } // namespace reSIDfp
@@ -24,7 +24,9 @@
 #define SIDFP_H
 
 #include <array>
+#include <cstddef>
 #include <memory>
+#include <vector>
 
 #include "siddefs-fp.h"
 
@@ -37,6 +39,7 @@ class Filter6581;
 class Filter8580;
 class Potentiometer;
 class Resampler;
+class Snapshot;
 class Voice;
 
 /**
@@ -112,6 +115,14 @@ public:
      */
     unsigned char read(int offset);
 
+    /**
+     * Read the envelope level of a voice,
+     * the same value ENV3 gives for the third one.
+     *
+     * @param voice the voice number, from 0 to 2
+     */
+    unsigned char readEnvelope(unsigned int voice) const;
+
     /**
      * Write registers.
      *
@@ -155,6 +166,18 @@ public:
      */
     void setSamplingParameters(double clockFrequency, SamplingMethod method, double samplingFrequency, double highestAccurateFrequency);
 
+    /**
+     * Precompute the resampling filter tables for the given parameters
+     * so that following calls to #setSamplingParameters with
+     * the RESAMPLE method don't have to build them.
+     * Safe to call from any thread.
+     *
+     * @param clockFrequency System clock frequency at Hz
+     * @param samplingFrequency Desired output sampling rate
+     * @param highestAccurateFrequency
+     */
+    static void prewarmResampler(double clockFrequency, double samplingFrequency, double highestAccurateFrequency);
+
     /**
      * Clock SID forward using chosen output sampling algorithm.
      *
@@ -164,17 +187,115 @@ public:
      */
     int clock(unsigned int cycles, short* buf);
 
+    /**
+     * Clock SID forward using chosen output sampling algorithm,
+     * the samples are not clipped to 16 bits.
+     *
+     * @param cycles c64 clocks to clock
+     * @param buf audio output buffer
+     * @return number of samples produced
+     */
+    int clock(unsigned int cycles, int* buf);
+
+    /**
+     * Clock SID forward like the unclipped #clock variant,
+     * also producing the output of each voice if enabled
+     * with #enableVoiceOutputs.
+     *
+     * @param cycles c64 clocks to clock
+     * @param buf audio output buffer
+     * @param voiceBuf output buffers of the three voices
+     * @return number of samples produced, the same for all the buffers
+     */
+    int clock(unsigned int cycles, int* buf, int* const* voiceBuf);
+
+    /**
+     * Produce the output of each voice on its own next to the chip output,
+     * to extract the voices in a single pass. The voices are taken
+     * before the filter and the volume control, each one through
+     * its own resampler, and scaled so that a full scale waveform
+     * at full envelope reaches the 16 bit range.
+     * Must be called after #setSamplingParameters.
+     *
+     * @param enable true to produce the voice outputs
+     */
+    void enableVoiceOutputs(bool enable);
+
+    /**
+     * Check if the voice outputs are enabled.
+     */
+    bool voiceOutputsEnabled() const { return voiceResampler[0] != nullptr; }
+
+    /**
+     * Select how #clock processes the cycles.
+     * By default each voice is run for blocks of cycles at once
+     * whenever possible, disabling this clocks everything cycle by
+     * cycle. Both produce identical output.
+     *
+     * @param enable false to clock cycle by cycle
+     */
+    void enableBlockClocking(bool enable) { blockClocking = enable; }
+
     /**
      * Clock SID forward with no audio production.
      *
      * _Warning_:
      * You can't mix this method of clocking with the audio-producing
      * clock() because components that don't affect OSC3/ENV3 are not
-     * emulated.
+     * emulated. With allEnvelopes set only the filters lag behind,
+     * which is good enough to resume audio after a seek.
+     *
+     * @param cycles c64 clocks to clock.
+     * @param allEnvelopes also clock the envelopes of voices 1 and 2
+     */
+    void clockSilent(unsigned int cycles, bool allEnvelopes = false);
+
+    /**
+     * Clock SID forward keeping only the envelopes and the
+     * oscillator phases up to date, even cheaper than #clockSilent.
+     * OSC3 and the noise register are not exact afterwards,
+     * good enough to follow a tune but not to resume audio.
      *
      * @param cycles c64 clocks to clock.
      */
-    void clockSilent(unsigned int cycles);
+    void clockEnvelopes(unsigned int cycles);
+
+    /**
+     * Copy the oscillator, envelope and data bus state from
+     * another chip of the same model, so that a silently clocked
+     * copy can take over reading OSC3/ENV3 from that point.
+     *
+     * @param source the chip to copy from
+     */
+    void copyVoiceState(const SID &source);
+
+    /**
+     * Copy the data bus value and its remaining lifetime
+     * from another chip, so that reads of the write-only
+     * registers see the accesses the other chip has seen.
+     *
+     * @param source the chip to copy from
+     */
+    void copyBusState(const SID &source);
+
+    /**
+     * Append the chip state to the buffer.
+     * The configuration (model, sampling parameters, filter settings)
+     * is not part of the state.
+     *
+     * @param out the buffer
+     */
+    void saveState(std::vector<unsigned char>& out);
+
+    /**
+     * Restore a state saved by a chip with the same configuration.
+     *
+     * @param data the state
+     * @param size the state size
+     * @return false if the state is truncated or doesn't fit this chip,
+     *         which is then left in an undefined state
+     */
+    bool loadState(const unsigned char* data, std::size_t size);
 
     /**
      * Set filter curve parameter for 6581 model.
@@ -206,11 +327,49 @@ private:
     void ageBusValue(unsigned int n);
 
     /**
-     * Get output sample.
+     * Clock SID forward one cycle at a time.
      *
-     * @return the output sample
+     * @param cycles c64 clocks to clock
+     * @param buf audio output buffer
+     * @return number of samples produced
+     */
+    template<typename T>
+    int clockCycles(unsigned int cycles, T* buf, int* const* voiceBuf);
+
+    /**
+     * Clock SID forward running the voices for blocks of cycles.
+     * Must not be used if a voice output alters its accumulator.
+     *
+     * @param cycles c64 clocks to clock, up to #BLOCK_SIZE
+     * @param buf audio output buffer
+     * @return number of samples produced
      */
-    int output() const;
+    template<typename T>
+    int clockBlock(unsigned int cycles, T* buf, int* const* voiceBuf);
+
+    /**
+     * Common implementation of the #clock variants.
+     */
+    template<typename T>
+    int clockSamples(unsigned int cycles, T* buf, int* const* voiceBuf);
+
+    /**
+     * Feed the voice resamplers, storing their output at the given
+     * position when ready. They run in step with the chip output resampler.
+     */
+    void resampleVoices(int v1, int v2, int v3, int* const* voiceBuf, int pos);
+
+    /**
+     * Create a resampler with the current sampling parameters.
+     */
+    std::unique_ptr<Resampler> createResampler() const;
+
+    /**
+     * Silent counterpart of #clockBlock, for the oscillators only.
+     *
+     * @param cycles c64 clocks to clock, up to #BLOCK_SIZE
+     */
+    void clockSilentBlock(unsigned int cycles);
 
     /**
      * Calculate the numebr of cycles according to current parameters
@@ -220,6 +379,11 @@ private:
      */
     void voiceSync(bool sync);
 
+    /**
+     * Save or restore the state.
+     */
+    void serialize(Snapshot& s);
+
     /// Currently active filter
     Filter* filter;
 
@@ -238,6 +402,18 @@ private:
     /// Resampler used by audio generation code.
     std::unique_ptr<Resampler> resampler;
 
+    /// Resamplers of the voice outputs, null unless enabled
+    std::array<std::unique_ptr<Resampler>, 3> voiceResampler;
+
+    /// Parameters of the last #setSamplingParameters call
+    struct
+    {
+        double clockFrequency;
+        double samplingFrequency;
+        double highestAccurateFrequency;
+        SamplingMethod method;
+    } sampling{};
+
     /// Paddle X register support
     std::unique_ptr<Potentiometer> const potX;
 
@@ -264,6 +440,17 @@ private:
 
     /// Flags for muted channels
     std::array<bool, 3> muted{};
+
+    /// Run voices for blocks of cycles
+    bool blockClocking = true;
+
+    /// Number of cycles processed at once by #clockBlock
+    static constexpr unsigned int BLOCK_SIZE = 64;
+
+    /// Per voice scratch buffers for #clockBlock and #clockSilentBlock
+    std::array<std::array<unsigned int, BLOCK_SIZE>, 3> accumulatorBuffer;
+    std::array<std::array<float, BLOCK_SIZE>, 3> waveformBuffer;
+    std::array<std::array<float, BLOCK_SIZE>, 3> envelopeBuffer;
 };
 
 } // namespace reSIDfp
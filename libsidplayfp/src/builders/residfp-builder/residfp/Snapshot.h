@@ -0,0 +1,111 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef RESIDFP_SNAPSHOT_H
+#define RESIDFP_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace reSIDfp
+{
+
+/**
+ * Binary chip state, either being saved or restored.
+ *
+ * Components describe their state once by passing each field
+ * to operator(), the direction is chosen when constructing the object.
+ * Only the fields changing while clocking are stored, the configuration
+ * (chip model, sampling parameters, filter curves) must be the same
+ * when restoring. The format is that of the host and is not meant to be
+ * exchanged between different builds.
+ */
+class Snapshot
+{
+public:
+    /**
+     * Save the state at the end of the given buffer.
+     */
+    explicit Snapshot(std::vector<unsigned char>& out) :
+        out(&out) {}
+
+    /**
+     * Restore the state from the given data.
+     */
+    Snapshot(const unsigned char* data, std::size_t size) :
+        in(data),
+        end(data + size) {}
+
+    bool loading() const { return out == nullptr; }
+
+    /**
+     * False if the data was too short or inconsistent.
+     */
+    bool good() const { return status; }
+
+    /**
+     * True when all the data has been consumed.
+     */
+    bool atEnd() const { return in == end; }
+
+    /**
+     * Mark the data as inconsistent if the condition is false.
+     */
+    void check(bool condition) { status = status && condition; }
+
+    template<typename T>
+    void operator()(T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain data can be stored");
+        io(&value, sizeof(T));
+    }
+
+    void io(void* data, std::size_t size)
+    {
+        if (out != nullptr)
+        {
+            const unsigned char* const p = static_cast<const unsigned char*>(data);
+            out->insert(out->end(), p, p + size);
+        }
+        else if (status && size <= static_cast<std::size_t>(end - in))
+        {
+            std::memcpy(data, in, size);
+            in += size;
+        }
+        else
+        {
+            status = false;
+        }
+    }
+
+private:
+    std::vector<unsigned char>* const out = nullptr;
+
+    const unsigned char* in = nullptr;
+    const unsigned char* const end = nullptr;
+
+    bool status = true;
+};
+
+} // namespace reSIDfp
+
+#endif
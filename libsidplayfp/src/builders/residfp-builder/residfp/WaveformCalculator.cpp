@@ -23,10 +23,14 @@
 
 #include <cmath>
 
+#include "Dac.h"
+
 namespace reSIDfp
 {
 namespace
 {
+constexpr unsigned int DAC_BITS = 12;
+
 /**
  * Parameters derived with the Monte Carlo method based on
  * samplings by kevtris. Code and data available in the project repository [1].
@@ -200,4 +204,26 @@ matrix_t* WaveformCalculator::buildTable(ChipModel model)
     return &(CACHE.insert(lb, cw_cache_t::value_type(cfgArray, wftable))->second);
 }
 
+const float* WaveformCalculator::getDac(ChipModel model)
+{
+    std::unique_ptr<dac_t>& table = DAC_CACHE[model == MOS6581 ? 0 : 1];
+
+    if (!table)
+    {
+        Dac dacBuilder(DAC_BITS);
+        dacBuilder.kinkedDac(model);
+
+        const double offset = dacBuilder.getOutput(model == MOS6581 ? 0x380 : 0x9c0);
+
+        table = std::make_unique<dac_t>();
+        for (unsigned int i = 0; i < table->values.size(); i++)
+        {
+            const double dacValue = dacBuilder.getOutput(i);
+            table->values[i] = static_cast<float>(dacValue - offset);
+        }
+    }
+
+    return table->values.data();
+}
+
 } // namespace reSIDfp
@@ -22,7 +22,9 @@
 #ifndef WAVEFORMCALCULATOR_h
 #define WAVEFORMCALCULATOR_h
 
+#include <array>
 #include <map>
+#include <memory>
 
 #include "array.h"
 #include "siddefs-fp.h"
@@ -104,12 +106,31 @@ public:
      */
     matrix_t* buildTable(ChipModel model);
 
+    /**
+     * Get the waveform DAC table, the output of each 12 bit
+     * waveform value relative to the zero level.
+     * The table is shared by all the voices of the same model.
+     *
+     * @param model Chip model to use
+     * @return DAC table of 4096 entries
+     */
+    const float* getDac(ChipModel model);
+
 private:
     using cw_cache_t = std::map<const CombinedWaveformConfig*, matrix_t>;
 
+    /// Aligned so that the table spans the fewest cache lines
+    struct alignas(64) dac_t
+    {
+        std::array<float, 4096> values;
+    };
+
     WaveformCalculator() = default;
 
     cw_cache_t CACHE;
+
+    /// DAC tables by chip model
+    std::array<std::unique_ptr<dac_t>, 2> DAC_CACHE;
 };
 
 } // namespace reSIDfp
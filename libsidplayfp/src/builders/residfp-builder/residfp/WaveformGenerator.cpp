@@ -23,8 +23,9 @@
 #include "WaveformGenerator.h"
 
 #include <cstddef>
+#include <cstdint>
 
-#include "Dac.h"
+#include "WaveformCalculator.h"
 
 namespace reSIDfp
 {
@@ -54,8 +55,6 @@ constexpr int FLOATING_OUTPUT_TTL_8580 = 5000000; // ~5s;
 constexpr int SHIFT_REGISTER_RESET_6581 = 200000;  // ~200ms
 constexpr int SHIFT_REGISTER_RESET_8580 = 5000000; // ~5s
 
-constexpr std::size_t DAC_BITS = 12;
-
 /*
  * This is what happens when the lfsr is clocked:
  *
@@ -144,6 +143,9 @@ void WaveformGenerator::set_noise_output()
     no_noise_or_noise_output = no_noise | noise_output;
 }
 
+WaveformGenerator::WaveformGenerator() :
+    dac(WaveformCalculator::getInstance()->getDac(MOS6581)) {}
+
 void WaveformGenerator::setWaveformModels(matrix_t* models)
 {
     model_wave = models;
@@ -153,16 +155,7 @@ void WaveformGenerator::setChipModel(ChipModel chipModel)
 {
     is6581 = chipModel == MOS6581;
 
-    Dac dacBuilder(DAC_BITS);
-    dacBuilder.kinkedDac(chipModel);
-
-    const double offset = dacBuilder.getOutput(is6581 ? 0x380 : 0x9c0);
-
-    for (unsigned int i = 0; i < dac.size(); i++)
-    {
-        const double dacValue = dacBuilder.getOutput(i);
-        dac[i] = static_cast<float>(dacValue - offset);
-    }
+    dac = WaveformCalculator::getInstance()->getDac(chipModel);
 
     model_shift_register_reset = is6581 ? SHIFT_REGISTER_RESET_6581 : SHIFT_REGISTER_RESET_8580;
 }
@@ -334,12 +327,44 @@ void WaveformGenerator::reset()
     floating_output_ttl = 0;
 }
 
-float WaveformGenerator::output(const WaveformGenerator* ringModulator)
+void WaveformGenerator::serialize(Snapshot& s)
+{
+    s(pw);
+    s(shift_register);
+    s(shift_pipeline);
+    s(ring_msb_mask);
+    s(no_noise);
+    s(noise_output);
+    s(no_noise_or_noise_output);
+    s(no_pulse);
+    s(pulse_output);
+    s(waveform);
+    s(floating_output_ttl);
+    s(waveform_output);
+    s(accumulator);
+    s(freq);
+    s(tri_saw_pipeline);
+    s(osc3);
+    s(shift_register_reset);
+    s(test);
+    s(sync);
+    s(msb_rising);
+
+    if (s.loading())
+    {
+        s.check(waveform <= 0x0f && accumulator <= 0xffffff);
+
+        // The table pointer follows the waveform
+        wave = model_wave ? (*model_wave)[waveform & 0x7] : nullptr;
+    }
+}
+
+float WaveformGenerator::output(unsigned int ringModulatorAccumulator)
 {
     // Set output value.
     if (likely(waveform != 0))
     {
-        const unsigned int ix = (accumulator ^ (~ringModulator->accumulator & ring_msb_mask)) >> 12;
+        const unsigned int ix = (accumulator ^ (~ringModulatorAccumulator & ring_msb_mask)) >> 12;
 
         // The bit masks no_pulse and no_noise are used to achieve branch-free
         // calculation of the output value.
@@ -393,4 +418,73 @@ float WaveformGenerator::output(const WaveformGenerator* ringModulator)
     return dac[waveform_output];
 }
 
+void WaveformGenerator::clock(unsigned int n, const unsigned int* ringModulator, float* buf)
+{
+    for (unsigned int i = 0; i < n; i++)
+    {
+        clock();
+        buf[i] = output(ringModulator[i]);
+    }
+}
+
+void WaveformGenerator::skip(unsigned int n)
+{
+    if (n == 0)
+        return;
+
+    if (unlikely(test))
+    {
+        if (unlikely(shift_register_reset != 0))
+        {
+            if (static_cast<unsigned int>(shift_register_reset) <= n)
+            {
+                reset_shift_register();
+                set_noise_output();
+            }
+            else
+            {
+                shift_register_reset -= n;
+            }
+        }
+
+        pulse_output = 0xfff;
+        msb_rising = false;
+        return;
+    }
+
+    const uint64_t start = accumulator;
+    const uint64_t end = start + static_cast<uint64_t>(freq) * n;
+    accumulator = static_cast<unsigned int>(end & 0xffffff);
+
+    // As seen by the last cycle, for synchronization
+    const unsigned int previous = static_cast<unsigned int>((end - freq) & 0xffffff);
+    msb_rising = (~previous & accumulator & 0x800000) != 0;
+
+    // One shift for each time bit 19 goes high, plus a pending one
+    uint64_t shifts = ((end + 0x80000) >> 20) - ((start + 0x80000) >> 20);
+    if (shift_pipeline != 0)
+    {
+        shift_pipeline = 0;
+        shifts++;
+    }
+
+    for (; shifts != 0; shifts--)
+    {
+        clock_shift_register(((shift_register << 22) ^ (shift_register << 17)) & (1 << 22));
+    }
+}
+
+void WaveformGenerator::predictAccumulator(unsigned int n, unsigned int* buf) const
+{
+    // The accumulator is held while the test bit is set
+    const unsigned int delta = test ? 0 : freq;
+
+    unsigned int acc = accumulator;
+    for (unsigned int i = 0; i < n; i++)
+    {
+        acc = (acc + delta) & 0xffffff;
+        buf[i] = acc;
+    }
+}
+
 } // namespace reSIDfp
@@ -23,9 +23,9 @@
 #ifndef WAVEFORMGENERATOR_H
 #define WAVEFORMGENERATOR_H
 
-#include <array>
 #include "array.h"
 #include "siddefs-fp.h"
+#include "Snapshot.h"
 
 namespace reSIDfp
 {
@@ -85,6 +85,8 @@ namespace reSIDfp
 class WaveformGenerator
 {
 public:
+    WaveformGenerator();
+
     // These five functions are not intended to be used in anything other than unit tests and internally.
     void clock_shift_register(unsigned int bit0);
     void write_shift_register();
@@ -107,6 +109,42 @@ public:
      */
     void clock();
 
+    /**
+     * Clock the generator for a block of cycles, producing the output
+     * of each cycle. Same as calling clock() and output() in turn.
+     *
+     * @param n number of cycles
+     * @param ringModulator accumulator value of the ring modulating oscillator for each cycle
+     * @param buf output buffer, n values
+     */
+    void clock(unsigned int n, const unsigned int* ringModulator, float* buf);
+
+    /**
+     * Accumulator values for the next cycles, without clocking.
+     * Only valid if the accumulator is not changed by output(),
+     * see #outputAltersAccumulator.
+     *
+     * @param n number of cycles
+     * @param buf output buffer, n values
+     */
+    void predictAccumulator(unsigned int n, unsigned int* buf) const;
+
+    /**
+     * Move the accumulator and the noise register ahead
+     * without producing the output. The noise register
+     * is shifted without pipeline delay nor combined
+     * waveform writeback, so it is not exact.
+     *
+     * @param n number of cycles
+     */
+    void skip(unsigned int n);
+
+    /**
+     * Check if output() may change the accumulator,
+     * this happens on the 6581 with combined sawtooth waveforms.
+     */
+    bool outputAltersAccumulator() const { return is6581 && (waveform & 2) && (waveform & 0xd); }
+
     /**
      * Synchronize oscillators.
      * This must be done after all the oscillators have been clock()'ed,
@@ -157,13 +195,18 @@ public:
      */
     void reset();
 
+    /**
+     * Save or restore the state.
+     */
+    void serialize(Snapshot& s);
+
     /**
      * 12-bit waveform output as an analogue float value.
      *
      * @param ringModulator The oscillator ring-modulating current one.
      * @return output the waveform generator output
      */
-    float output(const WaveformGenerator* ringModulator);
+    float output(const WaveformGenerator* ringModulator) { return output(ringModulator->accumulator); }
 
     /**
      * Read OSC3 value.
@@ -193,6 +236,8 @@ public:
 private:
     unsigned int get_noise_writeback() const;
 
+    float output(unsigned int ringModulatorAccumulator);
+
     matrix_t* model_wave = nullptr;
 
     short* wave = nullptr;
@@ -246,7 +291,8 @@ private:
 
     bool is6581 = true;
 
-    std::array<float, 4096> dac;
+    /// Waveform DAC, shared by the voices of the same chip model
+    const float* dac = nullptr;
 };
 
 } // namespace reSIDfp
@@ -0,0 +1,188 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "Convolve.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#  define CONVOLVE_X86
+#  include <immintrin.h>
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#    define TARGET(isa)
+#  else
+#    define TARGET(isa) __attribute__((target(isa)))
+#  endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  define CONVOLVE_NEON
+#  include <arm_neon.h>
+#endif
+
+namespace reSIDfp
+{
+namespace
+{
+int convolveScalar(const short* a, const short* b, int bLength)
+{
+    int out = 0;
+
+    for (int i = 0; i < bLength; i++)
+    {
+        out += a[i] * b[i];
+    }
+
+    return out;
+}
+
+#ifdef CONVOLVE_X86
+TARGET("sse2")
+int convolveSSE2(const short* a, const short* b, int bLength)
+{
+    __m128i acc = _mm_setzero_si128();
+
+    const int n = bLength / 8;
+
+    for (int i = 0; i < n; i++)
+    {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+        const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(va, vb));
+        a += 8;
+        b += 8;
+    }
+
+    // Horizontal sum of the four 32 bit lanes
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+
+    return _mm_cvtsi128_si32(acc) + convolveScalar(a, b, bLength & 7);
+}
+
+TARGET("avx2")
+int convolveAVX2(const short* a, const short* b, int bLength)
+{
+    __m256i acc = _mm256_setzero_si256();
+
+    const int n = bLength / 16;
+
+    for (int i = 0; i < n; i++)
+    {
+        const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
+        const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));
+        a += 16;
+        b += 16;
+    }
+
+    // Horizontal sum of the eight 32 bit lanes
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+
+    return _mm_cvtsi128_si32(sum) + convolveScalar(a, b, bLength & 15);
+}
+
+bool hasSSE2()
+{
+#if defined(__x86_64__) || defined(_M_X64)
+    return true;
+#elif defined(_MSC_VER)
+    int regs[4];
+    __cpuid(regs, 1);
+    return (regs[3] & (1 << 26)) != 0;
+#else
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+
+bool hasAVX2()
+{
+#ifdef _MSC_VER
+    int regs[4];
+    __cpuid(regs, 0);
+    if (regs[0] < 7)
+        return false;
+
+    // The OS must save the YMM registers
+    __cpuid(regs, 1);
+    const bool osxsave = (regs[2] & (1 << 27)) != 0;
+    if (!osxsave || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+#ifdef CONVOLVE_NEON
+int convolveNEON(const short* a, const short* b, int bLength)
+{
+    int32x4_t acc = vdupq_n_s32(0);
+
+    const int n = bLength / 8;
+
+    for (int i = 0; i < n; i++)
+    {
+        const int16x8_t va = vld1q_s16(a);
+        const int16x8_t vb = vld1q_s16(b);
+        acc = vmlal_s16(acc, vget_low_s16(va), vget_low_s16(vb));
+        acc = vmlal_s16(acc, vget_high_s16(va), vget_high_s16(vb));
+        a += 8;
+        b += 8;
+    }
+
+    // Horizontal sum of the four 32 bit lanes
+    const int32x2_t sum = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+    const int out = vget_lane_s32(vpadd_s32(sum, sum), 0);
+
+    return out + convolveScalar(a, b, bLength & 7);
+}
+#endif
+} // Anonymous namespace
+
+std::vector<ConvolveKernel> getConvolveKernels()
+{
+    std::vector<ConvolveKernel> kernels;
+
+    kernels.push_back({ "scalar", convolveScalar });
+
+#ifdef CONVOLVE_X86
+    if (hasSSE2())
+        kernels.push_back({ "SSE2", convolveSSE2 });
+    if (hasAVX2())
+        kernels.push_back({ "AVX2", convolveAVX2 });
+#endif
+
+#ifdef CONVOLVE_NEON
+    kernels.push_back({ "NEON", convolveNEON });
+#endif
+
+    return kernels;
+}
+
+const ConvolveKernel& getConvolveKernel()
+{
+    static const ConvolveKernel kernel = getConvolveKernels().back();
+    return kernel;
+}
+
+} // namespace reSIDfp
@@ -0,0 +1,67 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CONVOLVE_H
+#define CONVOLVE_H
+
+#include <vector>
+
+namespace reSIDfp
+{
+
+/**
+ * Dot product of two 16 bit vectors with 32 bit accumulation.
+ *
+ * @param a sample buffer input
+ * @param b sinc buffer
+ * @param bLength length of the sinc buffer
+ * @return the sum of the products
+ */
+using convolve_t = int (*)(const short* a, const short* b, int bLength);
+
+/**
+ * A convolution kernel.
+ */
+struct ConvolveKernel
+{
+    /// Instruction set name
+    const char* name;
+
+    /// The kernel
+    convolve_t convolve;
+};
+
+/**
+ * Get the kernels supported by the running CPU.
+ * The portable scalar reference comes first,
+ * the remaining ones are sorted from slowest to fastest.
+ * All of them produce bit identical results.
+ */
+std::vector<ConvolveKernel> getConvolveKernels();
+
+/**
+ * Get the fastest kernel supported by the running CPU.
+ * The selection is done once, on first call.
+ */
+const ConvolveKernel& getConvolveKernel();
+
+} // namespace reSIDfp
+
+#endif
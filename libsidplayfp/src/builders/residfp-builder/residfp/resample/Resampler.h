@@ -25,6 +25,8 @@
 #include <algorithm>
 #include <climits>
 
+#include "../Snapshot.h"
+
 namespace reSIDfp
 {
 
@@ -58,11 +60,21 @@ public:
         return static_cast<short>(std::clamp(value, SHRT_MIN, SHRT_MAX));
     }
 
+    /**
+     * Output a sample from resampler without clipping.
+     *
+     * @return resampled sample
+     */
+    virtual int output() const = 0;
+
     virtual void reset() = 0;
 
-protected:
-    virtual int output() const = 0;
+    /**
+     * Save or restore the state.
+     */
+    virtual void serialize(Snapshot& s) = 0;
 
+protected:
     Resampler() = default;
 };
 
@@ -22,11 +22,13 @@
 
 #include "SincResampler.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <limits>
 #include <map>
-#include <sstream>
+#include <mutex>
+#include <tuple>
 
 #include "siddefs-fp.h"
 
@@ -34,19 +36,22 @@
 #  include "config.h"
 #endif
 
-#ifdef HAVE_MMINTRIN_H
-#  include <mmintrin.h>
-#endif
-
 namespace reSIDfp
 {
 namespace
 {
-using fir_cache_t = std::map<std::string, matrix_t>;
+/// FIR table key: filter length, filter resolution, clock frequency, sampling frequency.
+using fir_key_t = std::tuple<int, int, double, double>;
+
+using fir_cache_t = std::map<fir_key_t, std::shared_ptr<const matrix_t>>;
 
 /// Cache for the expensive FIR table computation results.
+/// Tables are immutable once published and shared among all resamplers.
 fir_cache_t FIR_CACHE;
 
+/// Guards FIR_CACHE.
+std::mutex FIR_CACHE_LOCK;
+
 /// Maximum error acceptable in I0 is 1e-6, or ~96 dB.
 constexpr double I0E = 1e-6;
 
@@ -80,42 +85,54 @@ double I0(double x)
 }
 
 /**
- * Calculate convolution with sample and sinc.
+ * Round and scale the convolution result.
+ */
+inline int scaleConvolution(int value)
+{
+    return (value + (1 << 14)) >> 15;
+}
+
+/**
+ * Calculate the sinc tables.
  *
- * @param a sample buffer input
- * @param b sinc buffer
- * @param bLength length of the sinc buffer
- * @return convolved result
+ * @param firN filter length
+ * @param firRES filter resolution
+ * @param cyclesPerSampleD input cycles per output sample
+ * @param beta Kaiser window shape parameter
+ * @return the newly built FIR table
  */
-int convolve(const short* a, const short* b, int bLength)
+std::shared_ptr<const matrix_t> buildFirTable(int firN, int firRES, double cyclesPerSampleD, double beta)
 {
-#ifdef HAVE_MMINTRIN_H
-    __m64 acc = _mm_setzero_si64();
+    const double I0beta = I0(beta);
 
-    const int n = bLength / 4;
+    // Allocate memory for FIR tables.
+    auto firTable = std::make_shared<matrix_t>(firRES, firN);
 
-    for (int i = 0; i < n; i++)
+    // The cutoff frequency is midway through the transition band, in effect the same as nyquist.
+    const double wc = M_PI;
+
+    // Calculate the sinc tables.
+    const double scale = 32768.0 * wc / cyclesPerSampleD / M_PI;
+
+    for (int i = 0; i < firRES; i++)
     {
-        const __m64 tmp = _mm_madd_pi16(*(__m64*)a, *(__m64*)b);
-        acc = _mm_add_pi16(acc, tmp);
-        a += 4;
-        b += 4;
-    }
+        const double jPhase = static_cast<double>(i) / firRES + firN / 2;
 
-    int out = _mm_cvtsi64_si32(acc) + _mm_cvtsi64_si32(_mm_srli_si64(acc, 32));
-    _mm_empty();
+        for (int j = 0; j < firN; j++)
+        {
+            const double x = j - jPhase;
 
-    bLength &= 3;
-#else
-    int out = 0;
-#endif
+            const double xt = x / (firN / 2);
+            const double kaiserXt = fabs(xt) < 1.0 ? I0(beta * std::sqrt(1.0 - xt * xt)) / I0beta : 0.0;
 
-    for (int i = 0; i < bLength; i++)
-    {
-        out += *a++ * *b++;
+            const double wt = wc * x / cyclesPerSampleD;
+            const double sincWt = fabs(wt) >= 1e-8 ? sin(wt) / wt : 1.0;
+
+            (*firTable)[i][j] = static_cast<short>(scale * sincWt * kaiserXt);
+        }
     }
 
-    return (out + (1 << 14)) >> 15;
+    return firTable;
 }
 
 template<typename I, typename O>
@@ -134,7 +151,7 @@ int SincResampler::fir(int subcycle)
     // Find firN most recent samples, plus one extra in case the FIR wraps.
     int sampleStart = sampleIndex - firN + RINGSIZE - 1;
 
-    const int v1 = convolve(sample.data() + sampleStart, (*firTable)[firTableFirst], firN);
+    const int v1 = scaleConvolution(convolve(sample.data() + sampleStart, (*firTable)[firTableFirst], firN));
 
     // Use next FIR table, wrap around to first FIR table using
     // previous sample.
@@ -144,14 +161,16 @@ int SincResampler::fir(int subcycle)
         ++sampleStart;
     }
 
-    const int v2 = convolve(sample.data() + sampleStart, (*firTable)[firTableFirst], firN);
+    const int v2 = scaleConvolution(convolve(sample.data() + sampleStart, (*firTable)[firTableFirst], firN));
 
     // Linear interpolation between the sinc tables yields good
     // approximation for the exact value.
     return v1 + (firTableOffset * (v2 - v1) >> 10);
 }
 
-SincResampler::SincResampler(double clockFrequency, double samplingFrequency, double highestAccurateFrequency) :
+SincResampler::SincResampler(double clockFrequency, double samplingFrequency, double highestAccurateFrequency,
+                             convolve_t kernel) :
+    convolve(kernel != nullptr ? kernel : getConvolveKernel().convolve),
     cyclesPerSample(static_cast<int>(clockFrequency / samplingFrequency * 1024.0))
 {
     // 16 bits -> -96dB stopband attenuation.
@@ -164,7 +183,6 @@ SincResampler::SincResampler(double clockFrequency, double samplingFrequency, do
     // function in the MATLAB Signal Processing Toolbox:
     // http://www.mathworks.com/help/signal/ref/kaiserord.html
     const double beta = 0.1102 * (A - 8.7);
-    const double I0beta = I0(beta);
     const double cyclesPerSampleD = clockFrequency / samplingFrequency;
 
     {
@@ -192,47 +210,38 @@ SincResampler::SincResampler(double clockFrequency, double samplingFrequency, do
         // The filter test program indicates that the filter performs well, though.
     }
 
-    // Create the map key
-    std::ostringstream o;
-    o << firN << ',' << firRES << ',' << cyclesPerSampleD;
-    const std::string firKey = o.str();
-    auto lb = FIR_CACHE.lower_bound(firKey);
-
     // The FIR computation is expensive and we set sampling parameters often, but
     // from a very small set of choices. Thus, caching is used to speed initialization.
-    if (lb != FIR_CACHE.end() && !(FIR_CACHE.key_comp()(firKey, lb->first)))
-    {
-        firTable = &lb->second;
-    }
-    else
-    {
-        // Allocate memory for FIR tables.
-        matrix_t tempTable(firRES, firN);
-        firTable = &(FIR_CACHE.insert(lb, fir_cache_t::value_type(firKey, tempTable))->second);
-
-        // The cutoff frequency is midway through the transition band, in effect the same as nyquist.
-        const double wc = M_PI;
-
-        // Calculate the sinc tables.
-        const double scale = 32768.0 * wc / cyclesPerSampleD / M_PI;
+    const fir_key_t firKey(firN, firRES, clockFrequency, samplingFrequency);
 
-        for (int i = 0; i < firRES; i++)
+    {
+        std::lock_guard<std::mutex> lock(FIR_CACHE_LOCK);
+        const auto it = FIR_CACHE.find(firKey);
+        if (it != FIR_CACHE.end())
         {
-            const double jPhase = static_cast<double>(i) / firRES + firN / 2;
-
-            for (int j = 0; j < firN; j++)
-            {
-                const double x = j - jPhase;
+            firTable = it->second;
+            return;
+        }
+    }
 
-                const double xt = x / (firN / 2);
-                const double kaiserXt = fabs(xt) < 1.0 ? I0(beta * std::sqrt(1.0 - xt * xt)) / I0beta : 0.0;
+    // Build the table outside the lock so that other sampling
+    // rates can be set up concurrently.
+    std::shared_ptr<const matrix_t> table = buildFirTable(firN, firRES, cyclesPerSampleD, beta);
 
-                const double wt = wc * x / cyclesPerSampleD;
-                const double sincWt = fabs(wt) >= 1e-8 ? sin(wt) / wt : 1.0;
+    std::lock_guard<std::mutex> lock(FIR_CACHE_LOCK);
+    // If another thread got here first use its table.
+    firTable = FIR_CACHE.emplace(firKey, std::move(table)).first->second;
+}
 
-                (*firTable)[i][j] = static_cast<short>(scale * sincWt * kaiserXt);
-            }
-        }
+void SincResampler::releaseUnusedTables()
+{
+    std::lock_guard<std::mutex> lock(FIR_CACHE_LOCK);
+    for (auto it = FIR_CACHE.begin(); it != FIR_CACHE.end();)
+    {
+        if (it->second.use_count() == 1)
+            it = FIR_CACHE.erase(it);
+        else
+            ++it;
     }
 }
 
@@ -268,4 +277,20 @@ void SincResampler::reset()
     sampleOffset = 0;
 }
 
+void SincResampler::serialize(Snapshot& s)
+{
+    s(sampleIndex);
+    s(sampleOffset);
+    s(outputValue);
+
+    // The second half of the ring buffer mirrors the first one
+    s.io(sample.data(), RINGSIZE * sizeof(short));
+
+    if (s.loading())
+    {
+        s.check(sampleIndex >= 0 && sampleIndex < RINGSIZE && sampleOffset < cyclesPerSample);
+        std::copy(sample.begin(), sample.begin() + RINGSIZE, sample.begin() + RINGSIZE);
+    }
+}
+
 } // namespace reSIDfp
@@ -24,6 +24,9 @@
 #define SINCRESAMPLER_H
 
 #include <array>
+#include <memory>
+
+#include "resample/Convolve.h"
 #include "resample/Resampler.h"
 
 #include "../array.h"
@@ -44,7 +47,7 @@ namespace reSIDfp
  * By building shifted FIR tables with samples according to the sampling frequency,
  * this implementation dramatically reduces the computational effort in the
  * filter convolutions, without any loss of accuracy.
- * The filter convolutions are also vectorizable on current hardware.
+ * The filter convolutions are vectorized, the SIMD kernel is selected at runtime.
  */
 class SincResampler final : public Resampler
 {
@@ -65,11 +68,22 @@ public:
      * E.g. for a 44.1kHz sampling rate the end of passband frequency is limited
      * to slightly below 20kHz. This constraint ensures that the FIR table is not overfilled.
      *
+     * FIR tables are cached process-wide and shared between instances,
+     * construction is thread safe.
+     *
      * @param clockFrequency System clock frequency at Hz
      * @param samplingFrequency Desired output sampling rate
      * @param highestAccurateFrequency
+     * @param kernel the convolution kernel, nullptr selects the fastest one for the running CPU
      */
-    SincResampler(double clockFrequency, double samplingFrequency, double highestAccurateFrequency);
+    SincResampler(double clockFrequency, double samplingFrequency, double highestAccurateFrequency,
+                  convolve_t kernel = nullptr);
+
+    /**
+     * Drop the cached FIR tables no resampler is using,
+     * including the prewarmed ones.
+     */
+    static void releaseUnusedTables();
 
     bool input(int input) override;
 
@@ -77,14 +91,19 @@ public:
 
     void reset() override;
 
+    void serialize(Snapshot& s) override;
+
 private:
     int fir(int subcycle);
 
     /// Size of the ring buffer, must be a power of 2
     static constexpr int RINGSIZE = 2048;
 
-    /// Table of the fir filter coefficients
-    matrix_t* firTable;
+    /// Convolution kernel
+    const convolve_t convolve;
+
+    /// Table of the fir filter coefficients, shared with other resamplers
+    std::shared_ptr<const matrix_t> firTable;
 
     int sampleIndex = 0;
 
@@ -100,7 +119,7 @@ private:
 
     int outputValue = 0;
 
-    std::array<short, RINGSIZE * 2> sample;
+    std::array<short, RINGSIZE * 2> sample {};
 };
 
 } // namespace reSIDfp
@@ -39,14 +39,15 @@ class TwoPassSincResampler final : public Resampler
 {
 public:
     // Named constructor
-    static std::unique_ptr<TwoPassSincResampler> create(double clockFrequency, double samplingFrequency, double highestAccurateFrequency)
+    static std::unique_ptr<TwoPassSincResampler> create(double clockFrequency, double samplingFrequency, double highestAccurateFrequency,
+                                                        convolve_t kernel = nullptr)
     {
         // Calculation according to Laurent Ganier. It evaluates to about 120 kHz at typical settings.
         // Some testing around the chosen value seems to confirm that this does work.
         double const intermediateFrequency = 2. * highestAccurateFrequency
             + sqrt(2. * highestAccurateFrequency * clockFrequency
                 * (samplingFrequency - 2. * highestAccurateFrequency) / samplingFrequency);
-        return std::unique_ptr<TwoPassSincResampler>{new TwoPassSincResampler(clockFrequency, samplingFrequency, highestAccurateFrequency, intermediateFrequency)};
+        return std::unique_ptr<TwoPassSincResampler>{new TwoPassSincResampler(clockFrequency, samplingFrequency, highestAccurateFrequency, intermediateFrequency, kernel)};
     }
 
     bool input(int sample) override
@@ -65,10 +66,17 @@ public:
         s2->reset();
     }
 
+    void serialize(Snapshot& s) override
+    {
+        s1->serialize(s);
+        s2->serialize(s);
+    }
+
 private:
-    explicit TwoPassSincResampler(double clockFrequency, double samplingFrequency, double highestAccurateFrequency, double intermediateFrequency) :
-        s1(std::make_unique<SincResampler>(clockFrequency, intermediateFrequency, highestAccurateFrequency)),
-        s2(std::make_unique<SincResampler>(intermediateFrequency, samplingFrequency, highestAccurateFrequency))
+    explicit TwoPassSincResampler(double clockFrequency, double samplingFrequency, double highestAccurateFrequency, double intermediateFrequency,
+                                  convolve_t kernel) :
+        s1(std::make_unique<SincResampler>(clockFrequency, intermediateFrequency, highestAccurateFrequency, kernel)),
+        s2(std::make_unique<SincResampler>(intermediateFrequency, samplingFrequency, highestAccurateFrequency, kernel))
     {}
 
     std::unique_ptr<SincResampler> const s1;
@@ -65,6 +65,13 @@ public:
         cachedSample = 0;
     }
 
+    void serialize(Snapshot& s) override
+    {
+        s(cachedSample);
+        s(sampleOffset);
+        s(outputValue);
+    }
+
 private:
     /// Last sample
     int cachedSample = 0;
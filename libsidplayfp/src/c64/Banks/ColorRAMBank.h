@@ -26,6 +26,7 @@
 #include <cstdint>
 
 #include "Banks/Bank.h"
+#include "Snapshot.h"
 
 namespace libsidplayfp
 {
@@ -45,6 +46,11 @@ public:
         ram.fill(0);
     }
 
+    void serialize(Snapshot& s)
+    {
+        s(ram);
+    }
+
     void poke(uint_least16_t address, uint8_t value) override
     {
         ram[address & 0x3ff] = value & 0xf;
@@ -30,6 +30,7 @@
 
 #include "Banks/Bank.h"
 #include "c64/CPU/opcodes.h"
+#include "Snapshot.h"
 
 namespace libsidplayfp
 {
@@ -136,6 +137,14 @@ public:
         setVal(0xfffd, resetVectorHi);
     }
 
+    /**
+     * Save or restore the RESET vector, the only patched location.
+     */
+    void serialize(Snapshot& s)
+    {
+        s.io(getPtr(0xfffc), 2);
+    }
+
     /**
      * Change the RESET vector.
      *
@@ -178,6 +187,15 @@ public:
         std::memcpy(getPtr(0xbf53), subTune.data(), sizeof(subTune));
     }
 
+    /**
+     * Save or restore the patched locations.
+     */
+    void serialize(Snapshot& s)
+    {
+        s.io(getPtr(0xa7ae), sizeof(trap));
+        s.io(getPtr(0xbf53), sizeof(subTune));
+    }
+
     /**
      * Set BASIC Warm Start address.
      *
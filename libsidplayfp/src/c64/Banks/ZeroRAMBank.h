@@ -28,6 +28,7 @@
 #include "Banks/Bank.h"
 #include "Banks/SystemRAMBank.h"
 #include "Event.h"
+#include "Snapshot.h"
 
 namespace libsidplayfp
 {
@@ -88,6 +89,13 @@ public:
         isFallingOff = true;
     }
 
+    void serialize(Snapshot& s)
+    {
+        s(dataSetClk);
+        s(isFallingOff);
+        s(dataSet);
+    }
+
 private:
     /**
      * $01 bits 6 and 7 fall-off cycles (1->0), average is about 350 msec for a 6510
@@ -158,6 +166,20 @@ public:
         updateCpuPort();
     }
 
+    /**
+     * Save or restore the processor port state.
+     * The memory mapping is restored by the MMU.
+     */
+    void serialize(Snapshot& s)
+    {
+        dataBit6.serialize(s);
+        dataBit7.serialize(s);
+        s(dir);
+        s(data);
+        s(dataRead);
+        s(procPortPins);
+    }
+
     uint8_t peek(uint_least16_t address) override
     {
         switch (address)
@@ -24,6 +24,7 @@
 #include "c64/CIA/SerialPort.h"
 
 #include "c64/CIA/mos6526.h"
+#include "Snapshot.h"
 
 namespace libsidplayfp
 {
@@ -35,6 +36,15 @@ void SerialPort::reset()
     buffered = false;
 }
 
+void SerialPort::serialize(Snapshot& s)
+{
+    s(count);
+    s(buffered);
+    s(out);
+
+    eventScheduler.serialize(s, *this);
+}
+
 void SerialPort::event()
 {
     parent.spInterrupt();
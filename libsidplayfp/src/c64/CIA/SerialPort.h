@@ -31,6 +31,7 @@ namespace libsidplayfp
 {
 
 class MOS6526;
+class Snapshot;
 
 class SerialPort : private Event
 {
@@ -43,6 +44,8 @@ public:
 
     void reset();
 
+    void serialize(Snapshot& s);
+
     void setBuffered() { buffered = true; }
 
     void handle(uint8_t serialDataReg);
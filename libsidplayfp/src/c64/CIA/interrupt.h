@@ -25,6 +25,7 @@
 
 #include "Event.h"
 #include "EventScheduler.h"
+#include "Snapshot.h"
 
 #include <cstdint>
 
@@ -82,6 +83,16 @@ public:
         eventScheduler.cancel(*this);
     }
 
+    /**
+     * Save or restore the interrupt state.
+     */
+    virtual void serialize(Snapshot& s)
+    {
+        s(icr);
+        s(idr);
+        eventScheduler.serialize(s, *this);
+    }
+
     /**
      * Set interrupt control mask bits.
      *
@@ -26,6 +26,7 @@
 #include <memory>
 
 #include "sidendian.h"
+#include "Snapshot.h"
 
 namespace libsidplayfp
 {
@@ -165,6 +166,15 @@ void InterruptSource6526::reset()
     scheduled = false;
 }
 
+void InterruptSource6526::serialize(Snapshot& s)
+{
+    InterruptSource::serialize(s);
+
+    s(last_clear);
+    s(scheduled);
+    s(tbBug);
+}
+
 const char *MOS6526::credits()
 {
     return
@@ -218,6 +228,19 @@ void MOS6526::reset()
     eventScheduler.cancel(bTickEvent);
 }
 
+void MOS6526::serialize(Snapshot& s)
+{
+    s(regs);
+
+    serialPort.serialize(s);
+    timerA.serialize(s);
+    timerB.serialize(s);
+    interruptSource->serialize(s);
+    tod.serialize(s);
+
+    eventScheduler.serialize(s, bTickEvent);
+}
+
 uint8_t MOS6526::read(uint_least8_t addr)
 {
     addr &= 0x0f;
@@ -144,6 +144,8 @@ public:
 
     void reset() override;
 
+    void serialize(Snapshot& s) override;
+
 private:
     /**
      * Schedules an IRQ asserting state transition for next cycle.
@@ -195,6 +197,11 @@ public:
      */
     virtual void reset();
 
+    /**
+     * Save or restore the CIA state.
+     */
+    virtual void serialize(Snapshot& s);
+
     /**
      * Get the credits.
      *
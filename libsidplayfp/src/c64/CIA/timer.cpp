@@ -23,6 +23,7 @@
 #include "c64/CIA/timer.h"
 
 #include "sidendian.h"
+#include "Snapshot.h"
 
 namespace libsidplayfp
 {
@@ -139,6 +140,19 @@ void Timer::reset()
     eventScheduler.schedule(*this, 1, EventPhase::ClockPHI1);
 }
 
+void Timer::serialize(Snapshot& s)
+{
+    s(state);
+    s(ciaEventPauseTime);
+    s(pbToggle);
+    s(timer);
+    s(latch);
+    s(lastControlValue);
+
+    eventScheduler.serialize(s, *this);
+    eventScheduler.serialize(s, m_cycleSkippingEvent);
+}
+
 void Timer::latchLo(uint8_t data)
 {
     endian_16lo8(latch, data);
@@ -33,6 +33,7 @@ namespace libsidplayfp
 {
 
 class MOS6526;
+class Snapshot;
 
 /**
  * This is the base class for the MOS6526 timers.
@@ -66,6 +67,11 @@ public:
      */
     void reset();
 
+    /**
+     * Save or restore the timer state.
+     */
+    void serialize(Snapshot& s);
+
     /**
      * Set low byte of Timer start value (Latch).
      *
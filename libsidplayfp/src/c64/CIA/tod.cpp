@@ -24,6 +24,7 @@
 #include "c64/CIA/tod.h"
 
 #include "c64/CIA/mos6526.h"
+#include "Snapshot.h"
 
 namespace libsidplayfp
 {
@@ -44,6 +45,19 @@ void Tod::reset()
     eventScheduler.schedule(*this, 0, EventPhase::ClockPHI1);
 }
 
+void Tod::serialize(Snapshot& s)
+{
+    s(cycles);
+    s(todtickcounter);
+    s(isLatched);
+    s(isStopped);
+    s(clock);
+    s(latch);
+    s(alarm);
+
+    eventScheduler.serialize(s, *this);
+}
+
 uint8_t Tod::read(uint_least8_t reg)
 {
     // TOD clock is latched by reading Hours, and released
@@ -33,6 +33,7 @@ namespace libsidplayfp
 {
 
 class MOS6526;
+class Snapshot;
 
 /**
  * TOD implementation taken from Vice.
@@ -53,6 +54,11 @@ public:
      */
     void reset();
 
+    /**
+     * Save or restore the TOD state.
+     */
+    void serialize(Snapshot& s);
+
     /**
      * Read TOD register.
      *
@@ -24,6 +24,7 @@
 
 #include "Event.h"
 #include "sidendian.h"
+#include "Snapshot.h"
 #include "c64/CPU/opcodes.h"
 
 #ifdef DEBUG
@@ -54,11 +55,20 @@ const uint8_t magic =
 
 /**
  * When AEC signal is high, no stealing is possible.
+ *
+ * Cycles are run back to back until another event is due,
+ * the scheduler would hand control back to the CPU anyway.
  */
 void MOS6510::eventWithoutSteals()
 {
-    const ProcessorCycle &instr = instrTable[cycleCount++];
-    (this->*(instr.func)) ();
+    unsigned int cycles = MAX_BATCH_CYCLES;
+    do
+    {
+        const ProcessorCycle &instr = instrTable[cycleCount++];
+        (this->*(instr.func)) ();
+    }
+    while (--cycles != 0 && eventScheduler.advance(1));
+
     eventScheduler.schedule(m_nosteal, 1);
 }
 
@@ -2147,6 +2157,35 @@ void MOS6510::reset()
     Register_ProgramCounter = Cycle_EffectiveAddress;
 }
 
+void MOS6510::serialize(Snapshot& s)
+{
+    s(cycleCount);
+    s(interruptCycle);
+    s(irqAssertedOnPin);
+    s(nmiFlag);
+    s(rstFlag);
+    s(rdy);
+    s(adl_carry);
+    s(d1x1);
+#ifdef CORRECT_SH_INSTRUCTIONS
+    s(rdyOnThrowAwayRead);
+#endif
+    s(flags);
+    s(Register_ProgramCounter);
+    s(Cycle_EffectiveAddress);
+    s(Cycle_Pointer);
+    s(Cycle_Data);
+    s(Register_StackPointer);
+    s(Register_Accumulator);
+    s(Register_X);
+    s(Register_Y);
+
+    s.check(cycleCount >= 0 && cycleCount < static_cast<int>(instrTable.size()));
+
+    eventScheduler.serialize(s, m_nosteal);
+    eventScheduler.serialize(s, m_steal);
+}
+
 /**
  * Module Credits.
  */
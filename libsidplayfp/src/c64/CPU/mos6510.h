@@ -40,6 +40,8 @@ class EventContext;
 namespace libsidplayfp
 {
 
+class Snapshot;
+
 #ifdef DEBUG
 class MOS6510;
 
@@ -87,8 +89,28 @@ public:
 
     void reset();
 
+    /**
+     * Save or restore the CPU state.
+     */
+    void serialize(Snapshot& s);
+
     static const char* credits();
 
+    /// The registers visible to the program, except the program counter
+    struct registers_t
+    {
+        uint8_t a;
+        uint8_t x;
+        uint8_t y;
+        uint8_t sp;
+        uint8_t status;
+    };
+
+    registers_t getRegisters() const
+    {
+        return { Register_Accumulator, Register_X, Register_Y, Register_StackPointer, flags.get() };
+    }
+
     void debug(bool enable, FILE* out);
     void setRDY(bool newRDY);
 
@@ -135,6 +157,9 @@ private:
     /// Stack page location
     static const uint8_t SP_PAGE = 0x01;
 
+    /// Maximum number of cycles run in a single event
+    static const unsigned int MAX_BATCH_CYCLES = 64;
+
     void eventWithoutSteals();
     void eventWithSteals();
 
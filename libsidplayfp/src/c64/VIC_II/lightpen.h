@@ -26,6 +26,8 @@
 
 #include <cstdint>
 
+#include "Snapshot.h"
+
 namespace libsidplayfp
 {
 
@@ -58,6 +60,13 @@ public:
         isTriggered = false;
     }
 
+    void serialize(Snapshot& s)
+    {
+        s(lpx);
+        s(lpy);
+        s(isTriggered);
+    }
+
     /**
      * Return the low byte of x coordinate.
      */
@@ -91,6 +91,31 @@ void MOS656X::reset()
     eventScheduler.schedule(*this, 0, EventPhase::ClockPHI1);
 }
 
+void MOS656X::serialize(Snapshot& s)
+{
+    s(rasterClk);
+    s(lineCycle);
+    s(rasterY);
+    s(yscroll);
+    s(areBadLinesEnabled);
+    s(isBadLine);
+    s(rasterYIRQCondition);
+    s(vblanking);
+    s(lpAsserted);
+    s(irqFlags);
+    s(irqMask);
+    s(regs);
+
+    s.check(lineCycle < cyclesPerLine && rasterY < maxRasters);
+
+    lp.serialize(s);
+    sprites.serialize(s);
+
+    eventScheduler.serialize(s, *this);
+    eventScheduler.serialize(s, badLineStateChangeEvent);
+    eventScheduler.serialize(s, rasterYIRQEdgeDetectorEvent);
+}
+
 void MOS656X::chip(Model model)
 {
     const auto& data = modelData[static_cast<std::size_t>(model)];
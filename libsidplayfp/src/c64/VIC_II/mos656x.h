@@ -59,6 +59,11 @@ public:
      */
     void chip(Model model);
 
+    /**
+     * Get the length of a frame in cycles.
+     */
+    unsigned int getCyclesPerFrame() const { return cyclesPerLine * maxRasters; }
+
     /**
      * Trigger the lightpen. Sets the lightpen usage flag.
      */
@@ -74,6 +79,11 @@ public:
      */
     void reset();
 
+    /**
+     * Save or restore the VIC II state.
+     */
+    void serialize(Snapshot& s);
+
     static const char* credits();
 
 protected:
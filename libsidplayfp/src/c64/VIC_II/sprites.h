@@ -28,6 +28,8 @@
 #include <cstddef>
 #include <cstdint>
 
+#include "Snapshot.h"
+
 namespace libsidplayfp
 {
 
@@ -50,6 +52,14 @@ public:
         mc.fill(0);
     }
 
+    void serialize(Snapshot& s)
+    {
+        s(exp_flop);
+        s(dma);
+        s(mc_base);
+        s(mc);
+    }
+
     /**
      * Update mc values in one pass
      * after the dma has been processed
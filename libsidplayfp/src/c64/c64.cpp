@@ -24,6 +24,8 @@
 
 #include <algorithm>
 #include <array>
+#include "Snapshot.h"
+#include "statehash.h"
 #include "c64/VIC_II/mos656x.h"
 
 namespace libsidplayfp
@@ -128,6 +130,44 @@ void c64::reset()
     oldBAState = true;
 }
 
+void c64::serialize(Snapshot& s)
+{
+    eventScheduler.serialize(s);
+
+    cpu.serialize(s);
+    cia1.serialize(s);
+    cia2.serialize(s);
+    vic.serialize(s);
+    colorRAMBank.serialize(s);
+    mmu.serialize(s);
+
+    s(irqCount);
+    s(oldBAState);
+
+    eventScheduler.commit(s);
+}
+
+uint64_t c64::stateHash(uint64_t hash) const
+{
+    const MOS6510::registers_t regs = cpu.getRegisters();
+    const uint8_t packed[] = { regs.a, regs.x, regs.y, regs.sp, regs.status };
+    hash = hashState(hash, packed, sizeof(packed));
+
+    const uint8_t* ram = mmu.getRam();
+
+    // Zero page without the jiffy clock ($a0-$a2)
+    // and the cursor blink ($cc-$cf)
+    hash = hashState(hash, ram, 0xa0);
+    hash = hashState(hash, ram + 0xa3, 0xcc - 0xa3);
+    hash = hashState(hash, ram + 0xd0, 0x100 - 0xd0);
+
+    // Stack in use
+    const std::size_t top = 0x100 + regs.sp + 1;
+    hash = hashState(hash, ram + top, 0x200 - top);
+
+    return hashState(hash, ram + 0x200, 0x10000 - 0x200);
+}
+
 void c64::setModel(Model model)
 {
     const auto& data = getModelDataFromModel(model);
@@ -50,6 +50,7 @@ namespace libsidplayfp
 
 class c64sid;
 class sidmemory;
+class Snapshot;
 
 #ifdef PC64_TESTSUITE
 class testEnv
@@ -89,6 +90,13 @@ public:
 
     c64();
 
+    /**
+     * Get the CPU clock speed for the given model.
+     *
+     * @return the speed in Hertz
+     */
+    static double getCpuFreq(Model model);
+
     /**
      * Get C64's event scheduler
      *
@@ -115,6 +123,12 @@ public:
     void reset();
     void resetCpu() { cpu.reset(); }
 
+    /**
+     * Save or restore the state of the machine, SIDs excluded.
+     * The model and ROMs are not part of the state.
+     */
+    void serialize(Snapshot& s);
+
     /**
      * Set the c64 model.
      */
@@ -173,9 +187,23 @@ public:
 
     uint_least16_t getCia1TimerA() const { return cia1.getTimerA(); }
 
-private:
-    static double getCpuFreq(Model model);
+    /**
+     * Get the length of a video frame in cycles.
+     */
+    unsigned int getCyclesPerFrame() const { return vic.getCyclesPerFrame(); }
 
+    /**
+     * Hash the state that decides what the CPU does next:
+     * the RAM in use and the registers.
+     * The program counter and the free stack are left out
+     * as they depend on the exact cycle the CPU has reached,
+     * so are the KERNAL jiffy clock and cursor blink.
+     *
+     * @param hash the value to continue from
+     */
+    uint64_t stateHash(uint64_t hash) const;
+
+private:
     /**
      * Access memory as seen by CPU.
      *
@@ -71,6 +71,12 @@ public:
         MOS6526::reset();
     }
 
+    void serialize(Snapshot& s) override
+    {
+        MOS6526::serialize(s);
+        s(last_ta);
+    }
+
     uint_least16_t getTimerA() const { return last_ta; }
 
 protected:
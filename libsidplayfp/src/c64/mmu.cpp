@@ -83,4 +83,19 @@ void MMU::reset()
     updateMappingPHI2();
 }
 
+void MMU::serialize(Snapshot& s)
+{
+    s(ramBank.ram);
+    zeroRAMBank.serialize(s);
+    kernalRomBank.serialize(s);
+    basicRomBank.serialize(s);
+
+    s(loram);
+    s(hiram);
+    s(charen);
+
+    if (s.loading())
+        updateMappingPHI2();
+}
+
 }
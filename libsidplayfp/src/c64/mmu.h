@@ -51,6 +51,11 @@ public:
 
     void reset();
 
+    /**
+     * Save or restore RAM, processor port and ROM patches.
+     */
+    void serialize(Snapshot& s);
+
     void setRoms(const uint8_t* kernal, const uint8_t* basic, const uint8_t* character)
     {
         kernalRomBank.set(kernal);
@@ -74,6 +79,8 @@ public:
         std::memcpy(&ramBank.ram[start], source, size);
     }
 
+    const uint8_t* getRam() const { return ramBank.ram.data(); }
+
     // SID specific hacks
     void installResetHook(uint_least16_t addr) override { kernalRomBank.installResetHook(addr); }
 
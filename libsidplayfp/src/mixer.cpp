@@ -24,9 +24,11 @@
 
 #include <algorithm>
 #include <cassert>
-#include <numeric>
+#include <cstdint>
+#include <type_traits>
 
 #include "sidemu.h"
+#include "Snapshot.h"
 
 namespace libsidplayfp
 {
@@ -46,9 +48,9 @@ class BufferMove
 {
 public:
     explicit BufferMove(int position, int numSamples) : pos(position), samples(numSamples) {}
-    void operator()(short *dest) const
+    void operator()(int *dest) const
     {
-        const short* const src = dest + pos;
+        const int* const src = dest + pos;
         std::copy(src, src + samples, dest);
     }
 
@@ -56,105 +58,413 @@ private:
     int pos;
     int samples;
 };
+
+/**
+ * Conversion of the mixed samples to the output format.
+ */
+template<typename T>
+struct Output;
+
+/**
+ * 16 bit output, the chip samples are clipped before mixing
+ * and the result is dithered.
+ */
+template<>
+struct Output<short>
+{
+    using value_t = int_least32_t;
+
+    static constexpr bool DITHER = true;
+
+    static int chip(int sample) { return std::clamp(sample, -32768, 32767); }
+
+    static short convert(int_least32_t sample, int_least32_t volume, int dither)
+    {
+        const int_least32_t tmp = (sample * volume + dither) / Mixer::VOLUME_MAX;
+        assert(tmp >= -32768 && tmp <= 32767);
+        return static_cast<short>(tmp);
+    }
+};
+
+/**
+ * 32 bit output, only the result is clipped.
+ */
+template<>
+struct Output<int32_t>
+{
+    using value_t = int_least32_t;
+
+    static constexpr bool DITHER = false;
+
+    static int chip(int sample) { return sample; }
+
+    static int32_t convert(int_least32_t sample, int_least32_t volume, int)
+    {
+        const int64_t tmp = static_cast<int64_t>(sample) * volume * (65536 / Mixer::VOLUME_MAX);
+        return static_cast<int32_t>(std::clamp<int64_t>(tmp, INT32_MIN, INT32_MAX));
+    }
+};
+
+/**
+ * Floating point output, nothing is clipped and the mix is done
+ * in floating point so no precision is lost on the way.
+ * The chip samples still come from the integer resamplers,
+ * so they have a 16 bit resolution, only their headroom is extended.
+ */
+template<>
+struct Output<float>
+{
+    using value_t = float;
+
+    static constexpr bool DITHER = false;
+
+    static int chip(int sample) { return sample; }
+
+    static float convert(float sample, int_least32_t volume, int)
+    {
+        return sample * static_cast<float>(volume) * (1.f / (Mixer::VOLUME_MAX * 32768.f));
+    }
+};
+
+constexpr int_least64_t SCALE_FACTOR = 1 << 16;
+
+constexpr double SQRT_0_5 = 0.70710678118654746;
+
+constexpr int_least64_t C1 = static_cast<int_least32_t>(1.0 / (1.0 + SQRT_0_5) * SCALE_FACTOR);
+constexpr int_least64_t C2 = static_cast<int_least32_t>(SQRT_0_5 / (1.0 + SQRT_0_5) * SCALE_FACTOR);
+
+/*
+ * Channel matrix
+ *
+ *   C1
+ * L 1.0
+ * R 1.0
+ *
+ *   C1   C2
+ * L 1.0  0.0
+ * R 0.0  1.0
+ *
+ *   C1       C2           C3
+ * L 1/1.707  0.707/1.707  0.0
+ * R 0.0      0.707/1.707  1/1.707
+ *
+ * FIXME
+ * it seems that scaling down the summed signals is not the correct way of mixing, see:
+ * http://dsp.stackexchange.com/questions/3581/algorithms-to-mix-audio-signals-without-clipping
+ * maybe we should consider some form of soft/hard clipping instead to avoid possible overflows
+ */
+
+constexpr float F1 = static_cast<float>(1.0 / (1.0 + SQRT_0_5));
+constexpr float F2 = static_cast<float>(SQRT_0_5 / (1.0 + SQRT_0_5));
+
+template<unsigned int Chips, typename V>
+V mono(const V* samples)
+{
+    V res = 0;
+    for (unsigned int i = 0; i < Chips; i++)
+        res += samples[i];
+    return res / static_cast<V>(Chips);
+}
+
+template<unsigned int Chips, typename V>
+V left(const V* samples)
+{
+    if constexpr (Chips == 3 && std::is_floating_point_v<V>)
+        return F1 * samples[0] + F2 * samples[1];
+    else if constexpr (Chips == 3)
+        return static_cast<V>((C1 * samples[0] + C2 * samples[1]) / SCALE_FACTOR);
+    else
+        return samples[0];
+}
+
+template<unsigned int Chips, typename V>
+V right(const V* samples)
+{
+    if constexpr (Chips == 3 && std::is_floating_point_v<V>)
+        return F2 * samples[1] + F1 * samples[2];
+    else if constexpr (Chips == 3)
+        return static_cast<V>((C2 * samples[1] + C1 * samples[2]) / SCALE_FACTOR);
+    else
+        return samples[Chips - 1];
+}
+
+/**
+ * Read a chip sample, averaging the fast forwarded ones
+ * with a crude boxcar low-pass filter to reduce aliasing.
+ */
+template<typename T, bool Boxcar>
+typename Output<T>::value_t sample(const int* buffer, int ff)
+{
+    using value_t = typename Output<T>::value_t;
+
+    if constexpr (Boxcar)
+    {
+        int_least32_t sum = 0;
+        for (int j = 0; j < ff; j++)
+            sum += Output<T>::chip(buffer[j]);
+        return static_cast<value_t>(sum) / static_cast<value_t>(ff);
+    }
+    else
+    {
+        return static_cast<value_t>(Output<T>::chip(buffer[0]));
+    }
+}
 } // Anonymous namespace
 
 void Mixer::clockChips()
 {
+    if (m_pool)
+    {
+        m_pool->run(static_cast<unsigned int>(m_chips.size()), [this](unsigned int i) { m_chips[i]->clock(); });
+        return;
+    }
+
     for (sidemu* const chip : m_chips)
     {
         chip->clock();
     }
 }
 
+void Mixer::setThreaded(bool enable)
+{
+    bool threaded = enable && m_chips.size() > 1;
+
+    for (sidemu* const chip : m_chips)
+    {
+        if (threaded && !chip->deferWrites(true))
+            threaded = false;
+    }
+
+    // Queued writes are replayed just as well on this thread,
+    // so leave the queues enabled
+    if (!threaded)
+    {
+        m_pool.reset();
+        return;
+    }
+
+    const unsigned int workers = static_cast<unsigned int>(m_chips.size() - 1);
+    if (!m_pool || m_pool->size() != workers)
+        m_pool.reset(new WorkerPool(workers));
+}
+
+void Mixer::setSilent(bool enable, bool coarse)
+{
+    for (sidemu* const chip : m_chips)
+    {
+        chip->silent(enable);
+        chip->coarse(enable && coarse);
+    }
+}
+
+bool Mixer::serialize(Snapshot& s)
+{
+    // The chips save their buffers from the start
+    if (s.loading())
+        m_readPos = 0;
+    else
+        compact();
+
+    s(m_rand);
+    s(oldRandomValue);
+
+    for (sidemu* const chip : m_chips)
+    {
+        if (!chip->serialize(s))
+            return false;
+    }
+
+    return true;
+}
+
 void Mixer::resetBufs()
 {
+    m_readPos = 0;
     std::for_each(m_chips.begin(), m_chips.end(), BufferPos(0));
 }
 
-void Mixer::doMix()
+void Mixer::powerOn()
+{
+    for (sidemu* const chip : m_chips)
+        chip->powerOn();
+
+    resetBufs();
+
+    m_rand = sidrandom(0);
+    oldRandomValue = 0;
+}
+
+void Mixer::compact()
+{
+    if (m_chips.empty())
+        return;
+
+    const int samplesLeft = m_chips.front()->bufferpos() - m_readPos;
+    std::for_each(m_buffers.begin(), m_buffers.end(), BufferMove(m_readPos, samplesLeft));
+    std::for_each(m_voiceBuffers.begin(), m_voiceBuffers.end(), BufferMove(m_readPos, samplesLeft));
+    std::for_each(m_chips.begin(), m_chips.end(), BufferPos(samplesLeft));
+    m_readPos = 0;
+}
+
+template<typename T, unsigned int Chips, bool Stereo, bool Boxcar>
+void Mixer::mix()
 {
-    short *buf = m_sampleBuffer + m_sampleIndex;
+    constexpr unsigned int channels = Stereo ? 2 : 1;
+
+    T *buf = static_cast<T*>(m_sampleBuffer) + m_sampleIndex;
+    T* const* voices = m_voiceBuffers.empty() ? nullptr : static_cast<T* const*>(m_voiceOutputs);
+
+    const int ff = Boxcar ? m_fastForwardFactor : 1;
 
     // extract buffer info now that the SID is updated.
     // clock() may update bufferpos.
     // NB: if more than one chip exists, their bufferpos is identical to first chip's.
     const int sampleCount = m_chips.front()->bufferpos();
 
-    int i = 0;
-    while (i < sampleCount)
+    // Frames that can be produced, keeping at least one sample
+    // for the next boxcar, and frames left to fill
+    const std::size_t available = sampleCount > m_readPos ? (sampleCount - m_readPos - 1) / ff : 0;
+    const std::size_t wanted = (m_sampleCount - m_sampleIndex + channels - 1) / channels;
+    const std::size_t frames = std::min(available, wanted);
+
+    const int* buffers[Chips];
+    for (unsigned int k = 0; k < Chips; k++)
+        buffers[k] = m_buffers[k] + m_readPos;
+
+    const int_least32_t volumeLeft = m_volume[0];
+    const int_least32_t volumeRight = Stereo ? m_volume[1] : 0;
+
+    // Keep the dithering state in registers
+    sidrandom rng = m_rand;
+    int randomValue = oldRandomValue;
+
+    for (std::size_t f = 0; f < frames; f++)
     {
-        // Handle whatever output the sid has generated so far
-        if (m_sampleIndex >= m_sampleCount)
+        const int i = static_cast<int>(f) * ff;
+
+        typename Output<T>::value_t samples[Chips];
+        for (unsigned int k = 0; k < Chips; k++)
+            samples[k] = sample<T, Boxcar>(buffers[k] + i, ff);
+
+        if (voices != nullptr)
         {
-            break;
+            const std::size_t frame = m_sampleIndex / channels + f;
+            for (std::size_t k = 0; k < m_voiceBuffers.size(); k++)
+            {
+                const auto voice = sample<T, Boxcar>(m_voiceBuffers[k] + m_readPos + i, ff);
+                voices[k][frame] = Output<T>::convert(voice, VOLUME_MAX, 0);
+            }
         }
-        // Are there enough samples to generate the next one?
-        if (i + m_fastForwardFactor >= sampleCount)
+
+        int dither = 0;
+        if constexpr (Output<T>::DITHER)
         {
-            break;
+            // Triangular dithering
+            const int prevValue = randomValue;
+            randomValue = (rng.next() >> 16) & (VOLUME_MAX - 1);
+            dither = randomValue - prevValue;
         }
 
-        // This is a crude boxcar low-pass filter to
-        // reduce aliasing during fast forward.
-        for (size_t k = 0; k < m_buffers.size(); k++)
+        if constexpr (Stereo)
         {
-            const short* const buffer = m_buffers[k] + i;
-            const std::int32_t sample = std::accumulate(buffer, buffer + m_fastForwardFactor, 0);
-
-            m_iSamples[k] = sample / m_fastForwardFactor;
+            *buf++ = Output<T>::convert(left<Chips>(samples), volumeLeft, dither);
+            *buf++ = Output<T>::convert(right<Chips>(samples), volumeRight, dither);
         }
-
-        // increment i to mark we ate some samples, finish the boxcar thing.
-        i += m_fastForwardFactor;
-
-        const int dither = triangularDithering();
-
-        const unsigned int channels = m_stereo ? 2 : 1;
-        for (unsigned int ch = 0; ch < channels; ch++)
+        else
         {
-            const int_least32_t tmp = ((this->*(m_mix[ch]))() * m_volume[ch] + dither) / VOLUME_MAX;
-            assert(tmp >= -32768 && tmp <= 32767);
-            *buf++ = static_cast<short>(tmp);
-            m_sampleIndex++;
+            *buf++ = Output<T>::convert(mono<Chips>(samples), volumeLeft, dither);
         }
     }
 
-    // move the unhandled data to start of buffer, if any.
-    const int samplesLeft = sampleCount - i;
-    std::for_each(m_buffers.begin(), m_buffers.end(), BufferMove(i, samplesLeft));
-    std::for_each(m_chips.begin(), m_chips.end(), BufferPos(samplesLeft));
+    m_rand = rng;
+    oldRandomValue = randomValue;
+
+    m_sampleIndex += frames * channels;
+    m_readPos += static_cast<int>(frames) * ff;
+
+    // move the unhandled data to start of buffer
+    // only when the next slice may not fit.
+    if (sampleCount > sidemu::BUFFERSIZE - sidemu::OUTPUTBUFFERSIZE)
+        compact();
 }
 
-void Mixer::begin(short *buffer, std::size_t count)
+template<typename T, unsigned int Chips>
+Mixer::mix_func_t Mixer::mixFunction() const
+{
+    if (m_stereo)
+        return m_fastForwardFactor > 1 ? &Mixer::mix<T, Chips, true, true> : &Mixer::mix<T, Chips, true, false>;
+    else
+        return m_fastForwardFactor > 1 ? &Mixer::mix<T, Chips, false, true> : &Mixer::mix<T, Chips, false, false>;
+}
+
+template<typename T>
+Mixer::mix_func_t Mixer::mixFunction() const
+{
+    switch (m_chips.size())
+    {
+    case 3:
+        return mixFunction<T, 3>();
+    case 2:
+        return mixFunction<T, 2>();
+    default:
+        return mixFunction<T, 1>();
+    }
+}
+
+template<typename T>
+void Mixer::begin(T *buffer, std::size_t count, T* const* voices)
 {
     m_sampleIndex  = 0;
     m_sampleCount  = count;
     m_sampleBuffer = buffer;
+    m_voiceOutputs = voices;
+    m_doMix        = mixFunction<T>();
+}
+
+void Mixer::begin(short *buffer, std::size_t count, short* const* voices)
+{
+    begin<short>(buffer, count, voices);
+}
+
+void Mixer::begin(int32_t *buffer, std::size_t count, int32_t* const* voices)
+{
+    begin<int32_t>(buffer, count, voices);
 }
 
-void Mixer::updateParams()
+void Mixer::begin(float *buffer, std::size_t count, float* const* voices)
 {
-    switch (m_buffers.size())
+    begin<float>(buffer, count, voices);
+}
+
+bool Mixer::setVoiceOutputs(bool enable)
+{
+    m_voiceBuffers.clear();
+
+    for (sidemu* const chip : m_chips)
     {
-    case 1:
-        m_mix[0] = m_stereo ? &Mixer::stereo_OneChip : &Mixer::mono<1>;
-        if (m_stereo) m_mix[1] = &Mixer::stereo_OneChip;
-        break;
-    case 2:
-        m_mix[0] = m_stereo ? &Mixer::stereo_ch1_TwoChips : &Mixer::mono<2>;
-        if (m_stereo) m_mix[1] = &Mixer::stereo_ch2_TwoChips;
-        break;
-    case 3:
-        m_mix[0] = m_stereo ? &Mixer::stereo_ch1_ThreeChips : &Mixer::mono<3>;
-        if (m_stereo) m_mix[1] = &Mixer::stereo_ch2_ThreeChips;
-        break;
-     }
+        if (!chip->voiceOutputs(enable))
+        {
+            setVoiceOutputs(false);
+            return false;
+        }
+
+        if (enable)
+        {
+            for (unsigned int i = 0; i < 3; i++)
+                m_voiceBuffers.push_back(chip->voiceBuffer(i));
+        }
+    }
+
+    return true;
 }
 
 void Mixer::clearSids()
 {
+    setThreaded(false);
     m_chips.clear();
     m_buffers.clear();
+    m_voiceBuffers.clear();
+    m_readPos = 0;
 }
 
 void Mixer::addSid(sidemu *chip)
@@ -166,26 +476,11 @@ void Mixer::addSid(sidemu *chip)
 
     m_chips.push_back(chip);
     m_buffers.push_back(chip->buffer());
-    m_iSamples.resize(m_buffers.size());
-
-    if (m_mix.empty())
-    {
-        return;
-    }
-
-    updateParams();
 }
 
 void Mixer::setStereo(bool stereo)
 {
-    if (m_stereo == stereo)
-    {
-        return;
-    }
-
     m_stereo = stereo;
-    m_mix.resize(m_stereo ? 2 : 1);
-    updateParams();
 }
 
 bool Mixer::setFastForward(int ff)
@@ -26,13 +26,17 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <cstdlib>
+#include <memory>
 #include <vector>
 
+#include "WorkerPool.h"
+#include "sidrandom.h"
+
 namespace libsidplayfp
 {
 
 class sidemu;
+class Snapshot;
 
 /**
  * This class implements the mixer.
@@ -46,45 +50,90 @@ public:
     /// Maximum allowed volume, must be a power of 2.
     static constexpr int_least32_t VOLUME_MAX = 1024;
 
-    static constexpr int_least32_t SCALE_FACTOR = 1 << 16;
-
-    static constexpr double SQRT_0_5 = 0.70710678118654746;
-
-    static constexpr int_least32_t C1 = static_cast<int_least32_t>(1.0 / (1.0 + SQRT_0_5) * SCALE_FACTOR);
-    static constexpr int_least32_t C2 = static_cast<int_least32_t>(SQRT_0_5 / (1.0 + SQRT_0_5) * SCALE_FACTOR);
-
-
 public:
-    /**
-     * Create a new mixer.
-     */
-    Mixer()
-    {
-        m_mix.push_back(&Mixer::mono<1>);
-    }
-
     /**
      * Do the mixing.
      */
-    void doMix();
+    void doMix() { (this->*m_doMix)(); }
 
     /**
      * This clocks the SID chips to the present moment, if they aren't already.
      */
     void clockChips();
 
+    /**
+     * Clock the chips in parallel, one thread per chip.
+     * Register writes are queued during the CPU slice and
+     * replayed by each chip on its own thread.
+     * Ignored if any chip doesn't support deferred writes
+     * or there is only one chip.
+     *
+     * @param enable true to enable multi-threaded clocking
+     */
+    void setThreaded(bool enable);
+
+    /**
+     * Make the chips skip audio production, used when seeking.
+     *
+     * @param enable true to clock the chips silently
+     * @param coarse true to keep only what is needed to follow the tune,
+     *               the audio can't be resumed properly afterwards
+     */
+    void setSilent(bool enable, bool coarse = false);
+
     /**
      * Reset sidemu buffer position discarding produced samples.
      */
     void resetBufs();
 
+    /**
+     * Bring the chips back to their power on state,
+     * see sidemu#powerOn, and restart the dithering.
+     */
+    void powerOn();
+
     /**
      * Prepare for mixing cycle.
+     * 16 bit samples are dithered.
+     *
+     * @param buffer output buffer
+     * @param count size of the buffer in samples
+     * @param voices optional voice output buffers, see #setVoiceOutputs
+     */
+    void begin(short* buffer, std::size_t count, short* const* voices = nullptr);
+
+    /**
+     * Prepare for mixing cycle with 32 bit samples,
+     * full scale of the 16 bit output is full scale here too.
      *
      * @param buffer output buffer
      * @param count size of the buffer in samples
+     * @param voices optional voice output buffers, see #setVoiceOutputs
      */
-    void begin(short* buffer, std::size_t count);
+    void begin(int32_t* buffer, std::size_t count, int32_t* const* voices = nullptr);
+
+    /**
+     * Prepare for mixing cycle with floating point samples,
+     * full scale of the 16 bit output is mapped to [-1.0,1.0]
+     * and louder samples are not clipped.
+     * The chips are mixed in floating point.
+     *
+     * @param buffer output buffer
+     * @param count size of the buffer in samples
+     * @param voices optional voice output buffers, see #setVoiceOutputs
+     */
+    void begin(float* buffer, std::size_t count, float* const* voices = nullptr);
+
+    /**
+     * Make the chips produce the output of each voice.
+     * When enabled and voice buffers are passed to #begin,
+     * three buffers per chip in chip order, each one receives
+     * a mono sample per output frame, without volume or dithering.
+     *
+     * @param enable true to produce the voice outputs
+     * @return false if a chip doesn't support it, the outputs are then disabled
+     */
+    bool setVoiceOutputs(bool enable);
 
     /**
      * Remove all SIDs from the mixer.
@@ -107,7 +156,12 @@ public:
     sidemu* getSid(std::size_t i) const { return (i < m_chips.size()) ? m_chips[i] : nullptr; }
 
     /**
-     * Set the fast forward ratio.
+     * Get the number of SIDs in the mixer.
+     */
+    std::size_t sids() const { return m_chips.size(); }
+
+    /**
+     * Set the fast forward ratio, used from the next #begin.
      *
      * @param ff the fast forward ratio, from 1 to 32
      * @return true if parameter is valid, false otherwise
@@ -123,12 +177,20 @@ public:
     void setVolume(int_least32_t left, int_least32_t right);
 
     /**
-     * Set mixing mode.
+     * Set mixing mode, used from the next #begin.
      *
      * @param stereo true for stereo mode, false for mono
      */
     void setStereo(bool stereo);
 
+    /**
+     * Save or restore the dithering state and the chips.
+     *
+     * @param s the snapshot
+     * @return false if a chip doesn't support snapshots
+     */
+    bool serialize(Snapshot& s);
+
     /**
      * Check if the buffer have been filled.
      */
@@ -140,70 +202,59 @@ public:
     std::size_t samplesGenerated() const { return m_sampleIndex; }
 
 private:
-    using mixer_func_t = int_least32_t (Mixer::*)() const;
+    using mix_func_t = void (Mixer::*)();
 
-    void updateParams();
-
-    int triangularDithering()
-    {
-        const int prevValue = oldRandomValue;
-        oldRandomValue = rand() & (VOLUME_MAX - 1);
-        return oldRandomValue - prevValue;
-    }
-
-    /*
-     * Channel matrix
-     *
-     *   C1
-     * L 1.0
-     * R 1.0
-     *
-     *   C1   C2
-     * L 1.0  0.0
-     * R 0.0  1.0
-     *
-     *   C1       C2           C3
-     * L 1/1.707  0.707/1.707  0.0
-     * R 0.0      0.707/1.707  1/1.707
+    /**
+     * Mix the chip samples into the output buffer.
      *
-     * FIXME
-     * it seems that scaling down the summed signals is not the correct way of mixing, see:
-     * http://dsp.stackexchange.com/questions/3581/algorithms-to-mix-audio-signals-without-clipping
-     * maybe we should consider some form of soft/hard clipping instead to avoid possible overflows
+     * @tparam T the output sample type
+     * @tparam Chips the number of chips
+     * @tparam Stereo true for stereo output
+     * @tparam Boxcar true when fast forwarding
      */
+    template<typename T, unsigned int Chips, bool Stereo, bool Boxcar>
+    void mix();
 
-     // Mono mixing
-    template <int Chips>
-    int_least32_t mono() const
-    {
-        int_least32_t res = 0;
-        for (int i = 0; i < Chips; i++)
-            res += m_iSamples[i];
-        return res / Chips;
-    }
+    /**
+     * Get the mixing function for the current settings.
+     */
+    template<typename T>
+    mix_func_t mixFunction() const;
 
-    // Stereo mixing
-    int_least32_t stereo_OneChip() const { return m_iSamples[0]; }
+    template<typename T, unsigned int Chips>
+    mix_func_t mixFunction() const;
 
-    int_least32_t stereo_ch1_TwoChips() const { return m_iSamples[0]; }
-    int_least32_t stereo_ch2_TwoChips() const { return m_iSamples[1]; }
+    template<typename T>
+    void begin(T* buffer, std::size_t count, T* const* voices);
 
-    int_least32_t stereo_ch1_ThreeChips() const { return (C1 * m_iSamples[0] + C2 * m_iSamples[1]) / SCALE_FACTOR; }
-    int_least32_t stereo_ch2_ThreeChips() const { return (C2 * m_iSamples[1] + C1 * m_iSamples[2]) / SCALE_FACTOR; }
+    /**
+     * Move the unmixed samples back to the start of the buffers.
+     */
+    void compact();
 
     std::vector<sidemu*> m_chips;
-    std::vector<short*> m_buffers;
+    std::vector<int*> m_buffers;
+
+    /// Voice output buffers of all the chips, empty unless enabled
+    std::vector<int*> m_voiceBuffers;
 
-    std::vector<int_least32_t> m_iSamples;
     std::vector<int_least32_t> m_volume;
 
-    std::vector<mixer_func_t> m_mix;
+    std::unique_ptr<WorkerPool> m_pool;
+
+    // Own generator so that the dithering can be saved and restored
+    sidrandom m_rand{0};
 
     int oldRandomValue = 0;
     int m_fastForwardFactor = 1;
 
+    /// Position of the first unmixed sample in the chip buffers
+    int m_readPos = 0;
+
     // Mixer settings
-    short      *m_sampleBuffer = nullptr;
+    mix_func_t  m_doMix = nullptr;
+    void       *m_sampleBuffer = nullptr;
+    const void *m_voiceOutputs = nullptr;
     std::size_t m_sampleCount = 0;
     std::size_t m_sampleIndex = 0;
 
@@ -22,13 +22,22 @@
 
 #include "player.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_set>
+
 #include <sidplayfp/sidbuilder.h>
+#include <sidplayfp/sidsink.h>
+#include <sidplayfp/SidDatabase.h>
 #include <sidplayfp/SidTune.h>
 #include <sidplayfp/SidTuneInfo.h>
 
 #include "psiddrv.h"
 #include "romCheck.h"
 #include "sidemu.h"
+#include "Snapshot.h"
+#include "statehash.h"
 
 namespace libsidplayfp
 {
@@ -50,6 +59,36 @@ constexpr char ERR_UNSUPPORTED_FREQ[]     = "SIDPLAYER ERROR: Unsupported sampli
 constexpr char ERR_UNSUPPORTED_SID_ADDR[] = "SIDPLAYER ERROR: Unsupported SID address.";
 constexpr char ERR_UNSUPPORTED_SIZE[]     = "SIDPLAYER ERROR: Size of music data exceeds C64 memory.";
 constexpr char ERR_INVALID_PERCENTAGE[]   = "SIDPLAYER ERROR: Percentage value out of range.";
+constexpr char ERR_NO_TUNE[]              = "SIDPLAYER ERROR: No tune to render.";
+constexpr char ERR_NO_TUNE_LOADED[]       = "SIDPLAYER ERROR: No tune loaded.";
+constexpr char ERR_NO_SID_EMULATION[]     = "SIDPLAYER ERROR: No SID emulation available for rendering.";
+constexpr char ERR_ILLEGAL_INSTRUCTION[]  = "Illegal instruction executed";
+constexpr char ERR_UNSUPPORTED_STATE[]    = "SIDPLAYER ERROR: SID emulation does not support saving the state.";
+constexpr char ERR_INVALID_STATE[]        = "SIDPLAYER ERROR: State does not match the loaded tune and configuration.";
+constexpr char ERR_CORRUPT_STATE[]        = "SIDPLAYER ERROR: Corrupt state.";
+constexpr char ERR_UNSUPPORTED_VOICES[]   = "SIDPLAYER ERROR: SID emulation does not support voice outputs.";
+
+/// Volume changes per sample point above which a chip is playing samples
+constexpr unsigned int ESTIMATE_DIGI_CHANGES = 16;
+
+// State header
+constexpr uint32_t STATE_MAGIC   = 0x53505346; // "SPSF"
+constexpr uint32_t STATE_VERSION = 3;
+
+/**
+ * Identifies the tune and the parts of the configuration
+ * a state can be restored into.
+ */
+struct stateHeader_t
+{
+    uint32_t magic;
+    uint32_t version;
+    char md5[SidTune::MD5_LENGTH];
+    uint32_t song;
+    uint32_t sids;
+    uint32_t frequency;
+    double cpuFreq;
+};
 
 /**
  * Configuration error exception.
@@ -217,6 +256,149 @@ bool Player::load(SidTune *tune)
     return true;
 }
 
+bool Player::seek(uint_least32_t ms)
+{
+    if (m_tune == nullptr)
+    {
+        m_errorString = ERR_NO_TUNE_LOADED;
+        return false;
+    }
+
+    // Going back means starting over
+    if (ms < timeMs())
+        rewind();
+
+    if (m_isPlaying == State::Stopped)
+        m_isPlaying = State::Playing;
+
+    const EventScheduler &scheduler = *m_c64.getEventScheduler();
+    const event_clock_t target = static_cast<event_clock_t>(std::ceil(ms * m_c64.getMainCpuSpeed() / 1000.));
+
+    m_mixer.setSilent(true);
+
+    try
+    {
+        while (m_isPlaying == State::Playing && scheduler.getTime(EventPhase::ClockPHI1) < target)
+        {
+            const event_clock_t left = target - scheduler.getTime(EventPhase::ClockPHI1);
+            run(static_cast<unsigned int>(std::min<event_clock_t>(left, sidemu::OUTPUTBUFFERSIZE)));
+
+            if (m_mixer.getSid(0) != nullptr)
+            {
+                m_mixer.clockChips();
+                m_mixer.resetBufs();
+            }
+        }
+    }
+    catch (MOS6510::haltInstruction const &)
+    {
+        m_errorString = ERR_ILLEGAL_INSTRUCTION;
+        m_isPlaying = State::Stopping;
+    }
+
+    m_mixer.setSilent(false);
+
+    if (m_isPlaying == State::Stopping)
+    {
+        rewind();
+        return false;
+    }
+
+    return true;
+}
+
+bool Player::serialize(Snapshot& s)
+{
+    m_c64.serialize(s);
+
+    if (!m_mixer.serialize(s))
+        return false;
+
+    uint8_t playing = m_isPlaying == State::Stopped ? 0 : 1;
+    s(playing);
+    if (s.loading())
+        m_isPlaying = playing != 0 ? State::Playing : State::Stopped;
+
+    s(m_info.m_powerOnDelay);
+    s(m_rand);
+
+    return true;
+}
+
+bool Player::saveState(std::vector<uint8_t>& state)
+{
+    if (m_tune == nullptr)
+    {
+        m_errorString = ERR_NO_TUNE_LOADED;
+        return false;
+    }
+
+    stateHeader_t header{};
+    header.magic = STATE_MAGIC;
+    header.version = STATE_VERSION;
+    std::memcpy(header.md5, m_tune->createMD5New(), SidTune::MD5_LENGTH);
+    header.song = m_tune->getInfo()->currentSong();
+    header.sids = static_cast<uint32_t>(m_mixer.sids());
+    header.frequency = m_cfg.frequency;
+    header.cpuFreq = m_c64.getMainCpuSpeed();
+
+    std::vector<uint8_t> buffer;
+    Snapshot s(buffer);
+    s(header);
+
+    if (!serialize(s))
+    {
+        m_errorString = ERR_UNSUPPORTED_STATE;
+        return false;
+    }
+
+    state.swap(buffer);
+    return true;
+}
+
+bool Player::loadState(const uint8_t* data, std::size_t size)
+{
+    if (m_tune == nullptr)
+    {
+        m_errorString = ERR_NO_TUNE_LOADED;
+        return false;
+    }
+
+    // Check the header before touching the machine
+    stateHeader_t header;
+    Snapshot s(data, size);
+    s(header);
+
+    if (!s.good()
+        || header.magic != STATE_MAGIC
+        || header.version != STATE_VERSION
+        || std::memcmp(header.md5, m_tune->createMD5New(), SidTune::MD5_LENGTH) != 0
+        || header.song != m_tune->getInfo()->currentSong()
+        || header.sids != m_mixer.sids()
+        || header.frequency != m_cfg.frequency
+        || header.cpuFreq != m_c64.getMainCpuSpeed())
+    {
+        m_errorString = ERR_INVALID_STATE;
+        return false;
+    }
+
+    if (!serialize(s))
+    {
+        m_errorString = ERR_UNSUPPORTED_STATE;
+        rewind();
+        return false;
+    }
+
+    if (!s.good() || !s.atEnd())
+    {
+        m_errorString = ERR_CORRUPT_STATE;
+        rewind();
+        return false;
+    }
+
+    return true;
+}
+
 void Player::mute(unsigned int sidNum, unsigned int voice, bool enable)
 {
     sidemu *s = m_mixer.getSid(sidNum);
@@ -227,13 +409,33 @@ void Player::mute(unsigned int sidNum, unsigned int voice, bool enable)
 /**
  * @throws MOS6510::haltInstruction
  */
-void Player::run(unsigned int events)
+void Player::run(unsigned int cycles)
 {
-    for (unsigned int i = 0; m_isPlaying != State::Stopped && i < events; i++)
+    // The CPU runs several cycles per event, so count the elapsed time
+    const EventScheduler &scheduler = *m_c64.getEventScheduler();
+    const event_clock_t end = scheduler.getTime(EventPhase::ClockPHI1) + cycles;
+
+    while (m_isPlaying != State::Stopped && scheduler.getTime(EventPhase::ClockPHI1) < end)
         m_c64.clock();
 }
 
-std::size_t Player::play(short *buffer, std::size_t count)
+std::size_t Player::play(short *buffer, std::size_t count, short* const* voices)
+{
+    return playSamples(buffer, count, voices);
+}
+
+std::size_t Player::play(int32_t *buffer, std::size_t count, int32_t* const* voices)
+{
+    return playSamples(buffer, count, voices);
+}
+
+std::size_t Player::play(float *buffer, std::size_t count, float* const* voices)
+{
+    return playSamples(buffer, count, voices);
+}
+
+template<typename T>
+std::size_t Player::playSamples(T *buffer, std::size_t count, T* const* voices)
 {
     // Make sure a tune is loaded
     if (m_tune == nullptr)
@@ -245,8 +447,6 @@ std::size_t Player::play(short *buffer, std::size_t count)
 
     if (m_isPlaying == State::Playing)
     {
-        m_mixer.begin(buffer, count);
-
         try
         {
             if (m_mixer.getSid(0) != nullptr)
@@ -254,14 +454,7 @@ std::size_t Player::play(short *buffer, std::size_t count)
                 if (count != 0 && buffer != nullptr)
                 {
                     // Clock chips and mix into output buffer
-                    while (m_isPlaying != State::Stopped && m_mixer.notFinished())
-                    {
-                        run(sidemu::OUTPUTBUFFERSIZE);
-
-                        m_mixer.clockChips();
-                        m_mixer.doMix();
-                    }
-                    count = m_mixer.samplesGenerated();
+                    count = mix(buffer, count, voices);
                 }
                 else
                 {
@@ -288,25 +481,296 @@ std::size_t Player::play(short *buffer, std::size_t count)
         }
         catch (MOS6510::haltInstruction const &)
         {
-            m_errorString = "Illegal instruction executed";
+            m_errorString = ERR_ILLEGAL_INSTRUCTION;
             m_isPlaying = State::Stopping;
         }
     }
 
     if (m_isPlaying == State::Stopping)
     {
-        try
+        rewind();
+    }
+
+    return count;
+}
+
+template<typename T>
+std::size_t Player::mix(T *buffer, std::size_t count, T* const* voices)
+{
+    m_mixer.begin(buffer, count, voices);
+
+    while (m_isPlaying != State::Stopped && m_mixer.notFinished())
+    {
+        run(sidemu::OUTPUTBUFFERSIZE);
+
+        m_mixer.clockChips();
+        m_mixer.doMix();
+    }
+
+    return m_mixer.samplesGenerated();
+}
+
+void Player::rewind()
+{
+    try
+    {
+        initialise();
+    }
+    catch (const configError&)
+    {
+    }
+
+    m_isPlaying = State::Stopped;
+}
+
+bool Player::renderBegin(SidTune *tune, unsigned int song)
+{
+    // Don't report the failure of a previous call
+    m_errorString = ERR_NA;
+
+    if (tune == nullptr)
+    {
+        m_errorString = ERR_NO_TUNE;
+        return false;
+    }
+
+    tune->selectSong(song);
+
+    if (!load(tune))
+        return false;
+
+    if (m_mixer.getSid(0) == nullptr)
+    {
+        m_errorString = ERR_NO_SID_EMULATION;
+        return false;
+    }
+
+    m_isPlaying = State::Playing;
+    return true;
+}
+
+std::size_t Player::renderSamples(uint_least32_t lengthMs) const
+{
+    const uint_least64_t frames = static_cast<uint_least64_t>(lengthMs) * m_cfg.frequency / 1000;
+    return static_cast<std::size_t>(frames * m_info.m_channels);
+}
+
+bool Player::render(SidTune *tune, unsigned int song, uint_least32_t lengthMs,
+                    sidsink &sink, std::size_t &rendered, std::size_t blockSize)
+{
+    rendered = 0;
+
+    if (!renderBegin(tune, song))
+        return false;
+
+    const std::size_t samples = renderSamples(lengthMs);
+    if (samples == 0)
+    {
+        rewind();
+        return true;
+    }
+
+    // Keep stereo frames together
+    const std::size_t channels = m_info.m_channels;
+    if (blockSize == 0)
+        blockSize = RENDER_BLOCKSIZE;
+    blockSize = std::max(blockSize - blockSize % channels, channels);
+
+    std::vector<short> buffer(std::min(blockSize, samples));
+    bool success = true;
+
+    try
+    {
+        while (m_isPlaying == State::Playing && rendered < samples)
         {
-            initialise();
+            const std::size_t count = mix(buffer.data(), std::min(buffer.size(), samples - rendered));
+            rendered += count;
+
+            // The sink stopping the render is not an error
+            if (!sink.write(buffer.data(), count))
+                break;
         }
-        catch (const configError&)
+    }
+    catch (MOS6510::haltInstruction const &)
+    {
+        m_errorString = ERR_ILLEGAL_INSTRUCTION;
+        success = false;
+
+        // Deliver the block mixed up to the halt
+        const std::size_t count = m_mixer.samplesGenerated();
+        if (count != 0)
         {
+            rendered += count;
+            sink.write(buffer.data(), count);
         }
+    }
+
+    rewind();
+    return success;
+}
 
-        m_isPlaying = State::Stopped;
+bool Player::render(SidTune *tune, unsigned int song, SidDatabase &database,
+                    sidsink &sink, std::size_t &rendered, std::size_t blockSize)
+{
+    rendered = 0;
+
+    if (tune == nullptr)
+    {
+        m_errorString = ERR_NO_TUNE;
+        return false;
     }
 
-    return count;
+    tune->selectSong(song);
+
+    const std::int32_t lengthMs = database.lengthMs(*tune);
+    if (lengthMs < 0)
+    {
+        m_errorString = database.error();
+        return false;
+    }
+
+    return render(tune, song, static_cast<uint_least32_t>(lengthMs), sink, rendered, blockSize);
+}
+
+bool Player::render(SidTune *tune, unsigned int song, uint_least32_t lengthMs,
+                    short *buffer, std::size_t count, std::size_t &rendered)
+{
+    rendered = 0;
+
+    if (!renderBegin(tune, song))
+        return false;
+
+    const std::size_t samples = renderSamples(lengthMs);
+    if (samples == 0)
+    {
+        rewind();
+        return true;
+    }
+
+    // Keep stereo frames together
+    count -= count % m_info.m_channels;
+
+    bool success = true;
+
+    try
+    {
+        rendered = mix(buffer, std::min(samples, count));
+    }
+    catch (MOS6510::haltInstruction const &)
+    {
+        m_errorString = ERR_ILLEGAL_INSTRUCTION;
+        success = false;
+
+        // Samples mixed up to the halt
+        rendered = m_mixer.samplesGenerated();
+    }
+
+    rewind();
+    return success;
+}
+
+int_least32_t Player::estimateLength(SidTune *tune, unsigned int song,
+                                     uint_least32_t maxLengthMs, uint_least32_t silenceMs)
+{
+    if (!renderBegin(tune, song))
+        return -1;
+
+    const double cpuFreq = m_c64.getMainCpuSpeed();
+    const event_clock_t maxCycles = static_cast<event_clock_t>(maxLengthMs * cpuFreq / 1000.);
+    const event_clock_t silenceCycles = static_cast<event_clock_t>(silenceMs * cpuFreq / 1000.);
+    const bool ciaSpeed = m_tune->getInfo()->compatibility() != SidTuneInfo::Compatibility::R64
+        && m_tune->getInfo()->songSpeed() == SidTuneInfo::SPEED_CIA_1A;
+    const unsigned int frame = m_c64.getCyclesPerFrame();
+
+    for (std::size_t i = 0; sidemu *s = m_mixer.getSid(i); i++)
+        s->clearRegisters();
+
+    // Hashes of the states seen so far
+    std::unordered_set<uint64_t> states;
+
+    const EventScheduler &scheduler = *m_c64.getEventScheduler();
+    event_clock_t now = 0;
+    event_clock_t silentSince = 0;
+    bool heard = false;
+    bool silent = true;
+    event_clock_t end = 0;
+
+    // The chips are reset by rewind() afterwards
+    m_mixer.setSilent(true, true);
+
+    try
+    {
+        while (m_isPlaying == State::Playing && now < maxCycles)
+        {
+            // Sample once per call of the play routine, or a multiple
+            // of it, so that a state repeats at the same point of a frame
+            unsigned int period = frame;
+            if (ciaSpeed && m_c64.getCia1TimerA() != 0)
+            {
+                const unsigned int timer = m_c64.getCia1TimerA() + 1u;
+                period = timer * ((frame / 4 + timer - 1) / timer);
+            }
+
+            const event_clock_t target = now + period;
+            while (m_isPlaying == State::Playing && scheduler.getTime(EventPhase::ClockPHI1) < target)
+            {
+                const event_clock_t left = target - scheduler.getTime(EventPhase::ClockPHI1);
+                run(static_cast<unsigned int>(std::min<event_clock_t>(left, sidemu::OUTPUTBUFFERSIZE)));
+
+                m_mixer.clockChips();
+                m_mixer.resetBufs();
+            }
+            now = scheduler.getTime(EventPhase::ClockPHI1);
+
+            bool audible = false;
+            uint64_t hash = m_c64.stateHash(0);
+            for (std::size_t i = 0; sidemu *s = m_mixer.getSid(i); i++)
+            {
+                // Always read the changes, reading them resets the count
+                const unsigned int changes = s->volumeChanges();
+                if (s->audible() || changes > ESTIMATE_DIGI_CHANGES)
+                    audible = true;
+                hash = hashState(hash, s->registers(), 0x20);
+            }
+
+            if (audible)
+            {
+                heard = true;
+                silent = false;
+            }
+            else if (!silent)
+            {
+                silent = true;
+                silentSince = now;
+            }
+
+            // Silence only ends a tune after something has been heard
+            if (heard && silent && now - silentSince >= silenceCycles)
+            {
+                end = silentSince;
+                break;
+            }
+
+            // Back to a state already seen, the tune starts over from here
+            // unless it went quiet before. Before any sound the machine
+            // may be waiting on timers that are not part of the state.
+            if (heard && !states.insert(hash).second)
+            {
+                end = silent ? silentSince : now;
+                break;
+            }
+        }
+    }
+    catch (MOS6510::haltInstruction const &)
+    {
+        // The tune crashed, it ends here
+        end = scheduler.getTime(EventPhase::ClockPHI1);
+    }
+
+    m_mixer.setSilent(false);
+    rewind();
+
+    return static_cast<int_least32_t>(std::min<double>(end * 1000. / cpuFreq + .5, maxLengthMs));
 }
 
 void Player::stop()
@@ -339,8 +803,6 @@ bool Player::config(const SidConfig &cfg, bool force)
 
         try
         {
-            sidRelease();
-
             std::vector<unsigned int> addresses;
             const uint_least16_t secondSidAddress = tuneInfo->sidChipBase(1) != 0 ?
                 tuneInfo->sidChipBase(1) :
@@ -354,17 +816,42 @@ bool Player::config(const SidConfig &cfg, bool force)
             if (thirdSidAddress != 0)
                 addresses.push_back(thirdSidAddress);
 
-            // SID emulation setup (must be performed before the
-            // environment setup call)
-            sidCreate(cfg.sidEmulation, cfg.defaultSidModel, cfg.digiBoost, cfg.forceSidModel, addresses);
-
             // Determine clock speed
             const c64::Model model = c64model(cfg.defaultC64Model, cfg.forceC64Model);
 
             m_c64.setModel(model);
             m_c64.setCiaModel(cfg.ciaModel == SidConfig::CIAModel::MOS8521);
 
-            sidParams(m_c64.getMainCpuSpeed(), cfg.frequency, cfg.samplingMethod, cfg.fastSampling);
+            const sidSetup_t setup = sidSetup(cfg, addresses, m_c64.getMainCpuSpeed());
+
+            // Switching to a tune that needs the same chips,
+            // they are brought back to the state saved when set up
+            if (m_sidSetup.builder == nullptr || !(setup == m_sidSetup))
+            {
+                m_sidSetup = sidSetup_t();
+
+                sidRelease();
+
+                // SID emulation setup (must be performed before the
+                // environment setup call)
+                sidCreate(setup);
+
+                sidParams(setup.cpuFreq, cfg.frequency, cfg.samplingMethod, cfg.fastSampling);
+
+                m_mixer.setThreaded(cfg.threadedSids);
+
+                if (!m_mixer.setVoiceOutputs(cfg.voiceOutputs))
+                    throw configError(ERR_UNSUPPORTED_VOICES);
+
+                m_mixer.resetBufs();
+                for (std::size_t i = 0; sidemu *s = m_mixer.getSid(i); i++)
+                    s->savePowerOn();
+
+                m_sidSetup = setup;
+            }
+
+            // Leave nothing of the previous tune in the chips and the mixer
+            m_mixer.powerOn();
 
             // Configure, setup and install C64 environment/events
             initialise();
@@ -372,6 +859,7 @@ bool Player::config(const SidConfig &cfg, bool force)
         catch (configError const &e)
         {
             m_errorString = e.message();
+            m_sidSetup = sidSetup_t();
             m_cfg.sidEmulation = nullptr;
             if (&m_cfg != &cfg)
             {
@@ -494,16 +982,46 @@ void Player::sidRelease()
     m_mixer.clearSids();
 }
 
-void Player::sidCreate(sidbuilder *builder, SidConfig::SIDModel defaultModel, bool digiboost,
-                        bool forced, const std::vector<unsigned int> &extraSidAddresses)
+Player::sidSetup_t Player::sidSetup(const SidConfig &cfg, const std::vector<unsigned int> &extraSidAddresses,
+                                   double cpuFreq) const
 {
-    if (builder != nullptr)
+    sidSetup_t setup;
+    setup.builder = cfg.sidEmulation;
+    setup.addresses = extraSidAddresses;
+    setup.digiBoost = cfg.digiBoost;
+    setup.cpuFreq = cpuFreq;
+    setup.frequency = cfg.frequency;
+    setup.samplingMethod = cfg.samplingMethod;
+    setup.fastSampling = cfg.fastSampling;
+    setup.threadedSids = cfg.threadedSids;
+    setup.voiceOutputs = cfg.voiceOutputs;
+
+    if (setup.builder != nullptr)
     {
         const SidTuneInfo* tuneInfo = m_tune->getInfo();
 
+        // Base SID
+        const SidConfig::SIDModel userModel = getSidModel(tuneInfo->sidModel(0), cfg.defaultSidModel, cfg.forceSidModel);
+        setup.models.push_back(userModel);
+
+        // If bits 6-7 are set to Unknown then the extra SIDs will be set
+        // to the same SID model as the first SID.
+        for (std::size_t i = 0; i < extraSidAddresses.size(); i++)
+        {
+            setup.models.push_back(getSidModel(tuneInfo->sidModel(i+1), userModel, cfg.forceSidModel));
+        }
+    }
+
+    return setup;
+}
+
+void Player::sidCreate(const sidSetup_t &setup)
+{
+    sidbuilder *builder = setup.builder;
+    if (builder != nullptr)
+    {
         // Setup base SID
-        const SidConfig::SIDModel userModel = getSidModel(tuneInfo->sidModel(0), defaultModel, forced);
-        sidemu *s = builder->lock(m_c64.getEventScheduler(), userModel, digiboost);
+        sidemu *s = builder->lock(m_c64.getEventScheduler(), setup.models[0], setup.digiBoost);
         if (!builder->getStatus())
         {
             throw configError(builder->error());
@@ -513,29 +1031,18 @@ void Player::sidCreate(sidbuilder *builder, SidConfig::SIDModel defaultModel, bo
         m_mixer.addSid(s);
 
         // Setup extra SIDs if needed
-        if (extraSidAddresses.size() != 0)
+        for (std::size_t i = 0; i < setup.addresses.size(); i++)
         {
-            // If bits 6-7 are set to Unknown then the second SID will be set to the same SID
-            // model as the first SID.
-            defaultModel = userModel;
-
-            const std::size_t extraSidChips = extraSidAddresses.size();
-
-            for (std::size_t i = 0; i < extraSidChips; i++)
+            sidemu *emu = builder->lock(m_c64.getEventScheduler(), setup.models[i+1], setup.digiBoost);
+            if (!builder->getStatus())
             {
-                const SidConfig::SIDModel extraUserModel = getSidModel(tuneInfo->sidModel(i+1), defaultModel, forced);
-
-                sidemu *emu = builder->lock(m_c64.getEventScheduler(), extraUserModel, digiboost);
-                if (!builder->getStatus())
-                {
-                    throw configError(builder->error());
-                }
+                throw configError(builder->error());
+            }
 
-                if (!m_c64.addExtraSid(emu, extraSidAddresses[i]))
-                    throw configError(ERR_UNSUPPORTED_SID_ADDR);
+            if (!m_c64.addExtraSid(emu, setup.addresses[i]))
+                throw configError(ERR_UNSUPPORTED_SID_ADDR);
 
-                m_mixer.addSid(emu);
-            }
+            m_mixer.addSid(emu);
         }
     }
 }
@@ -41,6 +41,8 @@
 #endif
 
 class sidbuilder;
+class sidsink;
+class SidDatabase;
 class SidInfo;
 class SidTune;
 
@@ -49,6 +51,10 @@ namespace libsidplayfp
 
 class Player
 {
+public:
+    /// Default block size for offline rendering, in samples
+    static constexpr std::size_t RENDER_BLOCKSIZE = 1 << 16;
+
 public:
     Player();
     ~Player();
@@ -63,7 +69,29 @@ public:
 
     bool load(SidTune* tune);
 
-    std::size_t play(short* buffer, std::size_t samples);
+    bool seek(uint_least32_t ms);
+
+    bool saveState(std::vector<uint8_t>& state);
+
+    bool loadState(const uint8_t* data, std::size_t size);
+
+    std::size_t play(short* buffer, std::size_t samples, short* const* voices = nullptr);
+
+    std::size_t play(int32_t* buffer, std::size_t samples, int32_t* const* voices = nullptr);
+
+    std::size_t play(float* buffer, std::size_t samples, float* const* voices = nullptr);
+
+    bool render(SidTune* tune, unsigned int song, uint_least32_t lengthMs,
+        sidsink& sink, std::size_t& rendered, std::size_t blockSize);
+
+    bool render(SidTune* tune, unsigned int song, SidDatabase& database,
+        sidsink& sink, std::size_t& rendered, std::size_t blockSize);
+
+    bool render(SidTune* tune, unsigned int song, uint_least32_t lengthMs,
+        short* buffer, std::size_t count, std::size_t& rendered);
+
+    int_least32_t estimateLength(SidTune* tune, unsigned int song,
+        uint_least32_t maxLengthMs, uint_least32_t silenceMs);
 
     bool isPlaying() const { return m_isPlaying != State::Stopped; }
 
@@ -91,6 +119,40 @@ private:
         Stopping,
     };
 
+    /**
+     * What the SID chips in use were set up for.
+     * When a new tune needs the same chips they are kept
+     * and only reset, instead of being released and
+     * configured again.
+     */
+    struct sidSetup_t
+    {
+        sidbuilder* builder = nullptr;
+        std::vector<SidConfig::SIDModel> models;
+        std::vector<unsigned int> addresses;
+        bool digiBoost = false;
+        double cpuFreq = 0.;
+        int frequency = 0;
+        SidConfig::SamplingMethod samplingMethod{};
+        bool fastSampling = false;
+        bool threadedSids = false;
+        bool voiceOutputs = false;
+
+        bool operator==(const sidSetup_t& other) const
+        {
+            return builder == other.builder
+                && models == other.models
+                && addresses == other.addresses
+                && digiBoost == other.digiBoost
+                && cpuFreq == other.cpuFreq
+                && frequency == other.frequency
+                && samplingMethod == other.samplingMethod
+                && fastSampling == other.fastSampling
+                && threadedSids == other.threadedSids
+                && voiceOutputs == other.voiceOutputs;
+        }
+    };
+
     /**
      * Get the C64 model for the current loaded tune.
      *
@@ -116,8 +178,13 @@ private:
      *
      * @throw configError
      */
-    void sidCreate(sidbuilder* builder, SidConfig::SIDModel defaultModel, bool digiboost,
-        bool forced, const std::vector<unsigned int>& extraSidAddresses);
+    void sidCreate(const sidSetup_t& setup);
+
+    /**
+     * Describe the SID chips the configuration and the loaded tune require.
+     */
+    sidSetup_t sidSetup(const SidConfig& cfg, const std::vector<unsigned int>& extraSidAddresses,
+        double cpuFreq) const;
 
     /**
      * Set the SID emulation parameters.
@@ -130,7 +197,52 @@ private:
     void sidParams(double cpuFreq, int frequency,
         SidConfig::SamplingMethod sampling, bool fastSampling);
 
-    void run(unsigned int events);
+    /**
+     * Run the emulation for at least the given amount of cycles
+     * or until the player is stopped.
+     */
+    void run(unsigned int cycles);
+
+    /**
+     * Run the emulation until the buffer is filled
+     * or the player is stopped.
+     *
+     * @return the number of produced samples
+     * @throws MOS6510::haltInstruction
+     */
+    template<typename T>
+    std::size_t mix(T* buffer, std::size_t count, T* const* voices = nullptr);
+
+    /**
+     * Common implementation of the #play variants.
+     */
+    template<typename T>
+    std::size_t playSamples(T* buffer, std::size_t count, T* const* voices);
+
+    /**
+     * Load the tune and select the subtune for offline rendering.
+     *
+     * @return false on error
+     */
+    bool renderBegin(SidTune* tune, unsigned int song);
+
+    /**
+     * Get the number of samples making the given length.
+     */
+    std::size_t renderSamples(uint_least32_t lengthMs) const;
+
+    /**
+     * Save or restore the machine state.
+     *
+     * @return false if a SID emulation doesn't support snapshots
+     */
+    bool serialize(Snapshot& s);
+
+    /**
+     * Bring the emulation back to the initial state
+     * once the player has been stopped.
+     */
+    void rewind();
 
     /// Commodore 64 emulator
     c64 m_c64;
@@ -147,6 +259,9 @@ private:
     /// User Configuration Settings
     SidConfig m_cfg;
 
+    /// Setup of the SID chips in use, builder is nullptr if none
+    sidSetup_t m_sidSetup;
+
     /// Error message
     const char *m_errorString;
 
@@ -22,6 +22,10 @@
 
 #include "sidemu.h"
 
+#include <cstdint>
+
+#include "Snapshot.h"
+
 namespace libsidplayfp
 {
 
@@ -46,4 +50,84 @@ void sidemu::unlock()
     eventScheduler = nullptr;
 }
 
+void sidemu::savePowerOn()
+{
+    m_powerOn.clear();
+
+    Snapshot s(m_powerOn);
+    if (!serialize(s))
+        m_powerOn.clear();
+}
+
+bool sidemu::powerOn()
+{
+    if (m_powerOn.empty())
+        return false;
+
+    Snapshot s(m_powerOn.data(), m_powerOn.size());
+    return serialize(s) && s.good();
+}
+
+bool sidemu::audible() const
+{
+    const uint8_t modeVol = m_registers[0x18];
+    if ((modeVol & 0x0f) == 0)
+        return false;
+
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        // Without waveform or with the test bit set
+        // the oscillator output is constant
+        const uint8_t control = m_registers[i * 7 + 4];
+        if ((control & 0xf0) == 0 || (control & 0x08) != 0)
+            continue;
+
+        // Voice 3 disconnected and not routed through the filter
+        if (i == 2 && (modeVol & 0x80) != 0 && (m_registers[0x17] & 0x04) == 0)
+            continue;
+
+        if (envelope(i) != 0)
+            return true;
+    }
+
+    return false;
+}
+
+void sidemu::serializeCommon(Snapshot& s)
+{
+    s(m_accessClk);
+    s(m_registers);
+    s(m_volumeChanges);
+    s(m_bufferpos);
+    s.check(m_bufferpos >= 0 && m_bufferpos <= BUFFERSIZE);
+    if (!s.good())
+        return;
+
+    s.io(m_buffer, m_bufferpos * sizeof(int));
+
+    for (int* const buffer : m_voiceBuffer)
+    {
+        if (buffer != nullptr)
+            s.io(buffer, m_bufferpos * sizeof(int));
+    }
+
+    // At most one write per cycle of the current slice,
+    // which can run a little longer than requested
+    std::uint32_t count = static_cast<std::uint32_t>(m_writes.size());
+    s(count);
+    s.check(count <= 2 * OUTPUTBUFFERSIZE);
+    if (!s.good())
+        return;
+
+    if (s.loading())
+        m_writes.resize(count);
+
+    for (write_t &w : m_writes)
+    {
+        s(w.clk);
+        s(w.addr);
+        s(w.data);
+    }
+}
+
 }
@@ -23,7 +23,9 @@
 #ifndef SIDEMU_H
 #define SIDEMU_H
 
+#include <array>
 #include <string>
+#include <vector>
 
 #include <sidplayfp/SidConfig.h>
 #include <sidplayfp/siddefs.h>
@@ -37,6 +39,8 @@ class sidbuilder;
 namespace libsidplayfp
 {
 
+class Snapshot;
+
 /**
  * Inherit this class to create a new SID emulation.
  */
@@ -48,7 +52,10 @@ public:
      */
     enum
     {
-        OUTPUTBUFFERSIZE = 5000
+        OUTPUTBUFFERSIZE = 5000,
+        /// Allocated size of the buffers, the mixer moves the unmixed samples
+        /// back to the start only when less than OUTPUTBUFFERSIZE are free
+        BUFFERSIZE = 2 * OUTPUTBUFFERSIZE
     };
 
     explicit sidemu(sidbuilder* builder) :
@@ -60,6 +67,123 @@ public:
      */
     virtual void clock() = 0;
 
+    /**
+     * Queue register writes with their timestamp instead of
+     * clocking the chip on every access. The queue is replayed
+     * cycle exactly by the next clock() call, which then may run
+     * on another thread. Reads still see the state at the
+     * current cycle. Emulations where queuing saves work
+     * also on a single thread enable it by default.
+     *
+     * @param enable true to queue writes, false to apply them immediately
+     * @return false if the emulation doesn't support it
+     */
+    virtual bool deferWrites([[maybe_unused]] bool enable) { return false; }
+
+    /**
+     * Stop producing audio while seeking. Only the state
+     * visible to the CPU and the envelopes are kept up to date.
+     * Audio production resumes when disabled.
+     *
+     * @param enable true to clock silently
+     */
+    virtual void silent([[maybe_unused]] bool enable) {}
+
+    /**
+     * While clocking silently keep only the envelopes and
+     * the oscillator phases up to date. Reads of OSC3 become
+     * approximate, good enough to follow a tune but not
+     * to resume audio afterwards.
+     *
+     * @param enable true to clock coarsely
+     */
+    virtual void coarse([[maybe_unused]] bool enable) {}
+
+    /**
+     * Save or restore the emulation state, including the samples
+     * not yet mixed and the queued writes.
+     *
+     * @return false if the emulation doesn't support it
+     */
+    virtual bool serialize([[maybe_unused]] Snapshot& s) { return false; }
+
+    /**
+     * Remember the current state as the one #powerOn gets back to.
+     * Call it once the chip is set up.
+     */
+    void savePowerOn();
+
+    /**
+     * Get back to the state saved by #savePowerOn.
+     * Unlike #reset, which like the real chip keeps the oscillators,
+     * the envelopes and the filter going, this leaves nothing
+     * of what was played before.
+     *
+     * @return false if no state was saved
+     */
+    bool powerOn();
+
+    /**
+     * Produce the output of each voice next to the chip output,
+     * in the buffers returned by #voiceBuffer.
+     *
+     * @param enable true to produce the voice outputs
+     * @return false if the emulation doesn't support it
+     */
+    virtual bool voiceOutputs(bool enable) { return !enable; }
+
+    /**
+     * Get the envelope level of a voice, kept up to date
+     * also when clocking silently.
+     *
+     * @param num the voice number, from 0 to 2
+     * @return the level, 0xff if the emulation doesn't expose it
+     */
+    virtual uint8_t envelope([[maybe_unused]] unsigned int num) const { return 0xff; }
+
+    /**
+     * Check from the registers and the envelopes
+     * if any voice can be heard.
+     * Samples played through the volume register are
+     * told apart by #volumeChanges instead.
+     */
+    bool audible() const;
+
+    /**
+     * Get the number of master volume changes since the last call.
+     * A high rate means the chip is playing samples.
+     */
+    unsigned int volumeChanges()
+    {
+        const unsigned int changes = m_volumeChanges;
+        m_volumeChanges = 0;
+        return changes;
+    }
+
+    /**
+     * Get the last values written to the registers.
+     */
+    const uint8_t* registers() const { return m_registers.data(); }
+
+    /**
+     * Forget the values written to the registers.
+     */
+    void clearRegisters()
+    {
+        m_registers.fill(0);
+        m_volumeChanges = 0;
+    }
+
+    // Bank functions
+    void poke(uint_least16_t address, uint8_t value) override
+    {
+        const uint_least8_t addr = address & 0x1f;
+        if (addr == 0x18 && ((value ^ m_registers[0x18]) & 0x0f) != 0)
+            m_volumeChanges++;
+        m_registers[addr] = value;
+        write(addr, value);
+    }
+
     /**
      * Set execution environment and lock sid to it.
      */
@@ -82,6 +206,11 @@ public:
      */
     virtual void model(SidConfig::SIDModel model, bool digiboost) = 0;
 
+    /**
+     * Check if the chip is currently set to the given model.
+     */
+    virtual bool hasModel([[maybe_unused]] SidConfig::SIDModel model) const { return false; }
+
     /**
      * Set the sampling method.
      *
@@ -113,8 +242,32 @@ public:
 
     /**
      * Get the buffer.
+     * Samples are not clipped to 16 bits.
+     */
+    int* buffer() const { return m_buffer; }
+
+    /**
+     * Get the output buffer of a voice, filled in step with #buffer.
+     *
+     * @param num the voice number, from 0 to 2
+     * @return the buffer or nullptr if the voice outputs are disabled
      */
-    short* buffer() const { return m_buffer; }
+    int* voiceBuffer(unsigned int num) const { return m_voiceBuffer[num]; }
+
+protected:
+    /// A register write queued for later replay
+    struct write_t
+    {
+        event_clock_t clk;
+        uint_least8_t addr;
+        uint8_t data;
+    };
+
+protected:
+    /**
+     * Save or restore the state shared by all emulations.
+     */
+    void serializeCommon(Snapshot& s);
 
 protected:
     static const char ERR_UNSUPPORTED_FREQ[];
@@ -126,17 +279,33 @@ protected:
     event_clock_t m_accessClk{};
 
     /// The sample buffer
-    short *m_buffer = nullptr;
+    int *m_buffer = nullptr;
+
+    /// The voice output buffers, null unless enabled
+    std::array<int*, 3> m_voiceBuffer{};
 
     /// Current position in buffer
     int m_bufferpos = 0;
 
+    /// Writes queued since the last clock() call
+    std::vector<write_t> m_writes;
+
+    /// Last values written to the registers
+    std::array<uint8_t, 0x20> m_registers{};
+
+    unsigned int m_volumeChanges = 0;
+
+    bool m_deferWrites = false;
+
     bool m_status = true;
     bool isLocked = false;
 
     std::string m_error{"N/A"};
 
 private:
+    /// State saved by savePowerOn, empty if unsupported
+    std::vector<uint8_t> m_powerOn;
+
     sidbuilder* const m_builder;
 };
 
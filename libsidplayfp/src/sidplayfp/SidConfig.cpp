@@ -46,5 +46,7 @@ bool SidConfig::compare(const SidConfig &config) const
         || rightVolume != config.rightVolume
         || powerOnDelay != config.powerOnDelay
         || samplingMethod != config.samplingMethod
-        || fastSampling != config.fastSampling;
+        || fastSampling != config.fastSampling
+        || threadedSids != config.threadedSids
+        || voiceOutputs != config.voiceOutputs;
 }
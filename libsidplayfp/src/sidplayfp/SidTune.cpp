@@ -19,9 +19,11 @@
  */
 
 #include <sidplayfp/SidTune.h>
+#include <sidplayfp/SidTuneCache.h>
 
 #include <array>
 #include "sidtune/SidTuneBase.h"
+#include "sidtune/tuneCache.h"
 
 using namespace libsidplayfp;
 
@@ -67,14 +69,20 @@ SidTune::~SidTune() = default;
 
 void SidTune::setFileNameExtensions(const char* const* fileNameExt)
 {
-    fileNameExtensions = (fileNameExt != nullptr) ? fileNameExt : defaultFileNameExt.data();
+    m_fileNameExtensions = (fileNameExt != nullptr) ? fileNameExt : fileNameExtensions;
+}
+
+void SidTune::setCache(SidTuneCache* cache)
+{
+    m_cache = cache;
 }
 
 void SidTune::load(const char* fileName, bool separatorIsSlash)
 {
     try
     {
-        tune = SidTuneBase::load(fileName, fileNameExtensions, separatorIsSlash);
+        tune = SidTuneBase::load(fileName, m_fileNameExtensions, separatorIsSlash,
+                                 m_cache != nullptr ? m_cache->m_cache.get() : nullptr);
         m_status = true;
         m_statusString = MSG_NO_ERRORS;
     }
@@ -89,7 +97,8 @@ void SidTune::read(const uint_least8_t* sourceBuffer, uint_least32_t bufferLen)
 {
     try
     {
-        tune = SidTuneBase::read(sourceBuffer, bufferLen);
+        tune = SidTuneBase::read(sourceBuffer, bufferLen,
+                                 m_cache != nullptr ? m_cache->m_cache.get() : nullptr);
         m_status = true;
         m_statusString = MSG_NO_ERRORS;
     }
@@ -0,0 +1,41 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <sidplayfp/SidTuneCache.h>
+
+#include "sidtune/tuneCache.h"
+
+using namespace libsidplayfp;
+
+SidTuneCache::SidTuneCache(std::size_t capacity) :
+    m_cache(new tuneCache(capacity))
+{}
+
+SidTuneCache::~SidTuneCache() = default;
+
+void SidTuneCache::clear() { m_cache->clear(); }
+
+std::size_t SidTuneCache::size() const { return m_cache->size(); }
+
+std::size_t SidTuneCache::capacity() const { return m_cache->capacity(); }
+
+std::uint64_t SidTuneCache::hits() const { return m_cache->hits(); }
+
+std::uint64_t SidTuneCache::misses() const { return m_cache->misses(); }
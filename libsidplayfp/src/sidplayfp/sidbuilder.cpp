@@ -30,6 +30,18 @@ libsidplayfp::sidemu *sidbuilder::lock(libsidplayfp::EventScheduler *env, SidCon
 {
     m_status = true;
 
+    // Prefer a free SID already set to the model,
+    // switching model rebuilds the chip tables
+    for (emuset_t::iterator it=sidobjs.begin(); it != sidobjs.end(); ++it)
+    {
+        libsidplayfp::sidemu *sid = (*it);
+        if (sid->hasModel(model) && sid->lock(env))
+        {
+            sid->model(model, digiboost);
+            return sid;
+        }
+    }
+
     for (emuset_t::iterator it=sidobjs.begin(); it != sidobjs.end(); ++it)
     {
         libsidplayfp::sidemu *sid = (*it);
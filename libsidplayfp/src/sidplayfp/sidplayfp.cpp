@@ -61,11 +61,80 @@ std::size_t sidplayfp::play(short *buffer, std::size_t count)
     return sidplayer.play(buffer, count);
 }
 
+std::size_t sidplayfp::play(int32_t *buffer, std::size_t count)
+{
+    return sidplayer.play(buffer, count);
+}
+
+std::size_t sidplayfp::play(float *buffer, std::size_t count)
+{
+    return sidplayer.play(buffer, count);
+}
+
+std::size_t sidplayfp::play(short *buffer, std::size_t count, short *const *voices)
+{
+    return sidplayer.play(buffer, count, voices);
+}
+
+std::size_t sidplayfp::play(int32_t *buffer, std::size_t count, int32_t *const *voices)
+{
+    return sidplayer.play(buffer, count, voices);
+}
+
+std::size_t sidplayfp::play(float *buffer, std::size_t count, float *const *voices)
+{
+    return sidplayer.play(buffer, count, voices);
+}
+
+std::size_t sidplayfp::play(std::nullptr_t, std::size_t count)
+{
+    return sidplayer.play(static_cast<short*>(nullptr), count);
+}
+
+bool sidplayfp::renderToSink(SidTune *tune, unsigned int song, uint_least32_t lengthMs,
+                             sidsink &sink, std::size_t &rendered, std::size_t blockSize)
+{
+    return sidplayer.render(tune, song, lengthMs, sink, rendered, blockSize);
+}
+
+bool sidplayfp::renderToSink(SidTune *tune, unsigned int song, SidDatabase &database,
+                             sidsink &sink, std::size_t &rendered, std::size_t blockSize)
+{
+    return sidplayer.render(tune, song, database, sink, rendered, blockSize);
+}
+
+bool sidplayfp::renderToBuffer(SidTune *tune, unsigned int song, uint_least32_t lengthMs,
+                               short *buffer, std::size_t count, std::size_t &rendered)
+{
+    return sidplayer.render(tune, song, lengthMs, buffer, count, rendered);
+}
+
+int_least32_t sidplayfp::estimateLength(SidTune *tune, unsigned int song,
+                                        uint_least32_t maxLengthMs, uint_least32_t silenceMs)
+{
+    return sidplayer.estimateLength(tune, song, maxLengthMs, silenceMs);
+}
+
 bool sidplayfp::load(SidTune *tune)
 {
     return sidplayer.load(tune);
 }
 
+bool sidplayfp::seek(uint_least32_t ms)
+{
+    return sidplayer.seek(ms);
+}
+
+bool sidplayfp::saveState(std::vector<uint8_t> &state)
+{
+    return sidplayer.saveState(state);
+}
+
+bool sidplayfp::loadState(const uint8_t *data, std::size_t size)
+{
+    return sidplayer.loadState(data, size);
+}
+
 const SidInfo &sidplayfp::info() const
 {
     return sidplayer.info();
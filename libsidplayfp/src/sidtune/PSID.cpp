@@ -370,7 +370,7 @@ const char *PSID::createMD5(char *md5)
     {
         // Include C64 data.
         sidmd5 myMD5;
-        myMD5.append(&cache[fileOffset], info->m_c64dataLen);
+        myMD5.append(&(*cache)[fileOffset], info->m_c64dataLen);
 
         uint8_t tmp[2];
         // Include INIT and PLAY address.
@@ -436,24 +436,31 @@ const char *PSID::createMD5New(char *md5)
 
     *md5 = '\0';
 
-    try
+    // The file data never changes so the
+    // digest is computed only once
+    if (m_md5New.empty())
     {
-        // The calculation is now simplified
-        // All the header + all the data
-        sidmd5 myMD5;
-        myMD5.append(&cache[0], cache.size());
+        try
+        {
+            // The calculation is now simplified
+            // All the header + all the data
+            sidmd5 myMD5;
+            myMD5.append(cache->data(), cache->size());
 
-        myMD5.finish();
+            myMD5.finish();
 
-        // Get fingerprint.
-        myMD5.getDigest().copy(md5, SidTune::MD5_LENGTH);
-        md5[SidTune::MD5_LENGTH] = '\0';
-    }
-    catch (md5Error const &)
-    {
-        return nullptr;
+            // Get fingerprint.
+            m_md5New = myMD5.getDigest();
+        }
+        catch (md5Error const &)
+        {
+            return nullptr;
+        }
     }
 
+    m_md5New.copy(md5, SidTune::MD5_LENGTH);
+    md5[SidTune::MD5_LENGTH] = '\0';
+
     return md5;
 }
 
@@ -22,6 +22,7 @@
 #define PSID_H
 
 #include <memory>
+#include <string>
 
 #include <sidplayfp/SidTune.h>
 #include "sidtune/SidTuneBase.h"
@@ -36,7 +37,6 @@ class PSID final : public SidTuneBase
 public:
     ~PSID() override = default;
 
-    PSID(const PSID&) = delete;
     PSID& operator=(const PSID&) = delete;
 
     /**
@@ -49,9 +49,13 @@ public:
 
     const char* createMD5New(char* md5) override;
 
+    std::unique_ptr<SidTuneBase> clone() const override { return std::unique_ptr<SidTuneBase>(new PSID(*this)); }
+
 protected:
     PSID() {}
 
+    PSID(const PSID&) = default;
+
 private:
     /**
      * Load PSID file.
@@ -68,6 +72,9 @@ private:
     static void readHeader(const buffer_t& dataBuf, psidHeader& hdr);
 
     char m_md5[SidTune::MD5_LENGTH+1];
+
+    /// Digest of the whole file, shared with the copies.
+    std::string m_md5New;
 };
 
 }
@@ -26,7 +26,6 @@
 #include <cstring>
 #include <climits>
 #include <fstream>
-#include <iterator>
 #include <iomanip>
 #include <iostream>
 
@@ -40,6 +39,7 @@
 #include "sidtune/SidTuneInfoImpl.h"
 #include "sidtune/SidTuneTools.h"
 #include "sidtune/SmartPtr.h"
+#include "sidtune/tuneCache.h"
 
 namespace libsidplayfp
 {
@@ -92,7 +92,7 @@ constexpr uint_least32_t MAX_FILELEN = MAX_MEMORY + 2 + 0x7C;
 constexpr uint_least16_t SIDTUNE_R64_MIN_LOAD_ADDR = 0x07e8;
 
 std::unique_ptr<SidTuneBase> SidTuneBase::load(const char* fileName, const char* const* fileNameExt,
-                                               bool separatorIsSlash)
+                                               bool separatorIsSlash, tuneCache* tunes)
 {
     if (fileName == nullptr)
         return nullptr;
@@ -102,12 +102,13 @@ std::unique_ptr<SidTuneBase> SidTuneBase::load(const char* fileName, const char*
     if (strcmp(fileName, "-") == 0)
         return getFromStdIn();
 #endif
-    return getFromFiles(fileName, fileNameExt, separatorIsSlash);
+    return getFromFiles(fileName, fileNameExt, separatorIsSlash, tunes);
 }
 
-std::unique_ptr<SidTuneBase> SidTuneBase::read(const uint_least8_t* sourceBuffer, uint_least32_t bufferLen)
+std::unique_ptr<SidTuneBase> SidTuneBase::read(const uint_least8_t* sourceBuffer, uint_least32_t bufferLen,
+                                               tuneCache* tunes)
 {
-    return getFromBuffer(sourceBuffer, bufferLen);
+    return getFromBuffer(sourceBuffer, bufferLen, tunes);
 }
 
 const SidTuneInfo* SidTuneBase::getInfo() const
@@ -169,7 +170,7 @@ void SidTuneBase::placeSidTuneInC64mem(sidmemory& mem)
     mem.writeMemWord(0xae, end);
 
     // Copy data from cache to the correct destination.
-    mem.fillRam(info->m_loadAddr, &cache[fileOffset], info->m_c64dataLen);
+    mem.fillRam(info->m_loadAddr, &(*cache)[fileOffset], info->m_c64dataLen);
 }
 
 SidTuneBase::buffer_t SidTuneBase::loadFile(const char* fileName)
@@ -192,18 +193,21 @@ SidTuneBase::buffer_t SidTuneBase::loadFile(const char* fileName)
     inFile.seekg(0, std::ios::beg);
 
     buffer_t fileBuf;
-    fileBuf.reserve(fileLen);
 
     try
     {
-        fileBuf.assign(std::istreambuf_iterator<char>(inFile), std::istreambuf_iterator<char>());
+        fileBuf.resize(fileLen);
     }
     catch (const std::exception &ex)
     {
         throw loadError(ex.what());
     }
 
-    if (inFile.bad())
+    // Read the file in one go, going through the stream
+    // one character at a time is an order of magnitude slower.
+    inFile.read(reinterpret_cast<char*>(fileBuf.data()), fileLen);
+
+    if (inFile.bad() || inFile.gcount() != fileLen)
     {
         throw loadError(ERR_CANT_LOAD_FILE);
     }
@@ -219,6 +223,21 @@ SidTuneBase::SidTuneBase() :
     clockSpeed.fill(info->m_clockSpeed);
 }
 
+bool SidTuneBase::isLoadedFrom(const uint_least8_t* data, std::size_t size) const
+{
+    return cache != nullptr
+        && cache->size() == size
+        && std::memcmp(cache->data(), data, size) == 0;
+}
+
+SidTuneBase::SidTuneBase(const SidTuneBase& other) :
+    info(std::make_unique<SidTuneInfoImpl>(*other.info)),
+    songSpeed(other.songSpeed),
+    clockSpeed(other.clockSpeed),
+    fileOffset(other.fileOffset),
+    cache(other.cache)
+{}
+
 #if !defined(SIDTUNE_NO_STDIN_LOADER)
 
 std::unique_ptr<SidTuneBase> SidTuneBase::getFromStdIn()
@@ -238,7 +257,8 @@ std::unique_ptr<SidTuneBase> SidTuneBase::getFromStdIn()
 
 #endif
 
-std::unique_ptr<SidTuneBase> SidTuneBase::getFromBuffer(const uint_least8_t* const buffer, std::size_t bufferLen)
+std::unique_ptr<SidTuneBase> SidTuneBase::getFromBuffer(const uint_least8_t* const buffer, std::size_t bufferLen,
+                                                        tuneCache* tunes)
 {
     if (buffer == nullptr || bufferLen == 0)
     {
@@ -250,6 +270,20 @@ std::unique_ptr<SidTuneBase> SidTuneBase::getFromBuffer(const uint_least8_t* con
         throw loadError(ERR_FILE_TOO_LONG);
     }
 
+    tuneCache::key_t key = 0;
+    if (tunes != nullptr)
+    {
+        key = tuneCache::makeKey(buffer, bufferLen);
+        std::unique_ptr<SidTuneBase> s = tunes->find(key, buffer, bufferLen);
+        if (s != nullptr)
+        {
+            s->setFileNames("-", "-", false);
+            return s;
+        }
+    }
+
+    // This is the only copy, the loaders
+    // hand it over to the tune.
     buffer_t buf1(buffer, buffer + bufferLen);
 
     // Here test for the possible single file formats.
@@ -264,11 +298,16 @@ std::unique_ptr<SidTuneBase> SidTuneBase::getFromBuffer(const uint_least8_t* con
     }
 
     s->acceptSidTune("-", "-", buf1, false);
+
+    if (tunes != nullptr)
+    {
+        tunes->insert(key, *s);
+    }
+
     return s;
 }
 
-void SidTuneBase::acceptSidTune(const char* dataFileName, const char* infoFileName,
-                                buffer_t& buf, bool isSlashedFileName)
+void SidTuneBase::setFileNames(const char* dataFileName, const char* infoFileName, bool isSlashedFileName)
 {
     // Make a copy of the data file name and path, if available.
     if (dataFileName != nullptr)
@@ -288,6 +327,12 @@ void SidTuneBase::acceptSidTune(const char* dataFileName, const char* infoFileNa
             SidTuneTools::fileNameWithoutPath(infoFileName);
         info->m_infoFileName = std::string(infoFileName + fileNamePos);
     }
+}
+
+void SidTuneBase::acceptSidTune(const char* dataFileName, const char* infoFileName,
+                                buffer_t& buf, bool isSlashedFileName)
+{
+    setFileNames(dataFileName, infoFileName, isSlashedFileName);
 
     // Fix bad sidtune set up.
     if (info->m_songs > MAX_SONGS)
@@ -339,7 +384,7 @@ void SidTuneBase::acceptSidTune(const char* dataFileName, const char* infoFileNa
         throw loadError(ERR_EMPTY);
     }
 
-    cache.swap(buf);
+    cache = std::make_shared<const buffer_t>(std::move(buf));
 }
 
 std::string SidTuneBase::createNewFileName(std::string_view sourceName, std::string_view sourceExt)
@@ -352,10 +397,26 @@ std::string SidTuneBase::createNewFileName(std::string_view sourceName, std::str
 
 // Initializing the object based upon what we find in the specified file.
 
-std::unique_ptr<SidTuneBase> SidTuneBase::getFromFiles(const char* fileName, const char* const* fileNameExtensions, bool separatorIsSlash)
+std::unique_ptr<SidTuneBase> SidTuneBase::getFromFiles(const char* fileName, const char* const* fileNameExtensions,
+                                                       bool separatorIsSlash, tuneCache* tunes)
 {
     buffer_t fileBuf1 = loadFile(fileName);
 
+    // Only PSID tunes are cached as they do not depend
+    // on the file name or on a second file.
+    tuneCache::key_t key = 0;
+    if (tunes != nullptr)
+    {
+        key = tuneCache::makeKey(fileBuf1.data(), fileBuf1.size());
+        std::unique_ptr<SidTuneBase> s = tunes->find(key, fileBuf1.data(), fileBuf1.size());
+        if (s != nullptr)
+        {
+            s->setFileNames(fileName, nullptr, separatorIsSlash);
+            return s;
+        }
+    }
+
+
     // File loaded. Now check if it is in a valid single-file-format.
     std::unique_ptr<SidTuneBase> s = PSID::load(fileBuf1);
     if (s == nullptr)
@@ -412,6 +473,12 @@ std::unique_ptr<SidTuneBase> SidTuneBase::getFromFiles(const char* fileName, con
     if (s == nullptr) throw loadError(ERR_UNRECOGNIZED_FORMAT);
 
     s->acceptSidTune(fileName, nullptr, fileBuf1, separatorIsSlash);
+
+    if (tunes != nullptr)
+    {
+        tunes->insert(key, *s);
+    }
+
     return s;
 }
 
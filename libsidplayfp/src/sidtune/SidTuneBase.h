@@ -40,6 +40,7 @@ namespace libsidplayfp
 {
 
 class sidmemory;
+class tuneCache;
 template <class T> class SmartPtr_sidtt;
 
 /**
@@ -63,7 +64,6 @@ class SidTuneBase
 public:
     virtual ~SidTuneBase() = default;
 
-    SidTuneBase(const SidTuneBase&) = delete;
     SidTuneBase& operator=(const SidTuneBase&) = delete;
 
     /**
@@ -79,10 +79,12 @@ public:
      * @param fileName
      * @param fileNameExt
      * @param separatorIsSlash
+     * @param tunes the cache of parsed tunes, may be nullptr
      * @return the sid tune
      * @throw loadError
      */
-    static std::unique_ptr<SidTuneBase> load(const char* fileName, const char* const* fileNameExt, bool separatorIsSlash);
+    static std::unique_ptr<SidTuneBase> load(const char* fileName, const char* const* fileNameExt,
+                                             bool separatorIsSlash, tuneCache* tunes = nullptr);
 
     /**
      * Load a single-file sidtune from a memory buffer.
@@ -90,10 +92,25 @@ public:
      *
      * @param sourceBuffer
      * @param bufferLen
+     * @param tunes the cache of parsed tunes, may be nullptr
      * @return the sid tune
      * @throw loadError
      */
-    static std::unique_ptr<SidTuneBase> read(const uint_least8_t * sourceBuffer, uint_least32_t bufferLen);
+    static std::unique_ptr<SidTuneBase> read(const uint_least8_t * sourceBuffer, uint_least32_t bufferLen,
+                                             tuneCache* tunes = nullptr);
+
+    /**
+     * Copy the tune for the tune cache.
+     * The copy shares the file data with this tune.
+     *
+     * @return the copy, nullptr if the format cannot be cached
+     */
+    virtual std::unique_ptr<SidTuneBase> clone() const { return nullptr; }
+
+    /**
+     * Check if the tune was loaded from the given file data.
+     */
+    bool isLoadedFrom(const uint_least8_t* data, std::size_t size) const;
 
     /**
      * Select sub-song (0 = default starting song)
@@ -145,7 +162,7 @@ public:
     /**
      * Get the pointer to the tune data.
      */
-    const uint_least8_t* c64Data() const { return &cache[fileOffset]; }
+    const uint_least8_t* c64Data() const { return &(*cache)[fileOffset]; }
 
 protected:
     using buffer_t = std::vector<uint8_t>;
@@ -159,6 +176,11 @@ protected:
 
     SidTuneBase();
 
+    /**
+     * Copy constructor for #clone.
+     */
+    SidTuneBase(const SidTuneBase& other);
+
     /**
      * Does not affect status of object, and therefore can be used
      * to load files. Error string is put into info.statusString, though.
@@ -214,6 +236,15 @@ protected:
     virtual void acceptSidTune(const char* dataFileName, const char* infoFileName,
                                buffer_t& buf, bool isSlashedFileName);
 
+    /**
+     * Store the file names and path of the tune.
+     *
+     * @param dataFileName
+     * @param infoFileName
+     * @param isSlashedFileName see #acceptSidTune
+     */
+    void setFileNames(const char* dataFileName, const char* infoFileName, bool isSlashedFileName);
+
     /**
      * Petscii to Ascii converter.
      */
@@ -227,18 +258,21 @@ protected:
     /// For files with header: offset to real data
     uint_least32_t fileOffset = 0;
 
-    buffer_t cache;
+    /// The file data, shared with the copies in the tune cache.
+    std::shared_ptr<const buffer_t> cache;
 
 private:
 #if !defined(SIDTUNE_NO_STDIN_LOADER)
     static std::unique_ptr<SidTuneBase> getFromStdIn();
 #endif
-    static std::unique_ptr<SidTuneBase> getFromFiles(const char* name, const char* const* fileNameExtensions, bool separatorIsSlash);
+    static std::unique_ptr<SidTuneBase> getFromFiles(const char* name, const char* const* fileNameExtensions,
+                                                     bool separatorIsSlash, tuneCache* tunes);
 
     /**
      * Try to retrieve single-file sidtune from specified buffer.
      */
-    static std::unique_ptr<SidTuneBase> getFromBuffer(const uint_least8_t* buffer, std::size_t bufferLen);
+    static std::unique_ptr<SidTuneBase> getFromBuffer(const uint_least8_t* buffer, std::size_t bufferLen,
+                                                      tuneCache* tunes = nullptr);
 
     /**
      * Get new file name with specified extension.
@@ -44,7 +44,7 @@ public:
         m_sidChipAddresses.push_back(0xd400);
     }
 
-    SidTuneInfoImpl(const SidTuneInfoImpl&) = delete;
+    SidTuneInfoImpl(const SidTuneInfoImpl&) = default;
     SidTuneInfoImpl& operator=(const SidTuneInfoImpl&) = delete;
 
     uint_least16_t getLoadAddr() const override { return m_loadAddr; }
@@ -0,0 +1,137 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "tuneCache.h"
+
+#include <cstring>
+
+#include "sidtune/SidTuneBase.h"
+
+namespace libsidplayfp
+{
+
+tuneCache::tuneCache(std::size_t capacity) :
+    m_capacity(capacity > 0 ? capacity : 1),
+    m_hits(0),
+    m_misses(0)
+{}
+
+tuneCache::key_t tuneCache::makeKey(const std::uint8_t* data, std::size_t size)
+{
+    // Multiply and shift eight bytes at a time on four independent
+    // lanes, collisions are caught by comparing the data
+    constexpr std::uint64_t PRIME = 0x9e3779b97f4a7c15ULL;
+
+    std::uint64_t lane[4] = { size, size ^ PRIME, ~size, size + PRIME };
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        for (int j = 0; j < 4; j++)
+        {
+            std::uint64_t word;
+            std::memcpy(&word, data + i + j * 8, sizeof(word));
+            lane[j] = (lane[j] ^ word) * PRIME;
+            lane[j] ^= lane[j] >> 29;
+        }
+    }
+
+    std::uint64_t hash = lane[0];
+    for (int j = 1; j < 4; j++)
+    {
+        hash = (hash ^ lane[j]) * PRIME;
+    }
+    for (; i < size; i++)
+    {
+        hash = (hash ^ data[i]) * PRIME;
+    }
+    return hash ^ (hash >> 32);
+}
+
+std::unique_ptr<SidTuneBase> tuneCache::find(key_t key, const std::uint8_t* data, std::size_t size)
+{
+    std::shared_ptr<const SidTuneBase> tune;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        auto it = m_index.find(key);
+        if (it == m_index.end() || !it->second->second->isLoadedFrom(data, size))
+        {
+            m_misses.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        tune = it->second->second;
+    }
+
+    m_hits.fetch_add(1, std::memory_order_relaxed);
+
+    // The cached tune is never modified so it can be copied
+    // without holding the lock
+    return tune->clone();
+}
+
+void tuneCache::insert(key_t key, const SidTuneBase &tune)
+{
+    std::unique_ptr<SidTuneBase> copy = tune.clone();
+    if (copy == nullptr)
+        return;
+
+    // Compute the digest once for all the copies
+    copy->createMD5New(nullptr);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_index.find(key);
+    if (it != m_index.end())
+    {
+        // Either another thread got here first or
+        // a different file has the same key, keep the newest
+        it->second->second = std::move(copy);
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return;
+    }
+
+    if (m_entries.size() >= m_capacity)
+    {
+        m_index.erase(m_entries.back().first);
+        m_entries.pop_back();
+    }
+
+    m_entries.emplace_front(key, std::move(copy));
+    m_index.emplace(key, m_entries.begin());
+}
+
+void tuneCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_index.clear();
+    m_entries.clear();
+}
+
+std::size_t tuneCache::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_entries.size();
+}
+
+}
@@ -0,0 +1,108 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef TUNECACHE_H
+#define TUNECACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace libsidplayfp
+{
+
+class SidTuneBase;
+
+/**
+ * Least recently used cache of parsed tunes.
+ *
+ * The tunes are looked up by a cheap hash of the whole file
+ * and confirmed by comparing the data, hashing the file with MD5
+ * on each load would cost far more than parsing it.
+ * The MD5 digest used by the new songlength database format is
+ * instead computed once when a tune enters the cache and is
+ * inherited by all the copies.
+ * The cached tunes are never handed out, a lookup returns
+ * a copy which shares the file data with the cached one.
+ * All the methods can be called from several threads at once.
+ */
+class tuneCache
+{
+public:
+    using key_t = std::uint64_t;
+
+public:
+    explicit tuneCache(std::size_t capacity);
+
+    /**
+     * Compute the key of a file.
+     */
+    static key_t makeKey(const std::uint8_t* data, std::size_t size);
+
+    /**
+     * Look up a tune.
+     *
+     * @return a copy of the cached tune, nullptr if not found
+     */
+    std::unique_ptr<SidTuneBase> find(key_t key, const std::uint8_t* data, std::size_t size);
+
+    /**
+     * Add a freshly loaded tune, dropping the least recently used
+     * one if the cache is full.
+     * Tunes whose format cannot be cached are ignored.
+     */
+    void insert(key_t key, const SidTuneBase &tune);
+
+    void clear();
+
+    std::size_t size() const;
+
+    std::size_t capacity() const { return m_capacity; }
+
+    std::uint64_t hits() const { return m_hits.load(std::memory_order_relaxed); }
+
+    std::uint64_t misses() const { return m_misses.load(std::memory_order_relaxed); }
+
+private:
+    using entry_t = std::pair<key_t, std::shared_ptr<const SidTuneBase>>;
+    using list_t = std::list<entry_t>;
+
+private:
+    const std::size_t m_capacity;
+
+    mutable std::mutex m_mutex;
+
+    /// Most recently used first
+    list_t m_entries;
+
+    std::unordered_map<key_t, list_t::iterator> m_index;
+
+    std::atomic<std::uint64_t> m_hits;
+    std::atomic<std::uint64_t> m_misses;
+};
+
+}
+
+#endif // TUNECACHE_H
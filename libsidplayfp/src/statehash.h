@@ -0,0 +1,57 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef STATEHASH_H
+#define STATEHASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace libsidplayfp
+{
+
+/**
+ * Fold a block of machine state into a running hash,
+ * eight bytes at a time. Not meant to resist collisions
+ * made on purpose, only to tell states apart quickly.
+ */
+inline uint64_t hashState(uint64_t hash, const uint8_t* data, std::size_t size)
+{
+    constexpr uint64_t PRIME = 0x9e3779b97f4a7c15ULL;
+
+    std::size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * PRIME;
+        hash ^= hash >> 29;
+    }
+    for (; i < size; i++)
+    {
+        hash = (hash ^ data[i]) * PRIME;
+    }
+    return hash;
+}
+
+}
+
+#endif // STATEHASH_H
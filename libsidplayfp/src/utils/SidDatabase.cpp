@@ -23,12 +23,17 @@
 #include <sidplayfp/SidDatabase.h>
 
 #include <cctype>
+#include <cstdio>
 #include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
 
 #include "sidplayfp/SidTune.h"
 #include "sidplayfp/SidTuneInfo.h"
 
 #include "utils/iniParser.h"
+#include "utils/songlengthIndex.h"
 
 const char ERR_DATABASE_CORRUPT[]        = "SID DATABASE ERROR: Database seems to be corrupt.";
 const char ERR_NO_DATABASE_LOADED[]      = "SID DATABASE ERROR: Songlength database not loaded.";
@@ -69,18 +74,26 @@ const char *parseTime(const char *str, int_least32_t &result)
 
     if (*end == '.')
     {
-        end++;
-        long milliseconds = strtol(end, &end, 10);
-        if (milliseconds<10)
+        const char *fraction = ++end;
+        long milliseconds = strtol(fraction, &end, 10);
+        // Scale by the digits, so that leading zeros count
+        switch (end - fraction)
+        {
+        case 1:
             milliseconds *= 100;
-        else if (milliseconds<100)
+            break;
+        case 2:
             milliseconds *= 10;
-        else if (milliseconds>=1000)
+            break;
+        case 3:
+            break;
+        default:
             throw parseError();
+        }
         result += milliseconds;
     }
 
-    while (!isspace(*end))
+    while (*end && !isspace(*end))
     {
         end++;
     }
@@ -91,6 +104,20 @@ const char *parseTime(const char *str, int_least32_t &result)
 
 bool SidDatabase::open(const char *filename)
 {
+    close();
+
+    // Prefer a compiled index, either given directly
+    // or built from the text database and still matching it
+    m_index = std::make_unique<libsidplayfp::songlengthIndex>();
+    if (m_index->open(filename))
+        return true;
+
+    const libsidplayfp::songlengthIndex::source_t src = libsidplayfp::songlengthIndex::source(filename);
+    if (src.size != 0 && m_index->open((std::string(filename) + ".idx").c_str(), src))
+        return true;
+
+    m_index.reset();
+
     m_parser = std::make_unique<libsidplayfp::iniParser>();
 
     if (!m_parser->open(filename))
@@ -106,6 +133,76 @@ bool SidDatabase::open(const char *filename)
 void SidDatabase::close()
 {
     m_parser.reset();
+    m_index.reset();
+}
+
+bool SidDatabase::compile(const char *filename, const char *indexFile)
+{
+    // Taken first so that a change while reading leaves the index stale
+    const libsidplayfp::songlengthIndex::source_t src = libsidplayfp::songlengthIndex::source(filename);
+
+    std::ifstream in(filename, std::ios::in | std::ios::binary);
+    if (in.fail())
+        return false;
+
+    std::vector<libsidplayfp::songlengthIndex::record_t> records;
+    bool database = false;
+
+    std::string buffer;
+    while (std::getline(in, buffer))
+    {
+        if (buffer.empty())
+            continue;
+
+        switch (buffer.front())
+        {
+        case ';':
+        case '#':
+            // skip comments
+            break;
+        case '[':
+            database = buffer.compare(0, 10, "[Database]") == 0;
+            break;
+        default:
+        {
+            const std::size_t pos = buffer.find('=');
+            if (!database || pos == std::string::npos || pos == 0)
+                break;
+
+            libsidplayfp::songlengthIndex::record_t record;
+            const std::string_view key(buffer.data(), buffer.find_last_not_of(' ', pos - 1) + 1);
+            if (!libsidplayfp::songlengthIndex::parseKey(key, record.key))
+                break;
+
+            // Keep the lengths up to the first invalid one,
+            // the following are not reachable in the text database either
+            const char *str = buffer.c_str() + pos + 1;
+            for (;;)
+            {
+                while (isspace(*str))
+                    str++;
+                if (*str == '\0')
+                    break;
+
+                std::int32_t time;
+                try
+                {
+                    str = parseTime(str, time);
+                }
+                catch (const parseError&)
+                {
+                    break;
+                }
+                record.lengths.push_back(static_cast<std::uint32_t>(time));
+            }
+
+            records.push_back(std::move(record));
+            break;
+        }
+        }
+    }
+
+    return libsidplayfp::songlengthIndex::write(indexFile, records, src);
 }
 
 std::int32_t SidDatabase::length(SidTune &tune)
@@ -138,6 +235,25 @@ std::int32_t SidDatabase::lengthMs(SidTune &tune)
     return lengthMs(md5, song);
 }
 
+std::string SidDatabase::formatEntry(std::string_view md5, const std::vector<std::uint_least32_t> &lengthsMs)
+{
+    std::string entry(md5);
+    entry += '=';
+
+    for (std::size_t i = 0; i < lengthsMs.size(); i++)
+    {
+        const std::uint_least32_t ms = lengthsMs[i];
+        char time[32];
+        std::snprintf(time, sizeof(time), "%s%u:%02u.%03u", i == 0 ? "" : " ",
+            static_cast<unsigned int>(ms / 60000),
+            static_cast<unsigned int>(ms / 1000 % 60),
+            static_cast<unsigned int>(ms % 1000));
+        entry += time;
+    }
+
+    return entry;
+}
+
 std::int32_t SidDatabase::length(std::string_view md5, std::size_t song)
 {
     return lengthMs(md5, song) / 1000;
@@ -145,6 +261,23 @@ std::int32_t SidDatabase::length(std::string_view md5, std::size_t song)
 
 std::int32_t SidDatabase::lengthMs(std::string_view md5, std::size_t song)
 {
+    if (m_index != nullptr)
+    {
+        libsidplayfp::songlengthIndex::key_t key;
+        std::uint32_t songs = 0;
+        const std::uint32_t *lengths = libsidplayfp::songlengthIndex::parseKey(md5, key)
+            ? m_index->find(key, songs) : nullptr;
+
+        // Same outcome as parsing the text entry
+        if (!lengths || song > songs)
+        {
+            errorString = ERR_DATABASE_CORRUPT;
+            return -1;
+        }
+
+        return song == 0 ? 0 : static_cast<std::int32_t>(lengths[song - 1]);
+    }
+
     if (m_parser == nullptr)
     {
         errorString = ERR_NO_DATABASE_LOADED;
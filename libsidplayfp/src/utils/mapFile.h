@@ -0,0 +1,104 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef MAPFILE_H
+#define MAPFILE_H
+
+#include <cstddef>
+#include <memory>
+
+#ifdef _WIN32
+#  include <fstream>
+#  include <iterator>
+#  include <vector>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+/*
+ * Header only, as it is shared by libsidplayfp,
+ * libresidfp and libstilview which don't link each other.
+ */
+
+namespace libsidplayfp
+{
+
+/**
+ * Get the contents of a file, read-only.
+ *
+ * The file is mapped where supported, so the pages are shared by all
+ * the processes mapping the same file, and read in memory elsewhere.
+ * Replace the file with a rename rather than rewriting it in place,
+ * the mapping keeps the old contents while it is alive.
+ * An empty file gives a valid pointer to a single null character.
+ *
+ * @param path the file
+ * @param size set to the size of the file
+ * @return the contents, nullptr if the file can't be read
+ */
+inline std::shared_ptr<const char> mapFile(const char* path, std::size_t &size)
+{
+#ifdef _WIN32
+    std::ifstream f(path, std::ios::in | std::ios::binary);
+    if (!f.is_open())
+        return nullptr;
+
+    auto data = std::make_shared<std::vector<char>>(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    size = data->size();
+    data->push_back('\0');
+    return std::shared_ptr<const char>(data, data->data());
+#else
+    const int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        return nullptr;
+    }
+
+    const std::size_t length = static_cast<std::size_t>(st.st_size);
+    if (length == 0)
+    {
+        // Nothing to map
+        ::close(fd);
+        size = 0;
+        return std::make_shared<char>('\0');
+    }
+
+    void* addr = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+        return nullptr;
+
+    size = length;
+    return std::shared_ptr<const char>(static_cast<const char*>(addr),
+        [length](const char* p) { munmap(const_cast<char*>(p), length); });
+#endif
+}
+
+}
+
+#endif // MAPFILE_H
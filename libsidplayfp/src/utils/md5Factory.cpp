@@ -38,7 +38,7 @@ namespace libsidplayfp
 std::unique_ptr<iMd5> md5Factory::get()
 {
 #ifdef GCRYPT_WITH_MD5
-    return std::make_unique<md5Gcrypt>()
+    return std::make_unique<md5Gcrypt>();
 #else
     return std::make_unique<md5Internal>();
 #endif
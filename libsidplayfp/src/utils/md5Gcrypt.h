@@ -38,18 +38,32 @@ class md5Gcrypt final : public iMd5
 private:
     gcry_md_hd_t hd;
 
+private:
+    /**
+     * Initialize the library, only once
+     * as it is not safe to do while other threads use it.
+     */
+    static bool init()
+    {
+        static const bool initialized = []
+        {
+            if (gcry_check_version(GCRYPT_VERSION) == 0)
+                return false;
+
+            // Disable secure memory.
+            if (gcry_control(GCRYCTL_DISABLE_SECMEM, 0) != 0)
+                return false;
+
+            // Tell Libgcrypt that initialization has completed.
+            return gcry_control(GCRYCTL_INITIALIZATION_FINISHED, 0) == 0;
+        }();
+        return initialized;
+    }
+
 public:
     md5Gcrypt()
     {
-        if (gcry_check_version(GCRYPT_VERSION) == 0)
-            throw md5Error();
-
-        // Disable secure memory.
-        if (gcry_control(GCRYCTL_DISABLE_SECMEM, 0) != 0)
-            throw md5Error();
-
-        // Tell Libgcrypt that initialization has completed.
-        if (gcry_control(GCRYCTL_INITIALIZATION_FINISHED, 0) != 0)
+        if (!init())
             throw md5Error();
 
         if (gcry_md_open(&hd, GCRY_MD_MD5, 0) != 0)
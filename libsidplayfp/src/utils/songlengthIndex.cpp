@@ -0,0 +1,266 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "songlengthIndex.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+
+#include "mapFile.h"
+
+namespace libsidplayfp
+{
+
+namespace
+{
+/// Bumped when the file layout changes
+constexpr std::uint32_t FILE_VERSION = 2;
+
+constexpr char MAGIC[8] = { 'S', 'L', 'D', 'B', 'i', 'n', 'd', 'x' };
+
+struct header_t
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint32_t entries;
+    std::uint32_t lengths;
+    std::uint64_t sourceSize;
+    std::int64_t sourceTime;
+};
+
+header_t makeHeader(std::uint32_t entries, std::uint32_t lengths, const songlengthIndex::source_t &src)
+{
+    header_t header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FILE_VERSION;
+    header.byteOrder = 0x01020304;
+    header.entries = entries;
+    header.lengths = lengths;
+    header.sourceSize = src.size;
+    header.sourceTime = src.time;
+    return header;
+}
+
+int hexDigit(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+/// The first 8 bytes of a digest as a number, keeping the sort order
+std::uint64_t prefix(const std::uint8_t *md5)
+{
+    std::uint64_t value = 0;
+    for (int i = 0; i < 8; i++)
+        value = (value << 8) | md5[i];
+    return value;
+}
+
+} // Anonymous namespace
+
+songlengthIndex::source_t songlengthIndex::source(const char *path)
+{
+    source_t src{};
+
+    std::error_code ec;
+    const std::uintmax_t size = std::filesystem::file_size(path, ec);
+    if (ec)
+        return src;
+
+    const std::filesystem::file_time_type time = std::filesystem::last_write_time(path, ec);
+    if (ec)
+        return src;
+
+    src.size = size;
+    src.time = static_cast<std::int64_t>(time.time_since_epoch().count());
+    return src;
+}
+
+bool songlengthIndex::parseKey(std::string_view md5, key_t &key)
+{
+    if (md5.size() != key.size() * 2)
+        return false;
+
+    for (std::size_t i = 0; i < key.size(); i++)
+    {
+        const int hi = hexDigit(md5[i * 2]);
+        const int lo = hexDigit(md5[i * 2 + 1]);
+        if (hi < 0 || lo < 0)
+            return false;
+        key[i] = static_cast<std::uint8_t>((hi << 4) | lo);
+    }
+
+    return true;
+}
+
+bool songlengthIndex::write(const char *path, std::vector<record_t> &records, const source_t &src)
+{
+    std::stable_sort(records.begin(), records.end(),
+        [](const record_t &a, const record_t &b) { return a.key < b.key; });
+    records.erase(std::unique(records.begin(), records.end(),
+        [](const record_t &a, const record_t &b) { return a.key == b.key; }), records.end());
+
+    std::vector<entry_t> entries;
+    entries.reserve(records.size());
+    std::vector<std::uint32_t> lengths;
+    for (const record_t &record : records)
+    {
+        entry_t entry;
+        std::memcpy(entry.md5, record.key.data(), sizeof(entry.md5));
+        entry.first = static_cast<std::uint32_t>(lengths.size());
+        entry.songs = static_cast<std::uint32_t>(record.lengths.size());
+        entries.push_back(entry);
+        lengths.insert(lengths.end(), record.lengths.begin(), record.lengths.end());
+    }
+
+    const header_t header = makeHeader(static_cast<std::uint32_t>(entries.size()),
+        static_cast<std::uint32_t>(lengths.size()), src);
+
+    // Write a temporary file and move it in place, so that processes
+    // mapping the old file keep it and no one sees a partial one
+    const std::string tmpPath = std::string(path) + ".tmp";
+
+    std::ofstream f(tmpPath, std::ios::out | std::ios::binary | std::ios::trunc);
+    f.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    f.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(entry_t));
+    f.write(reinterpret_cast<const char*>(lengths.data()), lengths.size() * sizeof(std::uint32_t));
+    f.close();
+
+    if (f.fail())
+    {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+
+#ifdef _WIN32
+    // rename doesn't replace existing files here
+    std::remove(path);
+#endif
+    if (std::rename(tmpPath.c_str(), path) != 0)
+    {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool songlengthIndex::open(const char *path, const source_t &src)
+{
+    close();
+
+    std::size_t size = 0;
+    std::shared_ptr<const char> file = mapFile(path, size);
+    if (!file || size < sizeof(header_t))
+        return false;
+
+    header_t header;
+    std::memcpy(&header, file.get(), sizeof(header_t));
+
+    const source_t built = { header.sourceSize, header.sourceTime };
+    const header_t expected = makeHeader(header.entries, header.lengths, built);
+    if (std::memcmp(&header, &expected, sizeof(header_t)) != 0)
+        return false;
+
+    if (src.size != 0 && (built.size != src.size || built.time != src.time))
+        return false;
+
+    if (size != sizeof(header_t)
+            + static_cast<std::size_t>(header.entries) * sizeof(entry_t)
+            + static_cast<std::size_t>(header.lengths) * sizeof(std::uint32_t))
+        return false;
+
+    m_entries = reinterpret_cast<const entry_t*>(file.get() + sizeof(header_t));
+    m_entryCount = header.entries;
+    m_lengths = reinterpret_cast<const std::uint32_t*>(m_entries + m_entryCount);
+    m_lengthCount = header.lengths;
+    m_file = std::move(file);
+    return true;
+}
+
+void songlengthIndex::close()
+{
+    m_file.reset();
+    m_entries = nullptr;
+    m_entryCount = 0;
+    m_lengths = nullptr;
+    m_lengthCount = 0;
+}
+
+const std::uint32_t *songlengthIndex::find(const key_t &key, std::uint32_t &songs) const
+{
+    const double target = static_cast<double>(prefix(key.data()));
+
+    // MD5 digests are evenly spread so interpolating between the keys
+    // just outside the range usually lands within a few entries,
+    // fall back to bisection if it does not
+    std::size_t lo = 0;
+    std::size_t hi = m_entryCount;
+    double loKey = 0.;
+    double hiKey = 18446744073709551616.;
+    int probes = 0;
+    while (lo < hi)
+    {
+        std::size_t mid = lo + (hi - lo) / 2;
+        if (probes < 8 && hi - lo > 8 && hiKey > loKey)
+        {
+            probes++;
+            const double pos = (target - loKey) / (hiKey - loKey);
+            mid = lo + std::min(static_cast<std::size_t>(std::max(pos, 0.) * (hi - lo)), hi - lo - 1);
+        }
+
+        const int cmp = std::memcmp(m_entries[mid].md5, key.data(), key.size());
+        if (cmp == 0)
+        {
+            const entry_t &entry = m_entries[mid];
+            if (entry.first > m_lengthCount || entry.songs > m_lengthCount - entry.first)
+                return nullptr;
+
+            songs = entry.songs;
+            return m_lengths + entry.first;
+        }
+
+        if (cmp < 0)
+        {
+            lo = mid + 1;
+            loKey = static_cast<double>(prefix(m_entries[mid].md5));
+        }
+        else
+        {
+            hi = mid;
+            hiKey = static_cast<double>(prefix(m_entries[mid].md5));
+        }
+    }
+
+    return nullptr;
+}
+
+}
@@ -0,0 +1,133 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef SONGLENGTHINDEX_H
+#define SONGLENGTHINDEX_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace libsidplayfp
+{
+
+/**
+ * Compiled songlength database.
+ *
+ * The file holds the MD5 digests of the tunes in binary form, sorted,
+ * each one pointing to the lengths of its subtunes in milliseconds.
+ * It is mapped read-only and looked up in place, so opening it costs
+ * next to nothing and lookups do not allocate.
+ * The data is stored in native byte order, the header tells
+ * a file built on a different platform apart.
+ * The size and modification time of the text database are stored
+ * too, to find out if the index is out of date.
+ */
+class songlengthIndex
+{
+public:
+    using key_t = std::array<std::uint8_t, 16>;
+
+    struct record_t
+    {
+        key_t key;
+        std::vector<std::uint32_t> lengths;
+    };
+
+    /// Identifies the version of a text database
+    struct source_t
+    {
+        std::uint64_t size;
+        std::int64_t time;
+    };
+
+public:
+    /**
+     * Get the size and modification time of a file.
+     *
+     * @return a zero size if the file cannot be read
+     */
+    static source_t source(const char *path);
+
+    /**
+     * Convert an MD5 hash from its text form.
+     *
+     * @return false if it is not made of 32 hex digits
+     */
+    static bool parseKey(std::string_view md5, key_t &key);
+
+    /**
+     * Write an index file.
+     * When a key appears more than once only the first record is kept.
+     * The file is written aside and renamed over the old one,
+     * which stays valid for the processes that have it open.
+     *
+     * @param path the index file
+     * @param records the tunes, sorted in place
+     * @param src the text database the records come from
+     * @return false on write errors
+     */
+    static bool write(const char *path, std::vector<record_t> &records, const source_t &src);
+
+    /**
+     * Map an index file.
+     *
+     * @param path the index file
+     * @param src the text database the index must have been built from,
+     *        a zero size to accept any
+     * @return false if the file is missing, stale or not an index
+     */
+    bool open(const char *path, const source_t &src = source_t());
+
+    void close();
+
+    /**
+     * Find the subtune lengths of a tune.
+     *
+     * @param key the MD5 digest
+     * @param songs set to the number of lengths
+     * @return the lengths in milliseconds, nullptr if the tune is not listed
+     */
+    const std::uint32_t *find(const key_t &key, std::uint32_t &songs) const;
+
+private:
+    struct entry_t
+    {
+        std::uint8_t md5[16];
+        std::uint32_t first;
+        std::uint32_t songs;
+    };
+
+private:
+    std::shared_ptr<const char> m_file;
+
+    const entry_t *m_entries = nullptr;
+    std::uint32_t m_entryCount = 0;
+
+    const std::uint32_t *m_lengths = nullptr;
+    std::uint32_t m_lengthCount = 0;
+};
+
+}
+
+#endif // SONGLENGTHINDEX_H
@@ -118,7 +118,7 @@ int main(int argc, char* argv[])
     // Configure the engine
     SidConfig cfg;
     cfg.frequency = SAMPLERATE;
-    cfg.samplingMethod = SidConfig::INTERPOLATE;
+    cfg.samplingMethod = SidConfig::SamplingMethod::Interpolate;
     cfg.fastSampling = false;
     cfg.playback = SidConfig::PlaybackMode::Mono;
     cfg.sidEmulation = rs.get();
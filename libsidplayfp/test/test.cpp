@@ -90,7 +90,7 @@ int main(int argc, char* argv[])
                     config.sidEmulation = new ReSIDfpBuilder("test");
                     config.sidEmulation->create(1);
                     config.forceSidModel = true;
-                    config.defaultSidModel = SidConfig::MOS6581;
+                    config.defaultSidModel = SidConfig::SIDModel::MOS6581;
                 }
                 else
                 if (!strcmp(&argv[i][0], "new"))
@@ -98,7 +98,7 @@ int main(int argc, char* argv[])
                     config.sidEmulation = new ReSIDfpBuilder("test");
                     config.sidEmulation->create(1);
                     config.forceSidModel = true;
-                    config.defaultSidModel = SidConfig::MOS8580;
+                    config.defaultSidModel = SidConfig::SIDModel::MOS8580;
                 }
             }
             if (!strcmp(&argv[i][1], "-cia"))
@@ -106,12 +106,12 @@ int main(int argc, char* argv[])
                 i++;
                 if (!strcmp(&argv[i][0], "old"))
                 {
-                    config.ciaModel = SidConfig::MOS6526;
+                    config.ciaModel = SidConfig::CIAModel::MOS6526;
                 }
                 else
                 if (!strcmp(&argv[i][0], "new"))
                 {
-                    config.ciaModel = SidConfig::MOS8521;
+                    config.ciaModel = SidConfig::CIAModel::MOS8521;
                 }
             }
         }
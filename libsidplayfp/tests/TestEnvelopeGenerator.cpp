@@ -128,3 +128,55 @@ TEST_CASE_METHOD(TestFixture, "Test flip 00 to FF", "[envelope-generator]")
 
     REQUIRE(int(generator.readENV()) == 0xff);
 }
+
+TEST_CASE("Test clocking blocks without output", "[envelope-generator]")
+{
+    reSIDfp::EnvelopeGenerator stepped;
+    reSIDfp::EnvelopeGenerator skipped;
+    stepped.reset();
+    skipped.reset();
+
+    struct write_t
+    {
+        unsigned int cycles;
+        int reg;
+        unsigned char value;
+    };
+
+    // 0 = control, 1 = attack/decay, 2 = sustain/release
+    const write_t script[] =
+    {
+        { 0, 1, 0x29 }, { 0, 2, 0xa4 }, { 3, 0, 0x01 },
+        { 40000, 0, 0x00 }, { 30000, 1, 0x00 }, { 5, 0, 0x01 },
+        { 700, 2, 0x30 }, { 10000, 1, 0x70 }, { 2, 0, 0x00 },
+        { 1, 0, 0x01 }, { 90000, 2, 0xf9 }, { 100, 0, 0x00 },
+        { 300000, 0, 0x01 }, { 1, 1, 0xff }, { 200000, 0, 0x00 },
+    };
+
+    for (const write_t &w : script)
+    {
+        // Uneven chunks, like the sync periods in SID::clockSilent
+        unsigned int cycles = w.cycles;
+        while (cycles > 0)
+        {
+            const unsigned int n = cycles < 4099 ? cycles : 4099;
+            for (unsigned int i = 0; i < n; i++)
+                stepped.clock();
+            skipped.clock(n);
+            cycles -= n;
+
+            REQUIRE(skipped.readENV() == stepped.readENV());
+            REQUIRE(skipped.lfsr == stepped.lfsr);
+        }
+
+        switch (w.reg)
+        {
+        case 0: stepped.writeCONTROL_REG(w.value); skipped.writeCONTROL_REG(w.value); break;
+        case 1: stepped.writeATTACK_DECAY(w.value); skipped.writeATTACK_DECAY(w.value); break;
+        case 2: stepped.writeSUSTAIN_RELEASE(w.value); skipped.writeSUSTAIN_RELEASE(w.value); break;
+        }
+    }
+
+    CHECK(skipped.envelope_counter == stepped.envelope_counter);
+    CHECK(skipped.exponential_counter == stepped.exponential_counter);
+}
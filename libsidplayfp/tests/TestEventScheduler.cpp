@@ -0,0 +1,216 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ *  Copyright (C) 2019 Leandro Nini
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <catch.hpp>
+
+#include <string>
+#include <vector>
+
+#include "../src/EventScheduler.h"
+#include "../src/Snapshot.h"
+
+using namespace libsidplayfp;
+
+namespace
+{
+class TestEvent final : public Event
+{
+public:
+    TestEvent(EventScheduler &scheduler, std::string &log, char id) :
+        Event("Test event"),
+        scheduler(scheduler),
+        log(log),
+        id(id) {}
+
+    void event() override
+    {
+        log += id;
+        log += std::to_string(scheduler.getTime(scheduler.phase()));
+        log += scheduler.phase() == EventPhase::ClockPHI1 ? 'a' : 'b';
+        log += ' ';
+    }
+
+private:
+    EventScheduler &scheduler;
+    std::string &log;
+    const char id;
+};
+
+/// Reschedules itself every cycle, like the CPU.
+class RepeatingEvent final : public Event
+{
+public:
+    RepeatingEvent(EventScheduler &scheduler, unsigned int period) :
+        Event("Repeating event"),
+        scheduler(scheduler),
+        period(period) {}
+
+    void event() override
+    {
+        count++;
+        scheduler.schedule(*this, period);
+    }
+
+    unsigned int count = 0;
+
+private:
+    EventScheduler &scheduler;
+    const unsigned int period;
+};
+} // Anonymous namespace
+
+TEST_CASE("Test event ordering", "[scheduler]")
+{
+    EventScheduler scheduler;
+    scheduler.reset();
+
+    std::string log;
+    TestEvent a(scheduler, log, 'A');
+    TestEvent b(scheduler, log, 'B');
+    TestEvent c(scheduler, log, 'C');
+    TestEvent d(scheduler, log, 'D');
+
+    scheduler.schedule(a, 3, EventPhase::ClockPHI2);
+    scheduler.schedule(b, 3, EventPhase::ClockPHI1);
+    scheduler.schedule(c, 1, EventPhase::ClockPHI2);
+    // Same time as a, fires after it
+    scheduler.schedule(d, 3, EventPhase::ClockPHI2);
+
+    for (int i = 0; i < 4; i++)
+        scheduler.clock();
+
+    CHECK(log == "C1b B3a A3b D3b ");
+}
+
+TEST_CASE("Test far events keep insertion order", "[scheduler]")
+{
+    EventScheduler scheduler;
+    scheduler.reset();
+
+    std::string log;
+    TestEvent a(scheduler, log, 'A');
+    TestEvent b(scheduler, log, 'B');
+    TestEvent c(scheduler, log, 'C');
+    RepeatingEvent cpu(scheduler, 1);
+
+    scheduler.schedule(cpu, 1, EventPhase::ClockPHI2);
+    scheduler.schedule(a, 100000, EventPhase::ClockPHI1);
+
+    // Schedule b for the same time as a, when it is near
+    while (scheduler.getTime(EventPhase::ClockPHI1) < 100000 - 10)
+        scheduler.clock();
+    scheduler.schedule(b, 100000 - scheduler.getTime(EventPhase::ClockPHI1), EventPhase::ClockPHI1);
+    scheduler.schedule(c, 50000, EventPhase::ClockPHI1);
+
+    while (log.size() < 16)
+        scheduler.clock();
+
+    CHECK(log == "A100000a B100000a ");
+    CHECK(cpu.count == 100000 - 1);
+}
+
+TEST_CASE("Test cancel", "[scheduler]")
+{
+    EventScheduler scheduler;
+    scheduler.reset();
+
+    std::string log;
+    TestEvent a(scheduler, log, 'A');
+    TestEvent b(scheduler, log, 'B');
+    TestEvent c(scheduler, log, 'C');
+
+    scheduler.schedule(a, 2);
+    scheduler.schedule(b, 2);
+    scheduler.schedule(c, 10000);
+
+    CHECK(scheduler.isPending(a));
+    CHECK(scheduler.isPending(b));
+    CHECK(scheduler.isPending(c));
+
+    scheduler.cancel(a);
+    scheduler.cancel(c);
+
+    CHECK_FALSE(scheduler.isPending(a));
+    CHECK(scheduler.isPending(b));
+    CHECK_FALSE(scheduler.isPending(c));
+
+    scheduler.clock();
+
+    CHECK(log == "B2a ");
+    CHECK_FALSE(scheduler.isPending(b));
+
+    scheduler.schedule(c, 1);
+    scheduler.reset();
+
+    CHECK_FALSE(scheduler.isPending(c));
+}
+
+TEST_CASE("Test snapshot", "[scheduler]")
+{
+    EventScheduler scheduler;
+    scheduler.reset();
+
+    std::string log;
+    TestEvent a(scheduler, log, 'A');
+    TestEvent b(scheduler, log, 'B');
+    TestEvent c(scheduler, log, 'C');
+    TestEvent d(scheduler, log, 'D');
+
+    scheduler.schedule(a, 3, EventPhase::ClockPHI2);
+    scheduler.schedule(b, 3, EventPhase::ClockPHI1);
+    scheduler.schedule(c, 100000);
+    scheduler.schedule(d, 3, EventPhase::ClockPHI2);
+    // b fires
+    scheduler.clock();
+
+    std::vector<uint8_t> state;
+    {
+        Snapshot s(state);
+        scheduler.serialize(s);
+        for (Event* e : { &a, &b, &c, &d })
+            scheduler.serialize(s, *e);
+        scheduler.commit(s);
+    }
+
+    // Run ahead, then go back to the saved point
+    scheduler.schedule(c, 1);
+    while (log.size() < 16)
+        scheduler.clock();
+    log.clear();
+
+    {
+        Snapshot s(state.data(), state.size());
+        scheduler.serialize(s);
+        for (Event* e : { &a, &b, &c, &d })
+            scheduler.serialize(s, *e);
+        scheduler.commit(s);
+        CHECK(s.good());
+        CHECK(s.atEnd());
+    }
+
+    CHECK(scheduler.getTime(EventPhase::ClockPHI1) == 3);
+    CHECK_FALSE(scheduler.isPending(b));
+    CHECK(scheduler.isPending(c));
+
+    for (int i = 0; i < 3; i++)
+        scheduler.clock();
+
+    CHECK(log == "A3b D3b C100000a ");
+}
@@ -0,0 +1,101 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ *  Copyright (C) 2019 Leandro Nini
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <catch.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../src/builders/residfp-builder/residfp/FilterModelConfig.h"
+#include "../src/builders/residfp-builder/residfp/FilterModelConfig8580.h"
+#include "../src/builders/residfp-builder/residfp/FilterTables.h"
+
+using namespace reSIDfp;
+
+namespace
+{
+constexpr char FILE_NAME[] = "TestFilterTables.tables";
+} // Anonymous namespace
+
+TEST_CASE("Test filter tables file", "[filter]")
+{
+    REQUIRE(FilterTables::save(FILE_NAME));
+
+    FilterTables::Data data6581;
+    FilterTables::Data data8580;
+    REQUIRE(FilterTables::open(FILE_NAME, data6581, data8580));
+
+    std::vector<std::uint16_t> expected6581(FilterModelConfig::TABLE_SIZE);
+    FilterModelConfig::buildTables(expected6581.data());
+    CHECK(std::equal(expected6581.begin(), expected6581.end(), data6581.get()));
+
+    std::vector<std::uint16_t> expected8580(FilterModelConfig8580::TABLE_SIZE);
+    FilterModelConfig8580::buildTables(expected8580.data());
+    CHECK(std::equal(expected8580.begin(), expected8580.end(), data8580.get()));
+
+    std::remove(FILE_NAME);
+}
+
+TEST_CASE("Test filter tables file mismatch", "[filter]")
+{
+    REQUIRE(FilterTables::save(FILE_NAME));
+
+    // Corrupt the version
+    {
+        std::fstream f(FILE_NAME, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(8);
+        f.put('\xff');
+    }
+
+    FilterTables::Data data6581;
+    FilterTables::Data data8580;
+    CHECK_FALSE(FilterTables::open(FILE_NAME, data6581, data8580));
+    CHECK_FALSE(FilterTables::load(FILE_NAME));
+
+    std::remove(FILE_NAME);
+    CHECK_FALSE(FilterTables::open(FILE_NAME, data6581, data8580));
+}
+
+TEST_CASE("Test filter tables file replaced while mapped", "[filter]")
+{
+    REQUIRE(FilterTables::save(FILE_NAME));
+
+    FilterTables::Data data6581;
+    FilterTables::Data data8580;
+    REQUIRE(FilterTables::open(FILE_NAME, data6581, data8580));
+
+    // The new file is moved in place, the mapped one is left untouched
+    REQUIRE(FilterTables::save(FILE_NAME));
+    CHECK_FALSE(std::ifstream(std::string(FILE_NAME) + ".tmp").is_open());
+
+    std::vector<std::uint16_t> expected6581(FilterModelConfig::TABLE_SIZE);
+    FilterModelConfig::buildTables(expected6581.data());
+    CHECK(std::equal(expected6581.begin(), expected6581.end(), data6581.get()));
+
+    FilterTables::Data reopened6581;
+    FilterTables::Data reopened8580;
+    CHECK(FilterTables::open(FILE_NAME, reopened6581, reopened8580));
+
+    std::remove(FILE_NAME);
+}
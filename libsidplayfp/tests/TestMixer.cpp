@@ -0,0 +1,136 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <catch.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "../src/mixer.h"
+#include "../src/sidemu.h"
+
+using namespace libsidplayfp;
+
+namespace
+{
+constexpr std::size_t FRAMES = 100;
+
+/**
+ * Produces the given samples in turn.
+ */
+class FakeChip final : public sidemu
+{
+public:
+    explicit FakeChip(const std::vector<int> &samples) :
+        sidemu(nullptr),
+        m_samples(samples)
+    {
+        m_buffer = new int[BUFFERSIZE];
+    }
+
+    ~FakeChip() override { delete[] m_buffer; }
+
+    void clock() override
+    {
+        for (std::size_t i = 0; i <= FRAMES * m_samples.size(); i++)
+            m_buffer[m_bufferpos++] = m_samples[i % m_samples.size()];
+    }
+
+    void reset(uint8_t) override {}
+    uint8_t read(uint_least8_t) override { return 0; }
+    void write(uint_least8_t, uint8_t) override {}
+    void voice(unsigned int, bool) override {}
+    void model(SidConfig::SIDModel, bool) override {}
+
+private:
+    const std::vector<int> m_samples;
+};
+
+template<typename T>
+std::vector<T> mix(const std::vector<std::vector<int>> &chips, bool stereo, int ff = 1)
+{
+    std::vector<std::unique_ptr<FakeChip>> fakes;
+
+    Mixer mixer;
+    for (const std::vector<int> &samples : chips)
+    {
+        fakes.emplace_back(new FakeChip(samples));
+        mixer.addSid(fakes.back().get());
+    }
+    mixer.setStereo(stereo);
+    mixer.setVolume(Mixer::VOLUME_MAX, Mixer::VOLUME_MAX);
+    REQUIRE(mixer.setFastForward(ff));
+
+    std::vector<T> out(FRAMES * (stereo ? 2 : 1));
+    mixer.begin(out.data(), out.size());
+    mixer.clockChips();
+    mixer.doMix();
+    REQUIRE_FALSE(mixer.notFinished());
+    return out;
+}
+} // Anonymous namespace
+
+TEST_CASE("Test float mono mix keeps the fraction", "[mixer]")
+{
+    const std::vector<float> out = mix<float>({ { 1 }, { 2 }, { 4 } }, false);
+
+    for (float s : out)
+        REQUIRE(s == Approx(7.f / 3.f / 32768.f));
+}
+
+TEST_CASE("Test float stereo mix keeps the fraction", "[mixer]")
+{
+    const std::vector<float> out = mix<float>({ { 1 }, { 2 }, { 4 } }, true);
+
+    const float c1 = 1.f / (1.f + 0.70710678f);
+    const float c2 = 0.70710678f / (1.f + 0.70710678f);
+    for (std::size_t i = 0; i < out.size(); i += 2)
+    {
+        REQUIRE(out[i] == Approx((c1 * 1 + c2 * 2) / 32768.f));
+        REQUIRE(out[i + 1] == Approx((c2 * 2 + c1 * 4) / 32768.f));
+    }
+}
+
+TEST_CASE("Test float fast forward average keeps the fraction", "[mixer]")
+{
+    const std::vector<float> out = mix<float>({ { 1, 2 } }, false, 2);
+
+    for (float s : out)
+        REQUIRE(s == Approx(1.5f / 32768.f));
+}
+
+TEST_CASE("Test float mix is not clipped", "[mixer]")
+{
+    const std::vector<float> out = mix<float>({ { 49152 } }, false);
+
+    for (float s : out)
+        REQUIRE(s == Approx(1.5f));
+}
+
+TEST_CASE("Test 16 bit mix is clipped and dithered", "[mixer]")
+{
+    const std::vector<short> out = mix<short>({ { 49152 }, { -1000 } }, false);
+
+    for (short s : out)
+        REQUIRE(s >= (32767 - 1000) / 2 - 1);
+    for (short s : out)
+        REQUIRE(s <= (32767 - 1000) / 2 + 1);
+}
@@ -20,11 +20,17 @@
 
 #include <catch.hpp>
 #include <sidplayfp/SidTune.h>
+#include <sidplayfp/SidTuneCache.h>
 #include <sidplayfp/SidTuneInfo.h>
 
 #include <array>
+#include <atomic>
 #include <cstdint>
+#include <cstdio>
 #include <cstring>
+#include <fstream>
+#include <thread>
+#include <vector>
 
 namespace
 {
@@ -342,3 +348,177 @@ TEST_CASE_METHOD(TestFixture, "Test Wrong Third SID Address Like Second", "[psid
 
     REQUIRE(tune.getInfo()->sidChipBase(2) == 0);
 }
+
+/*
+ * Tunes can be loaded and hashed from several threads at once.
+ */
+TEST_CASE_METHOD(TestFixture, "Test Concurrent Load", "[psid]")
+{
+    char expected[SidTune::MD5_LENGTH + 1];
+    char expectedNew[SidTune::MD5_LENGTH + 1];
+    {
+        SidTune tune(data.data(), BUFFERSIZE);
+        REQUIRE(tune.createMD5(expected) != nullptr);
+        REQUIRE(tune.createMD5New(expectedNew) != nullptr);
+    }
+
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&]
+        {
+            for (int i = 0; i < 200; i++)
+            {
+                SidTune tune(data.data(), BUFFERSIZE);
+                char md5[SidTune::MD5_LENGTH + 1];
+                char md5New[SidTune::MD5_LENGTH + 1];
+                if (!tune.getStatus()
+                        || tune.createMD5(md5) == nullptr || std::strcmp(md5, expected) != 0
+                        || tune.createMD5New(md5New) == nullptr || std::strcmp(md5New, expectedNew) != 0)
+                    failures++;
+            }
+        });
+    }
+    for (std::thread &thread : threads)
+        thread.join();
+
+    REQUIRE(failures == 0);
+}
+
+/*
+ * A tune loaded again is served from the cache,
+ * each copy keeps its own song selection.
+ */
+TEST_CASE_METHOD(TestFixture, "Test Cache Hit", "[psid]")
+{
+    data[SONGS_LO] = 0x03;
+
+    SidTuneCache cache(4);
+
+    SidTune tune1(nullptr);
+    tune1.setCache(&cache);
+    tune1.read(data.data(), BUFFERSIZE);
+    CHECK(tune1.getStatus());
+    CHECK(cache.misses() == 1);
+    CHECK(cache.hits() == 0);
+    CHECK(cache.size() == 1);
+
+    SidTune tune2(nullptr);
+    tune2.setCache(&cache);
+    tune2.read(data.data(), BUFFERSIZE);
+    CHECK(tune2.getStatus());
+    CHECK(cache.misses() == 1);
+    CHECK(cache.hits() == 1);
+
+    tune1.selectSong(2);
+    tune2.selectSong(3);
+    CHECK(tune1.getInfo()->currentSong() == 2);
+    CHECK(tune2.getInfo()->currentSong() == 3);
+
+    char md5[SidTune::MD5_LENGTH + 1];
+    char md5Cached[SidTune::MD5_LENGTH + 1];
+    REQUIRE(tune1.createMD5New(md5) != nullptr);
+    REQUIRE(tune2.createMD5New(md5Cached) != nullptr);
+    CHECK(std::strcmp(md5, md5Cached) == 0);
+    REQUIRE(tune1.c64Data() == tune2.c64Data());
+}
+
+/*
+ * Different data is a different tune.
+ */
+TEST_CASE_METHOD(TestFixture, "Test Cache Miss", "[psid]")
+{
+    SidTuneCache cache(4);
+
+    SidTune tune(nullptr);
+    tune.setCache(&cache);
+    tune.read(data.data(), BUFFERSIZE);
+
+    data[SONGS_LO] = 0x02;
+    tune.read(data.data(), BUFFERSIZE);
+    CHECK(tune.getStatus());
+    CHECK(tune.getInfo()->songs() == 2);
+
+    CHECK(cache.misses() == 2);
+    CHECK(cache.hits() == 0);
+    REQUIRE(cache.size() == 2);
+}
+
+/*
+ * The least recently used tune is dropped when the cache is full.
+ */
+TEST_CASE_METHOD(TestFixture, "Test Cache Eviction", "[psid]")
+{
+    SidTuneCache cache(2);
+
+    SidTune tune(nullptr);
+    tune.setCache(&cache);
+    for (std::uint8_t songs = 1; songs <= 3; songs++)
+    {
+        data[SONGS_LO] = songs;
+        tune.read(data.data(), BUFFERSIZE);
+    }
+    CHECK(cache.size() == 2);
+    CHECK(cache.misses() == 3);
+
+    data[SONGS_LO] = 0x03;
+    tune.read(data.data(), BUFFERSIZE);
+    CHECK(cache.hits() == 1);
+
+    data[SONGS_LO] = 0x01;
+    tune.read(data.data(), BUFFERSIZE);
+    REQUIRE(cache.misses() == 4);
+}
+
+/*
+ * Tunes loaded from files get the name of the file they come from.
+ */
+TEST_CASE_METHOD(TestFixture, "Test Cache File Name", "[psid]")
+{
+    const char* names[] = { "testcache1.sid", "testcache2.sid" };
+    for (const char* name : names)
+    {
+        std::ofstream f(name, std::ios::out | std::ios::binary | std::ios::trunc);
+        f.write(reinterpret_cast<const char*>(data.data()), BUFFERSIZE);
+    }
+
+    SidTuneCache cache;
+
+    SidTune tune1(nullptr);
+    tune1.setCache(&cache);
+    tune1.load(names[0]);
+
+    SidTune tune2(nullptr);
+    tune2.setCache(&cache);
+    tune2.load(names[1]);
+
+    for (const char* name : names)
+        std::remove(name);
+
+    CHECK(tune1.getStatus());
+    CHECK(tune2.getStatus());
+    CHECK(cache.hits() == 1);
+    CHECK(std::strcmp(tune1.getInfo()->dataFileName(), names[0]) == 0);
+    REQUIRE(std::strcmp(tune2.getInfo()->dataFileName(), names[1]) == 0);
+}
+
+/*
+ * Invalid tunes are not cached.
+ */
+TEST_CASE_METHOD(TestFixture, "Test Cache Invalid", "[psid]")
+{
+    data[VERSION_LO] = 0x01;
+
+    SidTuneCache cache;
+
+    SidTune tune(nullptr);
+    tune.setCache(&cache);
+    tune.read(data.data(), BUFFERSIZE);
+    CHECK(!tune.getStatus());
+    tune.read(data.data(), BUFFERSIZE);
+    CHECK(!tune.getStatus());
+
+    CHECK(cache.hits() == 0);
+    REQUIRE(cache.size() == 0);
+}
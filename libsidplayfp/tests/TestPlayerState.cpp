@@ -0,0 +1,444 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <catch.hpp>
+#include <sidplayfp/sidplayfp.h>
+#include <sidplayfp/SidConfig.h>
+#include <sidplayfp/SidTune.h>
+#include <sidplayfp/sidsink.h>
+#include <sidplayfp/builders/resid.h>
+#include <sidplayfp/builders/residfp.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+constexpr std::size_t HEADERSIZE = 0x7c;
+
+// PSID v4 loading at $1000 with room for three SIDs at $d400, $d420 and $d440
+const std::vector<std::uint8_t> header
+{
+    0x50, 0x53, 0x49, 0x44, // magicID
+    0x00, 0x04,             // version
+    0x00, 0x7C,             // dataOffset
+    0x10, 0x00,             // loadAddress
+    0x10, 0x00,             // initAddress
+    0x10, 0x03,             // playAddress
+    0x00, 0x01,             // songs
+    0x00, 0x01,             // startSong
+    0x00, 0x00, 0x00, 0x00, // speed
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // name
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // author
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // released
+    0x01, 0x54,             // flags, PAL and 6581 for all the SIDs
+    0x00,                   // startPage
+    0x00,                   // pageLength
+    0x00,                   // secondSIDAddress
+    0x00,                   // thirdSIDAddress
+};
+
+constexpr std::size_t SECONDSIDADDRESS = 122;
+constexpr std::size_t THIRDSIDADDRESS = 123;
+
+// Sets up the voices and the filter of each SID, then sweeps
+// the frequencies and the cutoff with the value read from OSC3
+const std::vector<std::uint8_t> code
+{
+    0x4c, 0x06, 0x10,       // $1000 jmp init
+    0x4c, 0x45, 0x10,       // $1003 jmp play
+    // init
+    0xa2, 0x00,             // ldx #$00
+    0xa9, 0x21, 0x9d, 0x05, 0xd4, // lda #$21, sta $d405,x
+    0xa9, 0xf4, 0x9d, 0x06, 0xd4, // lda #$f4, sta $d406,x
+    0xa9, 0x08, 0x9d, 0x03, 0xd4, // lda #$08, sta $d403,x
+    0xa9, 0x35, 0x9d, 0x0c, 0xd4, // lda #$35, sta $d40c,x
+    0xa9, 0xa8, 0x9d, 0x0d, 0xd4, // lda #$a8, sta $d40d,x
+    0xa9, 0x41, 0x9d, 0x04, 0xd4, // lda #$41, sta $d404,x
+    0xa9, 0x11, 0x9d, 0x0b, 0xd4, // lda #$11, sta $d40b,x
+    0xa9, 0x81, 0x9d, 0x12, 0xd4, // lda #$81, sta $d412,x
+    0xa9, 0xf2, 0x9d, 0x17, 0xd4, // lda #$f2, sta $d417,x
+    0xa9, 0x1f, 0x9d, 0x18, 0xd4, // lda #$1f, sta $d418,x
+    0x8a, 0x18, 0x69, 0x20, 0xaa, // txa, clc, adc #$20, tax
+    0xec, 0xf1, 0x10,       // cpx sids
+    0xd0, 0xc4,             // bne init+2
+    0x60,                   // rts
+    // play
+    0xee, 0xf0, 0x10,       // inc counter
+    0xa2, 0x00,             // ldx #$00
+    0xad, 0xf0, 0x10,       // lda counter
+    0x9d, 0x01, 0xd4,       // sta $d401,x
+    0x0a,                   // asl
+    0x9d, 0x08, 0xd4,       // sta $d408,x
+    0xbd, 0x1b, 0xd4,       // lda $d41b,x
+    0x9d, 0x00, 0xd4,       // sta $d400,x
+    0x9d, 0x16, 0xd4,       // sta $d416,x
+    0xad, 0xf0, 0x10,       // lda counter
+    0x4a, 0x4a, 0x4a,       // lsr, lsr, lsr
+    0x29, 0x01, 0x09, 0x40, // and #$01, ora #$40
+    0x9d, 0x04, 0xd4,       // sta $d404,x
+    0x8a, 0x18, 0x69, 0x20, 0xaa, // txa, clc, adc #$20, tax
+    0xec, 0xf1, 0x10,       // cpx sids
+    0xd0, 0xd6,             // bne play+5
+    0x60,                   // rts
+};
+
+// Plays a sawtooth on voice 1, the play routine
+// follows with the code of one of the tunes below
+#define INIT_VOICE \
+    0x4c, 0x06, 0x10,       /* $1000 jmp init */ \
+    0x4c, 0x1b, 0x10,       /* $1003 jmp play */ \
+    /* init */ \
+    0xa9, 0x10, 0x8d, 0x01, 0xd4, /* lda #$10, sta $d401 */ \
+    0xa9, 0xf0, 0x8d, 0x06, 0xd4, /* lda #$f0, sta $d406 */ \
+    0xa9, 0x21, 0x8d, 0x04, 0xd4, /* lda #$21, sta $d404 */ \
+    0xa9, 0x0f, 0x8d, 0x18, 0xd4, /* lda #$0f, sta $d418 */ \
+    0x60                    /* rts */
+
+// Changes the frequency with the counter, starts over every 256 calls
+const std::vector<std::uint8_t> loopCode
+{
+    INIT_VOICE,
+    // play
+    0xee, 0xf0, 0x10,       // inc counter
+    0xad, 0xf0, 0x10,       // lda counter
+    0x29, 0x3f, 0x09, 0x08, // and #$3f, ora #$08
+    0x8d, 0x01, 0xd4,       // sta $d401
+    0x60,                   // rts
+};
+
+// Sets the volume to zero after 64 calls,
+// a 16 bit counter keeps the state changing
+const std::vector<std::uint8_t> silenceCode
+{
+    INIT_VOICE,
+    // play
+    0xee, 0xf0, 0x10,       // inc counter
+    0xd0, 0x03,             // bne +3
+    0xee, 0xef, 0x10,       // inc counter+1
+    0xad, 0xef, 0x10,       // lda counter+1
+    0xd0, 0x08,             // bne silence
+    0xad, 0xf0, 0x10,       // lda counter
+    0xc9, 0x40,             // cmp #$40
+    0xb0, 0x01,             // bcs silence
+    0x60,                   // rts
+    // silence
+    0xa9, 0x00, 0x8d, 0x18, 0xd4, // lda #$00, sta $d418
+    0x60,                   // rts
+};
+
+// Jams the CPU on the 100th call
+const std::vector<std::uint8_t> jamCode
+{
+    INIT_VOICE,
+    // play
+    0xee, 0xf0, 0x10,       // inc counter
+    0xad, 0xf0, 0x10,       // lda counter
+    0xc9, 0x64,             // cmp #100
+    0xd0, 0x01,             // bne +1
+    0x02,                   // jam
+    0x60,                   // rts
+};
+
+#undef INIT_VOICE
+
+// The counter is at $10f0, followed by the number of SIDs times $20
+constexpr std::size_t SIDS = 0xf1;
+
+std::vector<std::uint8_t> makeTune(unsigned int sids, const std::vector<std::uint8_t> &program = code)
+{
+    std::vector<std::uint8_t> tune(header);
+    tune.insert(tune.end(), program.begin(), program.end());
+    tune.resize(HEADERSIZE + SIDS + 1, 0);
+    tune[HEADERSIZE + SIDS] = static_cast<std::uint8_t>(sids * 0x20);
+    if (sids > 1)
+        tune[SECONDSIDADDRESS] = 0x42;
+    if (sids > 2)
+        tune[THIRDSIDADDRESS] = 0x44;
+    return tune;
+}
+
+std::vector<short> play(sidplayfp &engine, std::size_t count)
+{
+    std::vector<short> out(count);
+    REQUIRE(engine.play(out.data(), count) == count);
+    return out;
+}
+
+/*
+ * Play, save, play, restore and play again,
+ * the two renders after the save must be identical.
+ */
+void testRestore(sidbuilder &builder, unsigned int sids)
+{
+    builder.create(sids);
+    REQUIRE(builder.getStatus());
+
+    const std::vector<std::uint8_t> data = makeTune(sids);
+    SidTune tune(data.data(), static_cast<uint_least32_t>(data.size()));
+    REQUIRE(tune.getStatus());
+    tune.selectSong(0);
+
+    sidplayfp engine;
+    SidConfig config = engine.config();
+    config.sidEmulation = &builder;
+    config.frequency = 48000;
+    REQUIRE(engine.config(config));
+    REQUIRE(engine.load(&tune));
+
+    // About 300 ms, then 200 ms
+    play(engine, 14411);
+
+    std::vector<std::uint8_t> state;
+    REQUIRE(engine.saveState(state));
+
+    const std::vector<short> first = play(engine, 9601);
+    REQUIRE(std::any_of(first.begin(), first.end(), [](short s) { return s != 0; }));
+
+    REQUIRE(engine.loadState(state.data(), state.size()));
+
+    const std::vector<short> second = play(engine, 9601);
+    REQUIRE(first == second);
+}
+
+/*
+ * Play a tune after another one on the same engine, which keeps
+ * the chips, the output must match the one of a fresh engine.
+ */
+template<class T>
+void testSwitch()
+{
+    const std::vector<std::uint8_t> dataA = makeTune(1);
+    SidTune tuneA(dataA.data(), static_cast<uint_least32_t>(dataA.size()));
+    REQUIRE(tuneA.getStatus());
+
+    const std::vector<std::uint8_t> dataB = makeTune(1, loopCode);
+    SidTune tuneB(dataB.data(), static_cast<uint_least32_t>(dataB.size()));
+    REQUIRE(tuneB.getStatus());
+
+    std::vector<short> switched;
+    {
+        T builder("test");
+        builder.create(1);
+        REQUIRE(builder.getStatus());
+
+        sidplayfp engine;
+        SidConfig config = engine.config();
+        config.sidEmulation = &builder;
+        config.frequency = 48000;
+        config.powerOnDelay = 0;
+        REQUIRE(engine.config(config));
+
+        // Leave the filter, the envelopes and the resampler busy
+        REQUIRE(engine.load(&tuneA));
+        play(engine, 14411);
+
+        REQUIRE(engine.load(&tuneB));
+        switched = play(engine, 9601);
+    }
+
+    std::vector<short> fresh;
+    {
+        T builder("test");
+        builder.create(1);
+        REQUIRE(builder.getStatus());
+
+        sidplayfp engine;
+        SidConfig config = engine.config();
+        config.sidEmulation = &builder;
+        config.frequency = 48000;
+        config.powerOnDelay = 0;
+        REQUIRE(engine.config(config));
+
+        REQUIRE(engine.load(&tuneB));
+        fresh = play(engine, 9601);
+    }
+
+    REQUIRE(std::any_of(fresh.begin(), fresh.end(), [](short s) { return s != 0; }));
+    REQUIRE(switched == fresh);
+}
+
+int_least32_t estimate(const std::vector<std::uint8_t> &program, uint_least32_t maxLengthMs)
+{
+    ReSIDfpBuilder builder("test");
+    builder.create(1);
+    REQUIRE(builder.getStatus());
+
+    const std::vector<std::uint8_t> data = makeTune(1, program);
+    SidTune tune(data.data(), static_cast<uint_least32_t>(data.size()));
+    REQUIRE(tune.getStatus());
+
+    sidplayfp engine;
+    SidConfig config = engine.config();
+    config.sidEmulation = &builder;
+    config.powerOnDelay = 0;
+    REQUIRE(engine.config(config));
+
+    return engine.estimateLength(&tune, 0, maxLengthMs, 1000);
+}
+
+/**
+ * Takes the given number of blocks, then stops the render.
+ */
+class countingSink : public sidsink
+{
+public:
+    explicit countingSink(unsigned int blocks) : m_blocks(blocks) {}
+
+    bool write(const short*, std::size_t count) override
+    {
+        samples += count;
+        return --m_blocks != 0;
+    }
+
+    std::size_t samples = 0;
+
+private:
+    unsigned int m_blocks;
+};
+
+struct renderer_t
+{
+    ReSIDfpBuilder builder{"test"};
+    sidplayfp engine;
+
+    renderer_t()
+    {
+        builder.create(1);
+        REQUIRE(builder.getStatus());
+
+        SidConfig config = engine.config();
+        config.sidEmulation = &builder;
+        config.frequency = 48000;
+        config.powerOnDelay = 0;
+        REQUIRE(engine.config(config));
+    }
+};
+} // Anonymous namespace
+
+TEST_CASE("Test state restore ReSIDfp single SID", "[player]")
+{
+    ReSIDfpBuilder builder("test");
+    testRestore(builder, 1);
+}
+
+TEST_CASE("Test state restore ReSIDfp three SIDs", "[player]")
+{
+    ReSIDfpBuilder builder("test");
+    testRestore(builder, 3);
+}
+
+TEST_CASE("Test state restore ReSID single SID", "[player]")
+{
+    ReSIDBuilder builder("test");
+    testRestore(builder, 1);
+}
+
+TEST_CASE("Test state restore ReSID three SIDs", "[player]")
+{
+    ReSIDBuilder builder("test");
+    testRestore(builder, 3);
+}
+
+TEST_CASE("Test tune switch ReSIDfp", "[player]")
+{
+    testSwitch<ReSIDfpBuilder>();
+}
+
+TEST_CASE("Test tune switch ReSID", "[player]")
+{
+    testSwitch<ReSIDBuilder>();
+}
+
+TEST_CASE("Test length estimate of a looping tune", "[player]")
+{
+    // 256 calls of the play routine at 50 Hz
+    REQUIRE(estimate(loopCode, 60000) == Approx(5127).margin(20));
+}
+
+TEST_CASE("Test length estimate of a tune going silent", "[player]")
+{
+    // 64 calls of the play routine at 50 Hz
+    REQUIRE(estimate(silenceCode, 60000) == Approx(1277).margin(20));
+}
+
+TEST_CASE("Test length estimate of a jamming tune", "[player]")
+{
+    // 100 calls of the play routine at 50 Hz
+    REQUIRE(estimate(jamCode, 60000) == Approx(1975).margin(20));
+}
+
+TEST_CASE("Test length estimate without an end", "[player]")
+{
+    REQUIRE(estimate(loopCode, 3000) == 0);
+}
+
+TEST_CASE("Test render reports a CPU halt after a partial render", "[player]")
+{
+    const std::vector<std::uint8_t> jamData = makeTune(1, jamCode);
+    SidTune jamTune(jamData.data(), static_cast<uint_least32_t>(jamData.size()));
+    REQUIRE(jamTune.getStatus());
+
+    const std::vector<std::uint8_t> loopData = makeTune(1, loopCode);
+    SidTune loopTune(loopData.data(), static_cast<uint_least32_t>(loopData.size()));
+    REQUIRE(loopTune.getStatus());
+
+    renderer_t r;
+    std::vector<short> buffer(48000 * 3);
+    std::size_t rendered = 0;
+
+    // The tune jams after about two seconds
+    REQUIRE_FALSE(r.engine.renderToBuffer(&jamTune, 0, 3000, buffer.data(), buffer.size(), rendered));
+    REQUIRE(rendered > 0);
+    REQUIRE(rendered < buffer.size());
+    REQUIRE(std::strcmp(r.engine.error(), "Illegal instruction executed") == 0);
+
+    // The sink gets the samples up to the halt
+    countingSink sink(1000);
+    std::size_t delivered = 0;
+    REQUIRE_FALSE(r.engine.renderToSink(&jamTune, 0, 3000, sink, delivered, 1000));
+    REQUIRE(delivered == rendered);
+    REQUIRE(sink.samples == rendered);
+
+    // The next render doesn't see the old error
+    REQUIRE(r.engine.renderToBuffer(&loopTune, 0, 1000, buffer.data(), buffer.size(), rendered));
+    REQUIRE(rendered == 48000);
+    REQUIRE(std::strcmp(r.engine.error(), "Illegal instruction executed") != 0);
+}
+
+TEST_CASE("Test render stopped by the sink succeeds", "[player]")
+{
+    const std::vector<std::uint8_t> data = makeTune(1, loopCode);
+    SidTune tune(data.data(), static_cast<uint_least32_t>(data.size()));
+    REQUIRE(tune.getStatus());
+
+    renderer_t r;
+    countingSink sink(2);
+    std::size_t rendered = 0;
+
+    REQUIRE(r.engine.renderToSink(&tune, 0, 1000, sink, rendered, 1000));
+    REQUIRE(rendered == 2000);
+    REQUIRE(sink.samples == 2000);
+}
@@ -0,0 +1,190 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * Copyright 2011-2019 Leandro Nini <drfiemost@users.sourceforge.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <catch.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#include "../src/EventScheduler.h"
+#include "../src/builders/residfp-builder/residfp-emu.h"
+
+using namespace libsidplayfp;
+
+namespace
+{
+constexpr float CLOCK = 985248.f;
+constexpr float FREQUENCY = 48000.f;
+
+enum class op_t
+{
+    WRITE,
+    READ,
+    CLOCK   // end of a mixer slice
+};
+
+struct access_t
+{
+    unsigned int cycles;    // cycles to run before the access
+    op_t op;
+    unsigned char addr = 0;
+    unsigned char value = 0;
+};
+
+// Reads of OSC3, ENV3 and of the write-only registers,
+// some of them in a slice following one without reads
+const std::vector<access_t> script
+{
+    { 0, op_t::WRITE, 0x18, 0x0f }, { 0, op_t::WRITE, 0x13, 0x29 }, { 0, op_t::WRITE, 0x14, 0x8a },
+    { 0, op_t::WRITE, 0x0e, 0x23 }, { 0, op_t::WRITE, 0x0f, 0x41 }, { 0, op_t::WRITE, 0x12, 0x21 },
+    { 5, op_t::READ, 0x00 }, { 9, op_t::READ, 0x1b }, { 1, op_t::READ, 0x1c }, { 3, op_t::READ, 0x05 },
+    { 700, op_t::READ, 0x1b }, { 2, op_t::READ, 0x1d }, { 2, op_t::READ, 0x12 },
+    { 200, op_t::CLOCK },
+    // slice with reads, write-only register read before and after writes
+    { 1000, op_t::READ, 0x1c }, { 3, op_t::READ, 0x04 }, { 17, op_t::WRITE, 0x0f, 0x07 },
+    { 4, op_t::READ, 0x0f }, { 40, op_t::READ, 0x1b }, { 1, op_t::READ, 0x19 }, { 1, op_t::READ, 0x1a },
+    { 1, op_t::READ, 0x1b },
+    { 50, op_t::CLOCK },
+    // slice without reads, the bus value left by the OSC3 read must survive
+    { 930, op_t::CLOCK },
+    { 20, op_t::READ, 0x00 }, { 10, op_t::READ, 0x1b }, { 10, op_t::READ, 0x1f },
+    { 10, op_t::WRITE, 0x12, 0x81 },
+    { 500, op_t::CLOCK },
+    // release, reads across several slices
+    { 100, op_t::WRITE, 0x12, 0x80 }, { 2000, op_t::READ, 0x1c }, { 20, op_t::READ, 0x1e },
+    { 2000, op_t::CLOCK }, { 100, op_t::READ, 0x1c }, { 1, op_t::READ, 0x02 },
+    { 3000, op_t::CLOCK }, { 3000, op_t::CLOCK },
+    { 10, op_t::READ, 0x1b }, { 1, op_t::READ, 0x1c }, { 6000, op_t::READ, 0x03 },
+    { 100, op_t::CLOCK },
+    // the bus value decays
+    { 20000, op_t::READ, 0x00 }, { 1, op_t::READ, 0x1b }, { 40000, op_t::READ, 0x00 },
+    { 10, op_t::CLOCK },
+    { 150000, op_t::READ, 0x01 }, { 10, op_t::CLOCK },
+    { 190000, op_t::CLOCK }, { 190000, op_t::CLOCK }, { 190000, op_t::READ, 0x01 },
+};
+
+class Tick final : public Event
+{
+public:
+    Tick() : Event("Tick") {}
+
+    void event() override {}
+};
+
+void advance(EventScheduler &scheduler, unsigned int cycles)
+{
+    if (cycles == 0)
+        return;
+
+    Tick tick;
+    scheduler.schedule(tick, cycles, EventPhase::ClockPHI1);
+    scheduler.clock();
+}
+
+std::vector<unsigned char> emuReads(SidConfig::SIDModel model, bool defer)
+{
+    EventScheduler scheduler;
+    scheduler.reset();
+
+    ReSIDfp emu(nullptr);
+    emu.lock(&scheduler);
+    emu.model(model, false);
+    emu.sampling(CLOCK, FREQUENCY, SidConfig::SamplingMethod::ResampleInterpolate, false);
+    emu.reset(0);
+    emu.deferWrites(defer);
+
+    std::vector<unsigned char> reads;
+    for (const access_t &a : script)
+    {
+        // Slices are short enough for the chip buffer
+        advance(scheduler, a.cycles);
+        switch (a.op)
+        {
+        case op_t::WRITE:
+            emu.write(a.addr, a.value);
+            break;
+        case op_t::READ:
+            reads.push_back(emu.read(a.addr));
+            break;
+        case op_t::CLOCK:
+            emu.clock();
+            emu.bufferpos(0);
+            break;
+        }
+    }
+
+    emu.unlock();
+    return reads;
+}
+
+std::vector<unsigned char> directReads(reSIDfp::ChipModel model)
+{
+    reSIDfp::SID sid;
+    sid.setChipModel(model);
+    sid.setSamplingParameters(CLOCK, reSIDfp::RESAMPLE, FREQUENCY, 20000.);
+    sid.reset();
+    sid.write(0x18, 0);
+
+    std::vector<unsigned char> reads;
+    std::vector<short> buf(65536);
+    for (const access_t &a : script)
+    {
+        unsigned int cycles = a.cycles;
+        while (cycles > 0)
+        {
+            const unsigned int n = std::min(cycles, 100000u);
+            sid.clock(n, buf.data());
+            cycles -= n;
+        }
+
+        switch (a.op)
+        {
+        case op_t::WRITE:
+            sid.write(a.addr, a.value);
+            break;
+        case op_t::READ:
+            reads.push_back(sid.read(a.addr));
+            break;
+        case op_t::CLOCK:
+            break;
+        }
+    }
+
+    return reads;
+}
+
+void testReads(SidConfig::SIDModel model, reSIDfp::ChipModel chipModel)
+{
+    const std::vector<unsigned char> expected = directReads(chipModel);
+
+    REQUIRE(emuReads(model, true) == expected);
+    REQUIRE(emuReads(model, false) == expected);
+}
+} // Anonymous namespace
+
+TEST_CASE("Test emu reads 6581", "[residfp-emu]")
+{
+    testReads(SidConfig::SIDModel::MOS6581, reSIDfp::MOS6581);
+}
+
+TEST_CASE("Test emu reads 8580", "[residfp-emu]")
+{
+    testReads(SidConfig::SIDModel::MOS8580, reSIDfp::MOS8580);
+}
@@ -0,0 +1,304 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ *  Copyright (C) 2019 Leandro Nini
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <catch.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#include "../src/builders/residfp-builder/residfp/SID.h"
+
+namespace
+{
+constexpr double CLOCK = 985248.;
+
+struct write_t
+{
+    unsigned int cycles;    // cycles to run before the write
+    unsigned char addr;
+    unsigned char value;
+};
+
+// Exercises ring modulation, hard sync, noise, test bit,
+// combined waveforms and the filter.
+const std::vector<write_t> script
+{
+    { 0, 0x18, 0x1f }, { 0, 0x17, 0xf7 }, { 0, 0x15, 0x03 }, { 0, 0x16, 0x40 },
+    { 0, 0x05, 0x09 }, { 0, 0x06, 0xf0 }, { 0, 0x0c, 0x22 }, { 0, 0x0d, 0xa8 },
+    { 0, 0x13, 0x00 }, { 0, 0x14, 0xf0 },
+    { 0, 0x00, 0x34 }, { 0, 0x01, 0x12 }, { 0, 0x07, 0x00 }, { 0, 0x08, 0x05 },
+    { 0, 0x0e, 0x45 }, { 0, 0x0f, 0x31 }, { 0, 0x02, 0x00 }, { 0, 0x03, 0x08 },
+    // sawtooth, pulse, triangle
+    { 7, 0x04, 0x21 }, { 3, 0x0b, 0x41 }, { 5, 0x12, 0x11 },
+    // ring modulated triangles
+    { 20000, 0x04, 0x15 }, { 11, 0x12, 0x15 },
+    { 20000, 0x0b, 0x15 }, { 3, 0x01, 0x2e },
+    // hard sync
+    { 20000, 0x0b, 0x23 }, { 5, 0x12, 0x43 },
+    // noise and test bit
+    { 20000, 0x04, 0x81 }, { 17, 0x0b, 0x89 }, { 300, 0x0b, 0x81 },
+    // combined waveforms
+    { 20000, 0x04, 0x31 }, { 9, 0x0b, 0x61 }, { 13, 0x12, 0x71 },
+    { 20000, 0x04, 0x91 }, { 20000, 0x04, 0x51 },
+    // release
+    { 20000, 0x04, 0x20 }, { 1, 0x0b, 0x40 }, { 1, 0x12, 0x10 },
+    { 30000, 0x18, 0x6f },
+};
+
+template<typename T = short>
+std::vector<T> render(reSIDfp::ChipModel model, bool block)
+{
+    reSIDfp::SID sid;
+    sid.setChipModel(model);
+    sid.setSamplingParameters(CLOCK, reSIDfp::RESAMPLE, 48000., 20000.);
+    sid.reset();
+    sid.enableBlockClocking(block);
+
+    std::vector<T> out;
+    T buf[8192];
+    for (const write_t &w : script)
+    {
+        // Split in uneven chunks like the player does
+        unsigned int cycles = w.cycles;
+        while (cycles > 0)
+        {
+            const unsigned int n = cycles < 1237 ? cycles : 1237;
+            const int samples = sid.clock(n, buf);
+            out.insert(out.end(), buf, buf + samples);
+            cycles -= n;
+        }
+        sid.write(w.addr, w.value);
+    }
+
+    return out;
+}
+
+// Renders the script producing the voice outputs too,
+// the voice buffers are appended to voiceOut.
+std::vector<int> renderVoices(reSIDfp::ChipModel model, bool block, std::vector<int> (&voiceOut)[3])
+{
+    reSIDfp::SID sid;
+    sid.setChipModel(model);
+    sid.setSamplingParameters(CLOCK, reSIDfp::RESAMPLE, 48000., 20000.);
+    sid.reset();
+    sid.enableBlockClocking(block);
+    sid.enableVoiceOutputs(true);
+
+    std::vector<int> out;
+    int buf[8192];
+    int voiceBuf[3][8192];
+    int* const voicePtr[3] = { voiceBuf[0], voiceBuf[1], voiceBuf[2] };
+    for (const write_t &w : script)
+    {
+        unsigned int cycles = w.cycles;
+        while (cycles > 0)
+        {
+            const unsigned int n = cycles < 1237 ? cycles : 1237;
+            const int samples = sid.clock(n, buf, voicePtr);
+            out.insert(out.end(), buf, buf + samples);
+            for (int v = 0; v < 3; v++)
+                voiceOut[v].insert(voiceOut[v].end(), voiceBuf[v], voiceBuf[v] + samples);
+            cycles -= n;
+        }
+        sid.write(w.addr, w.value);
+    }
+
+    return out;
+}
+
+// Clocks a full and a silent chip side by side and reads back
+// bus value, OSC3 and ENV3 from both at every write.
+// The silent chip copies the full one's state at the given write,
+// and then also clocks all the envelopes.
+bool silentMatches(reSIDfp::ChipModel model, std::size_t start)
+{
+    reSIDfp::SID sid;
+    sid.setChipModel(model);
+    sid.setSamplingParameters(CLOCK, reSIDfp::RESAMPLE, 48000., 20000.);
+    sid.reset();
+
+    reSIDfp::SID silent;
+    silent.setChipModel(model);
+    silent.reset();
+
+    short buf[8192];
+    for (std::size_t i = 0; i < script.size(); i++)
+    {
+        const write_t &w = script[i];
+        if (i == start)
+            silent.copyVoiceState(sid);
+
+        unsigned int cycles = w.cycles;
+        while (cycles > 0)
+        {
+            const unsigned int n = cycles < 97 ? cycles : 97;
+            sid.clock(n, buf);
+            silent.clockSilent(n, start != 0);
+            cycles -= n;
+
+            if (i < start)
+                continue;
+
+            for (int reg : { 0x1b, 0x1c, 0x00 })
+            {
+                if (sid.read(reg) != silent.read(reg))
+                    return false;
+            }
+        }
+        sid.write(w.addr, w.value);
+        silent.write(w.addr, w.value);
+    }
+
+    return true;
+}
+
+// Saves the state a third of the way into the wait before the given write,
+// plays the rest, then restores the state into another chip
+// and plays the rest again.
+bool restoreMatches(reSIDfp::ChipModel model, std::size_t start)
+{
+    reSIDfp::SID sid;
+    sid.setChipModel(model);
+    sid.setSamplingParameters(CLOCK, reSIDfp::RESAMPLE, 48000., 20000.);
+    sid.reset();
+
+    reSIDfp::SID restored;
+    restored.setChipModel(model);
+    restored.setSamplingParameters(CLOCK, reSIDfp::RESAMPLE, 48000., 20000.);
+    restored.reset();
+
+    std::vector<unsigned char> state;
+    std::vector<short> expected;
+    std::vector<short> out;
+    short buf[8192];
+
+    for (std::size_t i = 0; i < script.size(); i++)
+    {
+        const write_t &w = script[i];
+        if (i == start)
+        {
+            sid.clock(w.cycles / 3, buf);
+            sid.saveState(state);
+        }
+
+        const unsigned int cycles = i == start ? w.cycles - w.cycles / 3 : w.cycles;
+        if (i >= start)
+        {
+            const int samples = sid.clock(cycles, buf);
+            expected.insert(expected.end(), buf, buf + samples);
+        }
+        else
+        {
+            sid.clock(cycles, buf);
+        }
+        sid.write(w.addr, w.value);
+    }
+
+    if (!restored.loadState(state.data(), state.size()))
+        return false;
+
+    for (std::size_t i = start; i < script.size(); i++)
+    {
+        const write_t &w = script[i];
+        const unsigned int cycles = i == start ? w.cycles - w.cycles / 3 : w.cycles;
+        const int samples = restored.clock(cycles, buf);
+        out.insert(out.end(), buf, buf + samples);
+        restored.write(w.addr, w.value);
+    }
+
+    return !expected.empty() && out == expected;
+}
+} // Anonymous namespace
+
+TEST_CASE("Test block clocking 6581", "[sid]")
+{
+    const std::vector<short> expected = render(reSIDfp::MOS6581, false);
+
+    REQUIRE(expected.size() > 5000);
+    CHECK(render(reSIDfp::MOS6581, true) == expected);
+}
+
+TEST_CASE("Test block clocking 8580", "[sid]")
+{
+    const std::vector<short> expected = render(reSIDfp::MOS8580, false);
+
+    REQUIRE(expected.size() > 5000);
+    CHECK(render(reSIDfp::MOS8580, true) == expected);
+}
+
+TEST_CASE("Test wide output", "[sid]")
+{
+    for (reSIDfp::ChipModel model : { reSIDfp::MOS6581, reSIDfp::MOS8580 })
+    {
+        const std::vector<short> expected = render(model, true);
+        const std::vector<int> wide = render<int>(model, true);
+
+        REQUIRE(wide.size() == expected.size());
+
+        std::vector<short> clipped;
+        for (int sample : wide)
+            clipped.push_back(static_cast<short>(std::clamp(sample, -32768, 32767)));
+        CHECK(clipped == expected);
+    }
+}
+
+TEST_CASE("Test voice outputs", "[sid]")
+{
+    for (reSIDfp::ChipModel model : { reSIDfp::MOS6581, reSIDfp::MOS8580 })
+    {
+        const std::vector<int> expected = render<int>(model, true);
+
+        std::vector<int> block[3];
+        std::vector<int> cycles[3];
+        CHECK(renderVoices(model, true, block) == expected);
+        CHECK(renderVoices(model, false, cycles) == expected);
+
+        for (int v = 0; v < 3; v++)
+        {
+            REQUIRE(block[v].size() == expected.size());
+            CHECK(block[v] == cycles[v]);
+            CHECK(std::any_of(block[v].begin(), block[v].end(), [](int s) { return s > 1000; }));
+        }
+    }
+}
+
+TEST_CASE("Test state restore 6581", "[sid]")
+{
+    CHECK(restoreMatches(reSIDfp::MOS6581, 23));
+    CHECK(restoreMatches(reSIDfp::MOS6581, 27));
+}
+
+TEST_CASE("Test state restore 8580", "[sid]")
+{
+    CHECK(restoreMatches(reSIDfp::MOS8580, 23));
+    CHECK(restoreMatches(reSIDfp::MOS8580, 27));
+}
+
+TEST_CASE("Test silent clocking 6581", "[sid]")
+{
+    CHECK(silentMatches(reSIDfp::MOS6581, 0));
+    CHECK(silentMatches(reSIDfp::MOS6581, 27));
+}
+
+TEST_CASE("Test silent clocking 8580", "[sid]")
+{
+    CHECK(silentMatches(reSIDfp::MOS8580, 0));
+    CHECK(silentMatches(reSIDfp::MOS8580, 27));
+}
@@ -0,0 +1,199 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ *  Copyright (C) 2019 Leandro Nini
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <catch.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <sidplayfp/SidDatabase.h>
+
+namespace
+{
+constexpr char DB_NAME[] = "TestSidDatabase.md5";
+constexpr char INDEX_NAME[] = "TestSidDatabase.md5.idx";
+
+constexpr const char* KEYS[] =
+{
+    "00000000000000000000000000000000",
+    "0123456789abcdef0123456789abcdef",
+    "7f000000000000000000000000000001",
+    "a0a1a2a3a4a5a6a7a8a9aaabacadaeaf",
+    "ffffffffffffffffffffffffffffffff",
+    "deadbeefdeadbeefdeadbeefdeadbeef",
+    "0123456789abcdef0123456789abcdee",
+};
+
+void writeDatabase()
+{
+    std::ofstream f(DB_NAME, std::ios::out | std::ios::binary | std::ios::trunc);
+    f << "; Songlengths\r\n"
+      << "[Other]\r\n"
+      << "ffffffffffffffffffffffffffffffff=9:99\r\n"
+      << "[Database]\r\n"
+      << "; /MUSICIANS/T/Test.sid\r\n"
+      << "0123456789abcdef0123456789abcdef=0:32 1:15(G) 0:05.5 12:01.125\r\n"
+      << "00000000000000000000000000000000=3:00\r\n"
+      << "a0a1a2a3a4a5a6a7a8a9aaabacadaeaf=0:01.10 bad 0:02\r\n"
+      << "7f000000000000000000000000000001=1:02.500 2:00\r\n"
+      << "ffffffffffffffffffffffffffffffff=0:10\r\n"
+      << "0123456789abcdef0123456789abcdef=4:00\r\n";
+}
+
+// Lengths of the first five subtunes of each key
+std::string lengths(SidDatabase &db)
+{
+    std::string result;
+    for (const char* key : KEYS)
+    {
+        for (std::size_t song = 0; song <= 5; song++)
+            result += std::to_string(db.lengthMs(key, song)) + ' ';
+        result += '\n';
+    }
+    return result;
+}
+} // Anonymous namespace
+
+TEST_CASE("Test songlength index", "[database]")
+{
+    writeDatabase();
+    std::remove(INDEX_NAME);
+
+    SidDatabase text;
+    REQUIRE(text.open(DB_NAME));
+    const std::string expected = lengths(text);
+    CHECK(text.lengthMs(KEYS[1], 4) == 721125);
+    CHECK(text.lengthMs(KEYS[4], 1) == 10000);
+
+    REQUIRE(SidDatabase::compile(DB_NAME, INDEX_NAME));
+
+    // Picked up next to the text file
+    SidDatabase compiled;
+    REQUIRE(compiled.open(DB_NAME));
+    CHECK(lengths(compiled) == expected);
+
+    // Opened directly
+    std::remove(DB_NAME);
+    SidDatabase direct;
+    REQUIRE(direct.open(INDEX_NAME));
+    CHECK(lengths(direct) == expected);
+
+    std::remove(INDEX_NAME);
+}
+
+TEST_CASE("Test stale songlength index", "[database]")
+{
+    writeDatabase();
+    REQUIRE(SidDatabase::compile(DB_NAME, INDEX_NAME));
+
+    // The database changes after the index was built
+    {
+        std::ofstream f(DB_NAME, std::ios::out | std::ios::binary | std::ios::app);
+        f << "deadbeefdeadbeefdeadbeefdeadbeef=0:42\r\n";
+    }
+
+    SidDatabase db;
+    REQUIRE(db.open(DB_NAME));
+    CHECK(db.lengthMs(KEYS[5], 1) == 42000);
+
+    std::remove(DB_NAME);
+    std::remove(INDEX_NAME);
+}
+
+TEST_CASE("Test songlength index stale with the same size", "[database]")
+{
+    writeDatabase();
+    REQUIRE(SidDatabase::compile(DB_NAME, INDEX_NAME));
+
+    // Edited in place, the size doesn't change
+    const std::filesystem::file_time_type time = std::filesystem::last_write_time(DB_NAME);
+    std::string text;
+    {
+        std::ifstream f(DB_NAME, std::ios::in | std::ios::binary);
+        text.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    }
+    const std::size_t pos = text.find("=1:02.500");
+    REQUIRE(pos != std::string::npos);
+    text[pos + 4] = '3';
+    {
+        std::ofstream f(DB_NAME, std::ios::out | std::ios::binary | std::ios::trunc);
+        f << text;
+    }
+    std::filesystem::last_write_time(DB_NAME, time + std::chrono::seconds(2));
+
+    SidDatabase db;
+    REQUIRE(db.open(DB_NAME));
+    CHECK(db.lengthMs(KEYS[2], 1) == 63500);
+
+    std::remove(DB_NAME);
+    std::remove(INDEX_NAME);
+}
+
+TEST_CASE("Test songlength index replaced while open", "[database]")
+{
+    writeDatabase();
+    REQUIRE(SidDatabase::compile(DB_NAME, INDEX_NAME));
+
+    SidDatabase before;
+    REQUIRE(before.open(INDEX_NAME));
+    const std::string expected = lengths(before);
+
+    {
+        std::ofstream f(DB_NAME, std::ios::out | std::ios::binary | std::ios::trunc);
+        f << "[Database]\r\n" << KEYS[5] << "=0:42\r\n";
+    }
+    REQUIRE(SidDatabase::compile(DB_NAME, INDEX_NAME));
+
+    // The open index still sees the old contents
+    CHECK(lengths(before) == expected);
+
+    SidDatabase after;
+    REQUIRE(after.open(INDEX_NAME));
+    CHECK(after.lengthMs(KEYS[5], 1) == 42000);
+    CHECK(after.lengthMs(KEYS[1], 1) == -1);
+
+    std::remove(DB_NAME);
+    std::remove(INDEX_NAME);
+}
+
+TEST_CASE("Test songlength entry format", "[database]")
+{
+    const std::string entry = SidDatabase::formatEntry(KEYS[3], { 50, 61005, 3600000 });
+    CHECK(entry == "a0a1a2a3a4a5a6a7a8a9aaabacadaeaf=0:00.050 1:01.005 60:00.000");
+
+    {
+        std::ofstream f(DB_NAME, std::ios::out | std::ios::binary | std::ios::trunc);
+        f << "[Database]\n" << entry << "\n";
+    }
+
+    // Read back, leading zeros in the milliseconds included
+    SidDatabase db;
+    REQUIRE(db.open(DB_NAME));
+    CHECK(db.lengthMs(KEYS[3], 1) == 50);
+    CHECK(db.lengthMs(KEYS[3], 2) == 61005);
+    CHECK(db.lengthMs(KEYS[3], 3) == 3600000);
+
+    std::remove(DB_NAME);
+    std::remove(INDEX_NAME);
+}
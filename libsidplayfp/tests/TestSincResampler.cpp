@@ -0,0 +1,147 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ *  Copyright (C) 2019 Leandro Nini
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <catch.hpp>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#define private public
+
+#include "../src/builders/residfp-builder/residfp/SID.h"
+#include "../src/builders/residfp-builder/residfp/resample/Convolve.h"
+#include "../src/builders/residfp-builder/residfp/resample/TwoPassSincResampler.h"
+
+namespace
+{
+constexpr double CLOCK = 985248.;
+
+std::vector<short> run(reSIDfp::Resampler &r)
+{
+    r.reset();
+
+    std::vector<short> out;
+    for (int i = 0; i < 100000; i++)
+    {
+        // Sawtooth input
+        if (r.input(((i * 97) & 0xffff) - 0x8000))
+            out.push_back(r.getOutput());
+    }
+    return out;
+}
+
+std::vector<short> resample(double samplingFrequency, reSIDfp::convolve_t kernel = nullptr)
+{
+    return run(*reSIDfp::TwoPassSincResampler::create(CLOCK, samplingFrequency, 20000., kernel));
+}
+} // Anonymous namespace
+
+TEST_CASE("Test concurrent FIR table setup", "[resampler]")
+{
+    constexpr std::array<double, 4> rates{ 44100., 48000., 96000., 44100. };
+
+    std::array<std::vector<short>, rates.size()> results;
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < rates.size(); i++)
+    {
+        threads.emplace_back([&results, &rates, i]() { results[i] = resample(rates[i]); });
+    }
+    for (auto& t : threads)
+        t.join();
+
+    for (std::size_t i = 0; i < rates.size(); i++)
+    {
+        CHECK(results[i] == resample(rates[i]));
+    }
+}
+
+TEST_CASE("Test FIR table prewarm", "[resampler]")
+{
+    // Reference built from scratch
+    reSIDfp::SincResampler::releaseUnusedTables();
+    const std::vector<short> cold = run(*reSIDfp::TwoPassSincResampler::create(CLOCK, 32000., 15000.));
+    reSIDfp::SincResampler::releaseUnusedTables();
+
+    reSIDfp::SID::prewarmResampler(CLOCK, 32000., 15000.);
+
+    auto a = reSIDfp::TwoPassSincResampler::create(CLOCK, 32000., 15000.);
+    auto b = reSIDfp::TwoPassSincResampler::create(CLOCK, 32000., 15000.);
+
+    // Both use the tables kept by the cache since the prewarm
+    CHECK(a->s1->firTable == b->s1->firTable);
+    CHECK(a->s2->firTable == b->s2->firTable);
+    CHECK(a->s1->firTable.use_count() == 3);
+    CHECK(a->s2->firTable.use_count() == 3);
+
+    CHECK(run(*a) == cold);
+}
+
+TEST_CASE("Test convolution kernels", "[resampler]")
+{
+    const std::vector<reSIDfp::ConvolveKernel> kernels = reSIDfp::getConvolveKernels();
+    REQUIRE(!kernels.empty());
+
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> samples(-32768, 32767);
+    // Small enough for 1024 taps not to overflow the 32 bit sums
+    std::uniform_int_distribution<int> coefficients(-63, 63);
+
+    // Extra element to test unaligned access
+    std::vector<short> a(1025);
+    std::vector<short> b(1025);
+    for (std::size_t i = 0; i < a.size(); i++)
+    {
+        a[i] = static_cast<short>(samples(rng));
+        b[i] = static_cast<short>(coefficients(rng));
+    }
+
+    for (int length : { 0, 1, 3, 7, 8, 15, 16, 17, 31, 33, 127, 1024 })
+    {
+        std::int64_t expected = 0;
+        for (int i = 0; i < length; i++)
+            expected += a[i + 1] * b[i];
+        REQUIRE(expected == static_cast<int>(expected));
+
+        for (const auto& kernel : kernels)
+        {
+            INFO(kernel.name << " length " << length);
+            CHECK(kernel.convolve(a.data() + 1, b.data(), length) == expected);
+        }
+    }
+}
+
+TEST_CASE("Test resampler output is kernel independent", "[resampler]")
+{
+    const std::vector<reSIDfp::ConvolveKernel> kernels = reSIDfp::getConvolveKernels();
+
+    for (double rate : { 44100., 48000., 96000. })
+    {
+        const std::vector<short> expected = resample(rate, kernels[0].convolve);
+        for (const auto& kernel : kernels)
+        {
+            INFO(kernel.name << " at " << rate);
+            CHECK(resample(rate, kernel.convolve) == expected);
+        }
+    }
+}
@@ -127,3 +127,40 @@ TEST_CASE("Test Noise Write Back1", "[waveform-generator]")
     generator.output(&modulator);
     REQUIRE(int(generator.readOSC()) == 0xd8);
 }
+
+TEST_CASE("Test Skip", "[waveform-generator]")
+{
+    matrix_t* tables = reSIDfp::WaveformCalculator::getInstance()->buildTable(reSIDfp::MOS6581);
+
+    reSIDfp::WaveformGenerator clocked;
+    reSIDfp::WaveformGenerator skipped;
+    for (reSIDfp::WaveformGenerator* generator : { &clocked, &skipped })
+    {
+        generator->setWaveformModels(tables);
+        generator->reset();
+        generator->writeFREQ_LO(0x3d);
+        generator->writeFREQ_HI(0x47);
+        generator->writeCONTROL_REG(0x80);
+    }
+
+    for (unsigned int cycles : { 1u, 7u, 63u, 985u, 19656u })
+    {
+        for (unsigned int i = 0; i < cycles; i++)
+            clocked.clock();
+        skipped.skip(cycles);
+
+        REQUIRE(skipped.readAccumulator() == clocked.readAccumulator());
+        REQUIRE(skipped.shift_register == clocked.shift_register);
+        REQUIRE(skipped.shift_pipeline == clocked.shift_pipeline);
+        REQUIRE(skipped.msb_rising == clocked.msb_rising);
+    }
+
+    // The shift register resets while the test bit is held
+    clocked.writeCONTROL_REG(0x88);
+    skipped.writeCONTROL_REG(0x88);
+    for (unsigned int i = 0; i < 50000; i++)
+        clocked.clock();
+    skipped.skip(50000);
+    REQUIRE(skipped.shift_register == clocked.shift_register);
+    REQUIRE(skipped.readAccumulator() == clocked.readAccumulator());
+}
@@ -0,0 +1,65 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ *  Copyright (C) 2019 Leandro Nini
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <catch.hpp>
+
+#include <thread>
+#include <vector>
+
+#include "../src/WorkerPool.h"
+
+using namespace libsidplayfp;
+
+TEST_CASE("Test every index runs once per job", "[workerpool]")
+{
+    WorkerPool pool(2);
+
+    std::vector<unsigned int> counts(3, 0);
+    for (int i = 0; i < 1000; i++)
+    {
+        pool.run(3, [&counts](unsigned int index) { counts[index]++; });
+    }
+
+    CHECK(counts == std::vector<unsigned int>{ 1000, 1000, 1000 });
+}
+
+TEST_CASE("Test index zero runs on the caller", "[workerpool]")
+{
+    WorkerPool pool(2);
+
+    std::vector<std::thread::id> ids(3);
+    pool.run(3, [&ids](unsigned int index) { ids[index] = std::this_thread::get_id(); });
+
+    CHECK(ids[0] == std::this_thread::get_id());
+    CHECK(ids[1] != ids[0]);
+    CHECK(ids[2] != ids[0]);
+    CHECK(ids[1] != ids[2]);
+}
+
+TEST_CASE("Test fewer indices than workers", "[workerpool]")
+{
+    WorkerPool pool(2);
+
+    std::vector<unsigned int> counts(3, 0);
+    pool.run(2, [&counts](unsigned int index) { counts[index]++; });
+    pool.run(1, [&counts](unsigned int index) { counts[index]++; });
+
+    CHECK(counts == std::vector<unsigned int>{ 2, 1, 0 });
+}
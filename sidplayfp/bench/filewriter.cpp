@@ -0,0 +1,136 @@
+/*
+ * This file is part of sidplayfp, a console SID player.
+ *
+ * Copyright 2011-2019 Leandro Nini
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "../src/audio/AudioConfig.h"
+#include "../src/audio/au/auFile.h"
+#include "../src/audio/wav/WavFile.h"
+
+/**
+ * File driver throughput benchmark.
+ *
+ * Usage: bench-filewriter [directory] [seconds]
+ *
+ * Writes an hour of 48 kHz stereo audio, or the given amount,
+ * through the WAV and AU drivers in both precisions and reports
+ * the time the player spends in the driver, which is what holds
+ * up the emulation, and the total time until the file is closed.
+ * The files are removed afterwards.
+ */
+namespace
+{
+constexpr unsigned int RATE = 48000;
+
+template<typename T>
+void fill(T *buffer, std::size_t count, unsigned int block);
+
+template<>
+void fill(short *buffer, std::size_t count, unsigned int block)
+{
+    for (std::size_t i = 0; i < count; i++)
+        buffer[i] = static_cast<short>((i + block) * 2654435761u >> 16);
+}
+
+template<>
+void fill(float *buffer, std::size_t count, unsigned int block)
+{
+    for (std::size_t i = 0; i < count; i++)
+        buffer[i] = static_cast<float>(static_cast<short>((i + block) * 2654435761u >> 16)) / 32768.f;
+}
+
+template<class Driver>
+bool bench(const std::string &dir, const char *format, int precision, unsigned int seconds)
+{
+    const std::string name = dir + "/bench-filewriter" + Driver::extension();
+    Driver driver(name);
+
+    AudioConfig cfg;
+    cfg.frequency = RATE;
+    cfg.channels = 2;
+    cfg.precision = precision;
+    if (!driver.open(cfg))
+    {
+        std::cerr << "Cannot open " << name << std::endl;
+        return false;
+    }
+
+    // Each block is a whole number of seconds
+    const unsigned int blockSeconds = cfg.bufSize / (RATE * cfg.channels);
+    const unsigned int blocks = (seconds + blockSeconds - 1) / blockSeconds;
+
+    const auto start = std::chrono::steady_clock::now();
+    std::chrono::duration<double> inDriver(0);
+    for (unsigned int block = 0; block < blocks; block++)
+    {
+        // Stands in for the emulation, not timed
+        if (precision == 16)
+            fill(driver.buffer(), cfg.bufSize, block);
+        else
+            fill(driver.floatBuffer(), cfg.bufSize, block);
+
+        const auto t = std::chrono::steady_clock::now();
+        driver.write();
+        inDriver += std::chrono::steady_clock::now() - t;
+    }
+    const bool failed = driver.fail();
+    const auto t = std::chrono::steady_clock::now();
+    driver.close();
+    inDriver += std::chrono::steady_clock::now() - t;
+    const std::chrono::duration<double> total = std::chrono::steady_clock::now() - start;
+
+    std::remove(name.c_str());
+
+    if (failed)
+    {
+        std::cerr << "Write error on " << name << std::endl;
+        return false;
+    }
+
+    const double megabytes = static_cast<double>(blocks) * cfg.bufSize * (precision / 8) / 1e6;
+    std::cout << format << " " << std::setw(2) << precision << " bit: "
+              << std::fixed << std::setprecision(2)
+              << std::setw(7) << inDriver.count() << " s in driver ("
+              << std::setprecision(0) << std::setw(6) << megabytes / inDriver.count() << " MB/s), "
+              << std::setprecision(2) << std::setw(7) << total.count() << " s total for "
+              << std::setprecision(0) << megabytes << " MB" << std::endl;
+    return true;
+}
+} // Anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    const std::string dir = argc > 1 ? argv[1] : ".";
+    const unsigned int seconds = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 3600;
+
+    bool ok = true;
+    for (int precision : { 16, 32 })
+    {
+        ok &= bench<WavFile>(dir, "WAV", precision, seconds);
+        ok &= bench<auFile>(dir, "AU ", precision, seconds);
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
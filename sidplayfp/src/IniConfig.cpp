@@ -98,6 +98,7 @@ void IniConfig::clear()
     audio_s.frequency = SidConfig::DEFAULT_SAMPLING_FREQ;
     audio_s.playback  = SidConfig::PlaybackMode::Mono;
     audio_s.precision = 16;
+    audio_s.queueDepth = 0;
 
     emulation_s.modelDefault  = SidConfig::C64Model::PAL;
     emulation_s.modelForced   = false;
@@ -346,6 +347,13 @@ void IniConfig::readAudio(iniHandler &ini)
     }
 
     readInt(ini, TEXT("BitsPerSample"), audio_s.precision);
+
+    {
+        int queueDepth = 0;
+        readInt(ini, TEXT("QueueDepth"), queueDepth);
+        if (queueDepth > 0)
+            audio_s.queueDepth = queueDepth;
+    }
 }
 
 
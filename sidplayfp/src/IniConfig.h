@@ -62,6 +62,7 @@ public:
         int frequency;
         SidConfig::PlaybackMode playback;
         int  precision;
+        unsigned int queueDepth;
     };
 
     struct emulation_section
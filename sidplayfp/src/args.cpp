@@ -349,6 +349,11 @@ int ConsolePlayer::args(int argc, const char *argv[])
             {
                 m_engCfg.powerOnDelay = (uint_least16_t) atoi(&argv[i][8]);
             }
+            else if (strncmp(&argv[i][1], "-queue=", 7) == 0)
+            {
+                const int depth = atoi(&argv[i][8]);
+                m_driver.queueDepth = depth > 0 ? depth : 0;
+            }
             // File format conversions
             else if (argv[i][1] == 'w')
             {
@@ -598,6 +603,9 @@ void ConsolePlayer::displayArgs (const char *arg)
         << " -p<num>      set format for file output (16 = signed 16 bit, 32 = 32 bit float)"
         << "(default: 16)" << endl
 
+        << " --queue=<num> play through a queue of <num> buffers filled ahead" << endl
+        << "              on a separate audio thread (default: 0, no queue)" << endl
+
 #if !defined(DISALLOW_STEREO_SOUND)
         << " -s           stereo sid support" << endl
 #endif
@@ -47,6 +47,8 @@ private:
 protected:
     AudioConfig _settings;
     short      *_sampleBuffer = nullptr;
+    // Set instead of _sampleBuffer by backends taking float samples
+    float      *_floatBuffer = nullptr;
 
 protected:
     void setError(const char* msg)
@@ -65,6 +67,7 @@ public:
     ~AudioBase() override = default;
 
     short *buffer() const override { return _sampleBuffer; }
+    float *floatBuffer() const override { return _floatBuffer; }
 
     void getConfig(AudioConfig &cfg) const override
     {
@@ -41,6 +41,7 @@ public:
     void close() { audio->close(); }
     void pause() { audio->pause(); }
     short *buffer() const { return audio->buffer(); }
+    float *floatBuffer() const { return audio->floatBuffer(); }
     void getConfig(AudioConfig &cfg) const { audio->getConfig(cfg); }
     const char *getErrorString() const { return audio->getErrorString(); }
 };
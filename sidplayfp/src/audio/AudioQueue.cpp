@@ -0,0 +1,186 @@
+/*
+ * This file is part of sidplayfp, a console SID player.
+ *
+ * Copyright 2011-2019 Leandro Nini
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "AudioQueue.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "AudioConfig.h"
+
+namespace
+{
+// Polling interval when the ring is full or empty,
+// well below the duration of a block
+inline void wait()
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+}
+
+audioQueue::audioQueue(IAudio *device, unsigned int depth) :
+    m_device(device),
+    m_depth(std::max(depth, 2u)) {}
+
+audioQueue::~audioQueue()
+{
+    close();
+}
+
+bool audioQueue::open(AudioConfig &cfg)
+{
+    if (!m_device->open(cfg))
+        return false;
+
+    m_open = true;
+    m_blockSize = cfg.bufSize;
+    if (m_device->floatBuffer() != nullptr)
+        m_floatSamples.assign(m_blockSize * m_depth, 0.f);
+    else
+        m_samples.assign(m_blockSize * m_depth, 0);
+
+    m_head = 0;
+    m_tail = 0;
+    m_failed = false;
+    m_underruns = 0;
+    return true;
+}
+
+void audioQueue::reset()
+{
+    stop();
+    m_tail.store(m_head.load());
+    m_failed = false;
+    m_device->reset();
+}
+
+bool audioQueue::write()
+{
+    if (m_failed)
+        return false;
+
+    const unsigned int head = m_head.load(std::memory_order_relaxed) + 1;
+    m_head.store(head, std::memory_order_release);
+    start();
+
+    // Make room for the next block
+    while (head - m_tail.load(std::memory_order_acquire) >= m_depth)
+    {
+        if (m_failed)
+            return false;
+        wait();
+    }
+
+    return true;
+}
+
+void audioQueue::close()
+{
+    if (!m_open)
+        return;
+
+    if (!m_failed)
+    {
+        start();
+        while (!m_failed && m_tail.load(std::memory_order_acquire) != m_head.load(std::memory_order_relaxed))
+            wait();
+    }
+
+    stop();
+    m_device->close();
+    m_samples.clear();
+    m_floatSamples.clear();
+    m_blockSize = 0;
+    m_open = false;
+}
+
+void audioQueue::pause()
+{
+    stop();
+    m_device->pause();
+}
+
+short *audioQueue::buffer() const
+{
+    return m_samples.empty() ? nullptr : const_cast<short*>(m_samples.data()) + slot(m_head.load(std::memory_order_relaxed));
+}
+
+float *audioQueue::floatBuffer() const
+{
+    return m_floatSamples.empty() ? nullptr : const_cast<float*>(m_floatSamples.data()) + slot(m_head.load(std::memory_order_relaxed));
+}
+
+void audioQueue::start()
+{
+    if (m_running)
+        return;
+
+    m_running = true;
+    m_thread = std::thread(&audioQueue::run, this);
+}
+
+void audioQueue::stop()
+{
+    if (!m_running)
+        return;
+
+    m_running = false;
+    m_thread.join();
+}
+
+void audioQueue::run()
+{
+    bool played = false;
+
+    while (m_running.load(std::memory_order_relaxed))
+    {
+        const unsigned int tail = m_tail.load(std::memory_order_relaxed);
+        if (m_head.load(std::memory_order_acquire) == tail)
+        {
+            // Count each time the device is left starving, not each poll
+            if (played)
+                m_underruns.fetch_add(1, std::memory_order_relaxed);
+            played = false;
+            wait();
+            continue;
+        }
+
+        const std::size_t offset = slot(tail);
+        if (!m_floatSamples.empty())
+        {
+            const float *block = m_floatSamples.data() + offset;
+            std::copy(block, block + m_blockSize, m_device->floatBuffer());
+        }
+        else
+        {
+            const short *block = m_samples.data() + offset;
+            std::copy(block, block + m_blockSize, m_device->buffer());
+        }
+
+        if (!m_device->write())
+        {
+            m_failed = true;
+            return;
+        }
+
+        played = true;
+        m_tail.store(tail + 1, std::memory_order_release);
+    }
+}
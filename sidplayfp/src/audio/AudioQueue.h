@@ -0,0 +1,121 @@
+/*
+ * This file is part of sidplayfp, a console SID player.
+ *
+ * Copyright 2011-2019 Leandro Nini
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef AUDIOQUEUE_H
+#define AUDIOQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "IAudio.h"
+
+/**
+ * Plays through another driver from a separate thread.
+ *
+ * The player fills the blocks of a preallocated ring at its own pace
+ * while the audio thread hands them to the device, so that neither
+ * an emulation hiccup nor a blocking device write stalls the other.
+ * The ring is lock-free, with the player as the only producer and
+ * the audio thread as the only consumer.
+ */
+class audioQueue : public IAudio
+{
+public:
+    /**
+     * @param device the driver to play through, owned by the queue
+     * @param depth the number of blocks in the ring
+     */
+    audioQueue(IAudio *device, unsigned int depth);
+    ~audioQueue() override;
+
+    bool open(AudioConfig &cfg) override;
+
+    /**
+     * Discard the queued blocks and reset the device,
+     * clearing a previous device failure.
+     */
+    void reset() override;
+
+    /**
+     * Queue the current block, waiting if the ring is full.
+     */
+    bool write() override;
+
+    /**
+     * Play the queued blocks and close the device.
+     */
+    void close() override;
+
+    /**
+     * Stop feeding the device until the next write.
+     */
+    void pause() override;
+
+    short *buffer() const override;
+    float *floatBuffer() const override;
+    void getConfig(AudioConfig &cfg) const override { m_device->getConfig(cfg); }
+    const char *getErrorString() const override { return m_device->getErrorString(); }
+
+    /**
+     * Times the audio thread found the ring empty after playing a block.
+     * The player waiting on a full ring is the normal pace and not counted.
+     */
+    unsigned int underruns() const { return m_underruns.load(std::memory_order_relaxed); }
+
+private:
+    void start();
+    void stop();
+
+    /**
+     * Audio thread body.
+     */
+    void run();
+
+    std::size_t slot(unsigned int index) const { return (index % m_depth) * m_blockSize; }
+
+private:
+    const std::unique_ptr<IAudio> m_device;
+    const unsigned int m_depth;
+
+    std::size_t m_blockSize = 0;
+
+    bool m_open = false;
+
+    /// The blocks, only one of them is used
+    std::vector<short> m_samples;
+    std::vector<float> m_floatSamples;
+
+    /// Number of blocks queued by the player
+    std::atomic<unsigned int> m_head{0};
+    /// Number of blocks played
+    std::atomic<unsigned int> m_tail{0};
+
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_failed{false};
+
+    std::atomic<unsigned int> m_underruns{0};
+
+    std::thread m_thread;
+};
+
+#endif // AUDIOQUEUE_H
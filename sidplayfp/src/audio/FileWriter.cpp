@@ -0,0 +1,120 @@
+/*
+ * This file is part of sidplayfp, a console SID player.
+ *
+ * Copyright 2011-2019 Leandro Nini
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "FileWriter.h"
+
+#include <algorithm>
+#include <ostream>
+
+fileWriter::~fileWriter()
+{
+    close();
+}
+
+void fileWriter::open(std::ostream *out, std::size_t maxAppend)
+{
+    close();
+
+    const std::size_t size = std::max(BUFFER_SIZE, maxAppend);
+    m_buffers[0].resize(size);
+    m_buffers[1].resize(size);
+
+    m_out = out;
+    m_current = 0;
+    m_fill = 0;
+    m_pending = 0;
+    m_stop = false;
+    m_failed = out->fail();
+
+    m_thread = std::thread(&fileWriter::run, this);
+}
+
+char *fileWriter::append(std::size_t bytes)
+{
+    if (m_fill + bytes > m_buffers[m_current].size())
+        flush();
+
+    char *data = m_buffers[m_current].data() + m_fill;
+    m_fill += bytes;
+    return data;
+}
+
+void fileWriter::close()
+{
+    if (!m_thread.joinable())
+        return;
+
+    if (m_fill > 0)
+        flush();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    m_thread.join();
+
+    m_buffers[0] = std::vector<char>();
+    m_buffers[1] = std::vector<char>();
+    m_out = nullptr;
+}
+
+void fileWriter::flush()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // Wait for the other buffer to be written out
+    m_cond.wait(lock, [this] { return m_pending == 0; });
+
+    m_pending = m_fill;
+    m_current ^= 1;
+    m_fill = 0;
+
+    lock.unlock();
+    m_cond.notify_all();
+}
+
+void fileWriter::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    for (;;)
+    {
+        m_cond.wait(lock, [this] { return m_pending != 0 || m_stop; });
+        if (m_pending == 0)
+            return;
+
+        // The buffer not being filled
+        const char *data = m_buffers[m_current ^ 1].data();
+        const std::size_t bytes = m_pending;
+
+        lock.unlock();
+        if (!m_failed.load(std::memory_order_relaxed))
+        {
+            m_out->write(data, bytes);
+            if (m_out->fail())
+                m_failed = true;
+        }
+        lock.lock();
+
+        m_pending = 0;
+        m_cond.notify_all();
+    }
+}
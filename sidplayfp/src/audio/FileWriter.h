@@ -0,0 +1,167 @@
+/*
+ * This file is part of sidplayfp, a console SID player.
+ *
+ * Copyright 2011-2019 Leandro Nini
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef FILEWRITER_H
+#define FILEWRITER_H
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <iosfwd>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Buffered stream writer for the file drivers.
+ *
+ * The driver converts its samples straight into one of two large
+ * staging buffers; when that is full it is handed to a background
+ * thread which writes it out in a single call while the other one
+ * is being filled. This keeps the stream writes few and large and
+ * takes them off the emulation thread.
+ *
+ * While open the stream belongs to the writer thread,
+ * the driver may only use it again after close.
+ */
+class fileWriter
+{
+public:
+    /// Size of each staging buffer, unless a single append needs more
+    static constexpr std::size_t BUFFER_SIZE = 8 * 1024 * 1024;
+
+public:
+    fileWriter() = default;
+    fileWriter(const fileWriter&) = delete;
+    fileWriter& operator=(const fileWriter&) = delete;
+    ~fileWriter();
+
+    /**
+     * Start writing to the stream.
+     *
+     * @param out the stream, not owned
+     * @param maxAppend the largest amount of bytes appended at once
+     */
+    void open(std::ostream *out, std::size_t maxAppend);
+
+    /**
+     * Reserve room at the end of the data to be written.
+     *
+     * @param bytes the amount to reserve, at most maxAppend
+     * @return where to store the bytes
+     */
+    char *append(std::size_t bytes);
+
+    /**
+     * Append raw bytes, such as a header.
+     */
+    void write(const void *data, std::size_t bytes)
+    {
+        std::memcpy(append(bytes), data, bytes);
+    }
+
+    /**
+     * Append samples in little endian byte order.
+     */
+    template<typename T>
+    void appendLittle(const T *samples, std::size_t count)
+    {
+#if defined(WORDS_BIGENDIAN)
+        storeSwapped(append(count * sizeof(T)), samples, count);
+#else
+        write(samples, count * sizeof(T));
+#endif
+    }
+
+    /**
+     * Append samples in big endian byte order.
+     */
+    template<typename T>
+    void appendBig(const T *samples, std::size_t count)
+    {
+#if defined(WORDS_BIGENDIAN)
+        write(samples, count * sizeof(T));
+#else
+        storeSwapped(append(count * sizeof(T)), samples, count);
+#endif
+    }
+
+    /**
+     * Write all the data appended so far and stop the writer thread.
+     */
+    void close();
+
+    /**
+     * Whether writing to the stream has failed.
+     */
+    bool failed() const { return m_failed.load(std::memory_order_relaxed); }
+
+private:
+    /**
+     * Store the samples with their bytes reversed.
+     * Written as a plain loop over bytes so that the compiler
+     * can turn it into vector shuffles.
+     */
+    template<typename T>
+    static void storeSwapped(char *dest, const T *samples, std::size_t count)
+    {
+        const char *src = reinterpret_cast<const char*>(samples);
+        for (std::size_t i = 0; i < count * sizeof(T); i += sizeof(T))
+        {
+            for (std::size_t b = 0; b < sizeof(T); b++)
+                dest[i + b] = src[i + sizeof(T) - 1 - b];
+        }
+    }
+
+    void flush();
+
+    /**
+     * Writer thread body.
+     */
+    void run();
+
+private:
+    std::ostream *m_out = nullptr;
+
+    std::vector<char> m_buffers[2];
+
+    /// The buffer being filled
+    unsigned int m_current = 0;
+    /// Bytes appended to the current buffer
+    std::size_t m_fill = 0;
+
+    /// Bytes of the other buffer still to be written, guarded by m_mutex
+    std::size_t m_pending = 0;
+    /// Tell the writer thread to exit, guarded by m_mutex
+    bool m_stop = false;
+
+    std::atomic<bool> m_failed{false};
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::thread m_thread;
+};
+
+#endif // FILEWRITER_H
@@ -27,109 +27,39 @@
 #include <iomanip>
 #include <iostream>
 #include <new>
-#include <vector>
 
 namespace
 {
-/// Set the lo byte (8 bit) in a word (16 bit)
-void endian_16lo8(uint_least16_t &word, uint8_t byte)
-{
-    word &= 0xff00;
-    word |= byte;
-}
-
 /// Get the lo byte (8 bit) in a word (16 bit)
 uint8_t endian_16lo8(uint_least16_t word)
 {
     return static_cast<uint8_t>(word);
 }
 
-/// Set the hi byte (8 bit) in a word (16 bit)
-void endian_16hi8(uint_least16_t &word, uint8_t byte)
-{
-    word &= 0x00ff;
-    word |= static_cast<uint_least16_t>(byte) << 8;
-}
-
 /// Set the hi byte (8 bit) in a word (16 bit)
 uint8_t endian_16hi8(uint_least16_t word)
 {
     return static_cast<uint8_t>(word >> 8);
 }
 
-/// Convert high-byte and low-byte to 16-bit word.
-uint_least16_t endian_16(uint8_t hi, uint8_t lo)
-{
-    uint_least16_t word = 0;
-    endian_16lo8(word, lo);
-    endian_16hi8(word, hi);
-    return word;
-}
-
-/// Convert high-byte and low-byte to 16-bit big endian word.
-uint_least16_t endian_big16(const uint8_t ptr[2])
-{
-    return endian_16(ptr[0], ptr[1]);
-}
-
-/// Set the hi word (16bit) in a dword (32 bit)
-void endian_32hi16(uint_least32_t &dword, uint_least16_t word)
-{
-    dword &= static_cast<uint_least32_t>(0x0000ffff);
-    dword |= static_cast<uint_least32_t>(word) << 16;
-}
-
 /// Get the hi word (16bit) in a dword (32 bit)
 uint_least16_t endian_32hi16(uint_least32_t dword)
 {
     return static_cast<uint_least16_t>(dword >> 16);
 }
 
-/// Set the lo byte (8 bit) in a dword (32 bit)
-void endian_32lo8(uint_least32_t &dword, uint8_t byte)
-{
-    dword &= static_cast<uint_least32_t>(0xffffff00);
-    dword |= static_cast<uint_least32_t>(byte);
-}
-
 /// Get the lo byte (8 bit) in a dword (32 bit)
 uint8_t endian_32lo8(uint_least32_t dword)
 {
     return static_cast<uint8_t>(dword);
 }
 
-/// Set the hi byte (8 bit) in a dword (32 bit)
-void endian_32hi8(uint_least32_t &dword, uint8_t byte)
-{
-    dword &= static_cast<uint_least32_t>(0xffff00ff);
-    dword |= static_cast<uint_least32_t>(byte) << 8;
-}
-
 /// Get the hi byte (8 bit) in a dword (32 bit)
 uint8_t endian_32hi8(uint_least32_t dword)
 {
     return static_cast<uint8_t>(dword >> 8);
 }
 
-/// Convert high-byte and low-byte to 32-bit word.
-uint_least32_t endian_32(uint8_t hihi, uint8_t hilo, uint8_t hi, uint8_t lo)
-{
-    uint_least32_t dword = 0;
-    uint_least16_t word  = 0;
-    endian_32lo8(dword, lo);
-    endian_32hi8(dword, hi);
-    endian_16lo8(word, hilo);
-    endian_16hi8(word, hihi);
-    endian_32hi16(dword, word);
-    return dword;
-}
-
-/// Convert high-byte and low-byte to 32-bit big endian word.
-uint_least32_t endian_big32(const uint8_t ptr[4])
-{
-    return endian_32(ptr[0], ptr[1], ptr[2], ptr[3]);
-}
-
 // Write a big-endian 32-bit word to four bytes in memory.
 void endian_big32(uint8_t ptr[4], uint_least32_t dword)
 {
@@ -186,7 +116,10 @@ bool auFile::open(AudioConfig &cfg)
     // We need to make a buffer for the user
     try
     {
-        _sampleBuffer = new short[bufSize];
+        if (precision == 16)
+            _sampleBuffer = new short[bufSize];
+        else
+            _floatBuffer = new float[bufSize];
     }
     catch (const std::bad_alloc&)
     {
@@ -208,73 +141,68 @@ bool auFile::open(AudioConfig &cfg)
         file = new std::ofstream(name.c_str(), std::ios::out|std::ios::binary|std::ios::trunc);
     }
 
+    writer.open(file, bufSize * (bits >> 3));
+
     _settings = cfg;
     return true;
 }
 
 bool auFile::fail() const
 {
-    return file->fail() != 0;
+    return writer.failed();
 }
 
 bool auFile::bad() const
 {
-    return file->bad() != 0;
+    return writer.failed();
 }
 
 bool auFile::write()
 {
-    if (file && !file->fail())
+    if (file && !writer.failed())
     {
         unsigned long int bytes = _settings.bufSize;
         if (!headerWritten)
         {
-            file->write((char*)&auHdr, sizeof(auHeader));
+            writer.write(&auHdr, sizeof(auHeader));
             headerWritten = true;
         }
 
         if (precision == 16)
         {
-            std::vector<uint_least16_t> buffer(_settings.bufSize);
             bytes *= 2;
-            for (unsigned long i=0; i<_settings.bufSize; i++)
-            {
-                uint_least16_t temp = _sampleBuffer[i];
-                buffer[i] = endian_big16((uint8_t*)&temp);
-            }
-            file->write((char*)&buffer.front(), bytes);
+            writer.appendBig(_sampleBuffer, _settings.bufSize);
         }
         else
         {
-            std::vector<float> buffer(_settings.bufSize);
             bytes *= 4;
-            // normalize floats
-            for (std::size_t i = 0; i < _settings.bufSize; i++)
-            {
-                float temp = static_cast<float>(_sampleBuffer[i]) / 32768.f;
-                buffer[i] = static_cast<float>(endian_big32((uint8_t*)&temp));
-            }
-            file->write((char*)&buffer.front(), bytes);
+            writer.appendBig(_floatBuffer, _settings.bufSize);
         }
         byteCount += bytes;
-
     }
     return true;
 }
 
 void auFile::close()
 {
-    if (file && !file->fail())
+    if (file)
     {
+        writer.close();
+
         // update length field in header
-        endian_big32(auHdr.dataSize, byteCount);
-        if (file != &std::cout)
+        if (!file->fail() && (file != &std::cout))
         {
+            endian_big32(auHdr.dataSize, byteCount);
             file->seekp(0, std::ios::beg);
             file->write((char*)&auHdr, sizeof(auHeader));
-            delete file;
         }
+
+        if (file != &std::cout)
+            delete file;
         file = nullptr;
         delete[] _sampleBuffer;
+        delete[] _floatBuffer;
+        _sampleBuffer = nullptr;
+        _floatBuffer = nullptr;
     }
 }
@@ -28,6 +28,7 @@
 #include <string>
 
 #include "../AudioBase.h"
+#include "../FileWriter.h"
 
 struct auHeader                         // little endian format
 {
@@ -77,6 +78,7 @@ private:
     auHeader auHdr;
 
     std::ostream* file = nullptr;
+    fileWriter writer;
     bool headerWritten = false;
     int precision = 32;
 };
@@ -28,7 +28,6 @@
 #include <iomanip>
 #include <iostream>
 #include <new>
-#include <vector>
 
 namespace
 {
@@ -156,7 +155,10 @@ bool WavFile::open(AudioConfig &cfg)
     // We need to make a buffer for the user
     try
     {
-        _sampleBuffer = new short[bufSize];
+        if (precision == 16)
+            _sampleBuffer = new short[bufSize];
+        else
+            _floatBuffer = new float[bufSize];
     }
     catch (const std::bad_alloc&)
     {
@@ -183,40 +185,35 @@ bool WavFile::open(AudioConfig &cfg)
         file = new std::ofstream(name.c_str(), std::ios::out|std::ios::binary|std::ios::trunc);
     }
 
+    writer.open(file, bufSize * (bits >> 3));
+
     _settings = cfg;
     return true;
 }
 
 bool WavFile::write()
 {
-    if (file && !file->fail())
+    if (file && !writer.failed())
     {
         unsigned long int bytes = _settings.bufSize;
         if (!headerWritten)
         {
-            file->write((char*)&riffHdr, sizeof(riffHeader));
+            writer.write(&riffHdr, sizeof(riffHeader));
             if (hasListInfo)
-                file->write((char*)&listHdr, sizeof(listInfo));
-            file->write((char*)&wavHdr, sizeof(wavHeader));
+                writer.write(&listHdr, sizeof(listInfo));
+            writer.write(&wavHdr, sizeof(wavHeader));
             headerWritten = true;
         }
 
-        /* XXX endianness... */
         if (precision == 16)
         {
             bytes *= 2;
-            file->write((char*)_sampleBuffer, bytes);
+            writer.appendLittle(_sampleBuffer, _settings.bufSize);
         }
         else
         {
-            std::vector<float> buffer(_settings.bufSize);
             bytes *= 4;
-            // normalize floats
-            for (unsigned long i=0; i<_settings.bufSize; i++)
-            {
-                buffer[i] = ((float)_sampleBuffer[i])/32768.f;
-            }
-            file->write((char*)&buffer.front(), bytes);
+            writer.appendLittle(_floatBuffer, _settings.bufSize);
         }
         dataSize += bytes;
     }
@@ -225,36 +222,43 @@ bool WavFile::write()
 
 void WavFile::close()
 {
-    if (file && !file->fail())
+    if (file)
     {
+        writer.close();
+
         // update length fields in header
-        unsigned long int headerSize = sizeof(riffHeader)+sizeof(wavHeader)-8;
-        if (hasListInfo)
-            headerSize += sizeof(listInfo);
-        endian_little32(riffHdr.length, headerSize+dataSize);
-        endian_little32(wavHdr.dataChunkLen, dataSize);
-        if (file != &std::cout)
+        if (!file->fail() && (file != &std::cout))
         {
+            unsigned long int headerSize = sizeof(riffHeader)+sizeof(wavHeader)-8;
+            if (hasListInfo)
+                headerSize += sizeof(listInfo);
+            endian_little32(riffHdr.length, headerSize+dataSize);
+            endian_little32(wavHdr.dataChunkLen, dataSize);
             file->seekp(0, std::ios::beg);
             file->write((char*)&riffHdr, sizeof(riffHeader));
             if (hasListInfo)
                 file->write((char*)&listHdr, sizeof(listInfo));
             file->write((char*)&wavHdr, sizeof(wavHeader));
-            delete file;
         }
+
+        if (file != &std::cout)
+            delete file;
         file = nullptr;
         delete[] _sampleBuffer;
+        delete[] _floatBuffer;
+        _sampleBuffer = nullptr;
+        _floatBuffer = nullptr;
     }
 }
 
 bool WavFile::fail() const
 {
-    return file->fail() != 0;
+    return writer.failed();
 }
 
 bool WavFile::bad() const
-{ 
-    return file->bad() != 0;
+{
+    return writer.failed();
 }
 
 void WavFile::setInfo(const char* title, const char* author, const char* released)
@@ -28,6 +28,7 @@
 #include <string>
 
 #include "../AudioBase.h"
+#include "../FileWriter.h"
 
 struct riffHeader                       // little endian format
 {
@@ -116,6 +117,7 @@ private:
     listInfo listHdr;
 
     std::ostream* file = nullptr;
+    fileWriter writer;
     bool headerWritten = false;
     bool hasListInfo = false;
     int precision = 32;
@@ -0,0 +1,476 @@
+/*
+ * This file is part of sidplayfp, a console SID player.
+ *
+ * Copyright 2011-2019 Leandro Nini
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+//
+// HVSC catalog indexer
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <sidplayfp/SidDatabase.h>
+#include <sidplayfp/SidTune.h>
+#include <sidplayfp/SidTuneInfo.h>
+
+namespace fs = std::filesystem;
+
+using namespace std;
+
+namespace
+{
+/**
+ * Runs tasks on a set of threads, each with its own queue.
+ *
+ * A thread takes the newest task from its own queue, so that the
+ * directory walk stays depth first and local to the thread, and steals
+ * the oldest task of another thread, usually a whole directory,
+ * when its own queue is empty. Threads with nothing to run sleep
+ * until a task is queued or all the tasks are done.
+ */
+class workStealingPool
+{
+public:
+    using task_t = function<void(unsigned int)>;
+
+public:
+    explicit workStealingPool(unsigned int threads) :
+        m_queues(max(threads, 1u)) {}
+
+    /**
+     * Queue a task on a thread, it gets the index of the thread running it.
+     */
+    void push(unsigned int thread, task_t task)
+    {
+        m_pending.fetch_add(1);
+
+        {
+            queue_t &queue = m_queues[thread];
+            lock_guard<mutex> lock(queue.lock);
+            queue.tasks.push_back(move(task));
+            m_queued.fetch_add(1);
+        }
+
+        wakeUp(false);
+    }
+
+    /**
+     * Run until all the tasks, including the ones they queue, are done.
+     */
+    void run()
+    {
+        vector<thread> threads;
+        for (unsigned int i = 1; i < m_queues.size(); i++)
+            threads.emplace_back(&workStealingPool::worker, this, i);
+
+        worker(0);
+
+        for (thread &t : threads)
+            t.join();
+    }
+
+private:
+    struct queue_t
+    {
+        mutex lock;
+        deque<task_t> tasks;
+    };
+
+private:
+    bool pop(unsigned int thread, task_t &task)
+    {
+        {
+            queue_t &queue = m_queues[thread];
+            lock_guard<mutex> lock(queue.lock);
+            if (!queue.tasks.empty())
+            {
+                task = move(queue.tasks.back());
+                queue.tasks.pop_back();
+                m_queued.fetch_sub(1);
+                return true;
+            }
+        }
+
+        for (size_t i = 1; i < m_queues.size(); i++)
+        {
+            queue_t &victim = m_queues[(thread + i) % m_queues.size()];
+            lock_guard<mutex> lock(victim.lock);
+            if (!victim.tasks.empty())
+            {
+                task = move(victim.tasks.front());
+                victim.tasks.pop_front();
+                m_queued.fetch_sub(1);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void wakeUp(bool all)
+    {
+        // Taking the lock orders the change with a waiting thread's check
+        {
+            lock_guard<mutex> lock(m_idleLock);
+        }
+
+        if (all)
+            m_idle.notify_all();
+        else
+            m_idle.notify_one();
+    }
+
+    void worker(unsigned int thread)
+    {
+        task_t task;
+
+        // A task is only counted as done after queueing its children
+        while (m_pending.load() != 0)
+        {
+            if (pop(thread, task))
+            {
+                task(thread);
+                task = nullptr;
+                if (m_pending.fetch_sub(1) == 1)
+                    wakeUp(true);
+            }
+            else
+            {
+                unique_lock<mutex> lock(m_idleLock);
+                m_idle.wait(lock, [this] { return m_pending.load() == 0 || m_queued.load() != 0; });
+            }
+        }
+    }
+
+private:
+    vector<queue_t> m_queues;
+
+    /// Tasks queued or running
+    atomic<unsigned int> m_pending{0};
+
+    /// Tasks waiting in the queues
+    atomic<unsigned int> m_queued{0};
+
+    mutex m_idleLock;
+    condition_variable m_idle;
+};
+
+/*
+ * Catalog file layout, in native byte order:
+ *
+ *   header_t
+ *   record_t[tunes], sorted by path
+ *   uint32_t[lengths], the subtune lengths in milliseconds, 0 if unknown
+ *   char[strings], the NUL terminated HVSC paths
+ */
+
+/// Bumped when the file layout changes
+constexpr uint32_t FILE_VERSION = 1;
+
+constexpr char MAGIC[8] = { 'H', 'V', 'S', 'C', 'c', 'a', 't', 'l' };
+
+struct header_t
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t tunes;
+    uint32_t lengths;
+    uint32_t strings;
+    uint32_t reserved;
+};
+
+struct record_t
+{
+    uint32_t path;          ///< offset in the strings
+    uint32_t firstLength;   ///< index of the length of the first subtune
+    uint8_t md5[16];        ///< old style MD5
+    uint8_t md5New[16];     ///< full file MD5, HVSC#68 and later
+    uint16_t songs;
+    uint16_t startSong;
+    uint16_t loadAddr;
+    uint16_t initAddr;
+    uint16_t playAddr;
+    uint8_t sidChips;
+    uint8_t sidModel[3];    ///< SidTuneInfo::Model of each chip
+    uint8_t clockSpeed;     ///< SidTuneInfo::Clock
+    uint8_t compatibility;  ///< SidTuneInfo::Compatibility
+};
+
+struct tune_t
+{
+    string path;
+    char md5[SidTune::MD5_LENGTH + 1];
+    char md5New[SidTune::MD5_LENGTH + 1];
+    record_t record;
+};
+
+struct context_t
+{
+    workStealingPool &pool;
+    string root;
+
+    /// Per thread, no locking needed
+    vector<vector<tune_t>> &tunes;
+
+    atomic<unsigned int> &failed;
+};
+
+void toBinary(const char *md5, uint8_t *digest)
+{
+    for (int i = 0; i < 16; i++)
+    {
+        const char hex[3] = { md5[i * 2], md5[i * 2 + 1], '\0' };
+        digest[i] = static_cast<uint8_t>(strtoul(hex, nullptr, 16));
+    }
+}
+
+bool isTune(const fs::path &path)
+{
+    const string ext = path.extension().string();
+    return ext.size() == 4 && ext[0] == '.'
+        && (ext[1] | 0x20) == 's' && (ext[2] | 0x20) == 'i' && (ext[3] | 0x20) == 'd';
+}
+
+void indexTune(context_t &ctx, const fs::path &path, unsigned int thread)
+{
+    const string fileName = path.string();
+    SidTune tune(fileName.c_str());
+    if (!tune.getStatus())
+    {
+        cerr << fileName << ": " << tune.statusString() << endl;
+        ctx.failed++;
+        return;
+    }
+
+    tune_t entry;
+    if (tune.createMD5(entry.md5) == nullptr || tune.createMD5New(entry.md5New) == nullptr)
+    {
+        cerr << fileName << ": unable to compute MD5" << endl;
+        ctx.failed++;
+        return;
+    }
+
+    // HVSC paths are relative to the collection root with slash separators
+    entry.path = path.generic_string().substr(ctx.root.size());
+
+    const SidTuneInfo *info = tune.getInfo();
+    record_t &record = entry.record;
+    memset(&record, 0, sizeof(record));
+    toBinary(entry.md5, record.md5);
+    toBinary(entry.md5New, record.md5New);
+    record.songs = static_cast<uint16_t>(info->songs());
+    record.startSong = static_cast<uint16_t>(info->startSong());
+    record.loadAddr = info->loadAddr();
+    record.initAddr = info->initAddr();
+    record.playAddr = info->playAddr();
+    record.sidChips = static_cast<uint8_t>(info->sidChips());
+    for (size_t i = 0; i < 3 && i < info->sidChips(); i++)
+        record.sidModel[i] = static_cast<uint8_t>(info->sidModel(i));
+    record.clockSpeed = static_cast<uint8_t>(info->clockSpeed());
+    record.compatibility = static_cast<uint8_t>(info->compatibility());
+
+    ctx.tunes[thread].push_back(move(entry));
+}
+
+void scanDirectory(context_t &ctx, const fs::path &dir, unsigned int thread)
+{
+    error_code ec;
+    for (fs::directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec), end;
+         !ec && it != end; it.increment(ec))
+    {
+        const fs::path path = it->path();
+        if (it->is_directory(ec))
+        {
+            ctx.pool.push(thread, [&ctx, path](unsigned int t) { scanDirectory(ctx, path, t); });
+        }
+        else if (isTune(path) && it->is_regular_file(ec))
+        {
+            ctx.pool.push(thread, [&ctx, path](unsigned int t) { indexTune(ctx, path, t); });
+        }
+    }
+
+    if (ec)
+    {
+        cerr << dir.string() << ": " << ec.message() << endl;
+        ctx.failed++;
+    }
+}
+
+bool writeCatalog(const char *fileName, const vector<tune_t> &tunes, const vector<uint32_t> &lengths)
+{
+    string strings;
+    vector<record_t> records;
+    records.reserve(tunes.size());
+    for (const tune_t &tune : tunes)
+    {
+        records.push_back(tune.record);
+        records.back().path = static_cast<uint32_t>(strings.size());
+        strings.append(tune.path).push_back('\0');
+    }
+
+    header_t header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FILE_VERSION;
+    header.byteOrder = 0x01020304;
+    header.tunes = static_cast<uint32_t>(records.size());
+    header.lengths = static_cast<uint32_t>(lengths.size());
+    header.strings = static_cast<uint32_t>(strings.size());
+    header.reserved = 0;
+
+    // Write a temporary file and move it in place,
+    // so that readers never see a partial catalog
+    const string tmpName = string(fileName) + ".tmp";
+
+    ofstream f(tmpName, ios::out | ios::binary | ios::trunc);
+    f.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    f.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(record_t));
+    f.write(reinterpret_cast<const char*>(lengths.data()), lengths.size() * sizeof(uint32_t));
+    f.write(strings.data(), strings.size());
+    f.close();
+
+    if (f.fail())
+    {
+        remove(tmpName.c_str());
+        return false;
+    }
+
+#ifdef _WIN32
+    // rename doesn't replace existing files here
+    remove(fileName);
+#endif
+    if (rename(tmpName.c_str(), fileName) != 0)
+    {
+        remove(tmpName.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+void printUsage(const char *name)
+{
+    cerr << "Usage: " << name << " [-j<threads>] [-d<songlength database>] <HVSC directory> <catalog file>" << endl;
+    cerr << "The songlength database defaults to DOCUMENTS/Songlengths.md5 or .txt in the HVSC directory." << endl;
+}
+} // Anonymous namespace
+
+int main(int argc, const char *argv[])
+{
+    unsigned int threads = thread::hardware_concurrency();
+    string database;
+    vector<const char*> args;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "-j", 2) == 0)
+            threads = static_cast<unsigned int>(atoi(argv[i] + 2));
+        else if (strncmp(argv[i], "-d", 2) == 0)
+            database = argv[i] + 2;
+        else if (argv[i][0] == '-')
+        {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        else
+            args.push_back(argv[i]);
+    }
+
+    if (args.size() != 2)
+    {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    string root = fs::path(args[0]).lexically_normal().generic_string();
+    while (root.size() > 1 && root.back() == '/')
+        root.pop_back();
+
+    const auto start = chrono::steady_clock::now();
+
+    workStealingPool pool(max(threads, 1u));
+    vector<vector<tune_t>> results(max(threads, 1u));
+    atomic<unsigned int> failed{0};
+    context_t ctx{ pool, root, results, failed };
+
+    pool.push(0, [&ctx](unsigned int t) { scanDirectory(ctx, ctx.root, t); });
+    pool.run();
+
+    vector<tune_t> tunes;
+    for (vector<tune_t> &result : results)
+        move(result.begin(), result.end(), back_inserter(tunes));
+    sort(tunes.begin(), tunes.end(), [](const tune_t &a, const tune_t &b) { return a.path < b.path; });
+
+    // Lookups are cheap, do them here rather than sharing the database
+    bool newDatabase = true;
+    if (database.empty())
+    {
+        database = root + "/DOCUMENTS/Songlengths.md5";
+        if (!fs::exists(database))
+            database = root + "/DOCUMENTS/Songlengths.txt";
+    }
+    if (database.size() >= 4 && database.compare(database.size() - 4, 4, ".txt") == 0)
+        newDatabase = false;
+
+    SidDatabase db;
+    const bool haveDatabase = db.open(database.c_str());
+    if (!haveDatabase)
+        cerr << argv[0] << ": " << db.error() << " (" << database << ")" << endl;
+
+    vector<uint32_t> lengths;
+    for (tune_t &tune : tunes)
+    {
+        tune.record.firstLength = static_cast<uint32_t>(lengths.size());
+        for (unsigned int song = 1; song <= tune.record.songs; song++)
+        {
+            const int_least32_t length = haveDatabase
+                ? db.lengthMs(newDatabase ? tune.md5New : tune.md5, song) : -1;
+            lengths.push_back(length > 0 ? static_cast<uint32_t>(length) : 0);
+        }
+    }
+
+    if (!writeCatalog(args[1], tunes, lengths))
+    {
+        cerr << argv[0] << ": unable to write " << args[1] << endl;
+        return EXIT_FAILURE;
+    }
+
+    const chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    cout << "Indexed " << tunes.size() << " tunes, " << failed << " failed, in "
+         << elapsed.count() << " s with " << max(threads, 1u) << " threads" << endl;
+
+    return EXIT_SUCCESS;
+}
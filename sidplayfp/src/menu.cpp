@@ -436,7 +436,10 @@ void ConsolePlayer::menu()
     // Get all the text to the screen so music playback
     // is not disturbed.
     if (!m_quietLevel)
+    {
         std::cerr << "00:00";
+        m_statusLength = 5;
+    }
     std::cerr << std::flush;
 }
 
@@ -156,6 +156,7 @@ ConsolePlayer::ConsolePlayer (const char * const name) :
 {   // Other defaults
     m_filter.enabled = true;
     m_driver.device  = nullptr;
+    m_driver.queue   = nullptr;
     m_driver.sid     = SIDEmu::ReSIDFP;
     m_timer.start    = 0;
     m_timer.length   = 0; // FOREVER
@@ -167,6 +168,7 @@ ConsolePlayer::ConsolePlayer (const char * const name) :
     m_track.single   = false;
     m_speed.current  = 1;
     m_speed.max      = 32;
+    m_statusLength   = 0;
 
     // Read default configuration
     m_iniCfg.read ();
@@ -187,6 +189,7 @@ ConsolePlayer::ConsolePlayer (const char * const name) :
         m_engCfg.frequency    = audio.frequency;
         m_engCfg.playback     = audio.playback;
         m_precision           = audio.precision;
+        m_driver.queueDepth   = audio.queueDepth;
         m_filter.enabled      = emulation.filter;
         m_filter.bias         = emulation.bias;
         m_filter.filterCurve6581 = emulation.filterCurve6581;
@@ -274,6 +277,7 @@ bool ConsolePlayer::createOutput(OutputType driver, const SidTuneInfo *tuneInfo)
             delete m_driver.device;
         m_driver.device = nullptr;
     }
+    m_driver.queue = nullptr;
 
     // Create audio driver
     switch (driver)
@@ -286,6 +290,11 @@ bool ConsolePlayer::createOutput(OutputType driver, const SidTuneInfo *tuneInfo)
         try
         {
             m_driver.device = new audioDrv();
+            if (m_driver.queueDepth > 0)
+            {
+                m_driver.queue = new audioQueue(m_driver.device, m_driver.queueDepth);
+                m_driver.device = m_driver.queue;
+            }
         }
         catch (const std::bad_alloc&)
         {
@@ -545,11 +554,11 @@ bool ConsolePlayer::open (void)
         return false;
     }
 
-    // Start the player.  Do this by fast
-    // forwarding to the start position
+    // Start the player.  Do this by seeking
+    // silently to the start position
     m_driver.selected = &m_driver.null;
-    m_speed.current   = m_speed.max;
-    m_engine.fastForward(100 * m_speed.current);
+    m_speed.current   = 1;
+    m_engine.fastForward(100);
 
     m_engine.mute(0, 0, vMute[0]);
     m_engine.mute(0, 1, vMute[1]);
@@ -587,6 +596,12 @@ bool ConsolePlayer::open (void)
         }
     }
 
+    if ((m_timer.start != 0) && !m_engine.seek(m_timer.start))
+    {
+        displayError(m_engine.error());
+        return false;
+    }
+
     m_timer.current = ~0;
     m_timer.starting = true;
     m_state = playerRunning;
@@ -657,9 +672,11 @@ bool ConsolePlayer::play ()
         updateDisplay();
 
         // Fill buffer
-        short *buffer = m_driver.selected->buffer();
         const std::size_t length = m_driver.cfg.bufSize;
-        const std::size_t ret = m_engine.play (buffer, length);
+        float *floatBuffer = m_driver.selected->floatBuffer();
+        const std::size_t ret = floatBuffer != nullptr
+            ? m_engine.play (floatBuffer, length)
+            : m_engine.play (m_driver.selected->buffer(), length);
         if (ret < length)
         {
             if (m_engine.isPlaying())
@@ -728,9 +745,17 @@ void ConsolePlayer::updateDisplay()
 
     if (!m_quietLevel && (seconds != (m_timer.current / 1000)))
     {
-        cerr << "\b\b\b\b\b" << std::setw(2) << std::setfill('0')
-             << ((seconds / 60) % 100) << ':' << std::setw(2)
-             << std::setfill('0') << (seconds % 60) << std::flush;
+        std::ostringstream status;
+        status << std::setw(2) << std::setfill('0')
+               << ((seconds / 60) % 100) << ':' << std::setw(2)
+               << std::setfill('0') << (seconds % 60);
+        if (m_driver.queue != nullptr && m_driver.selected == m_driver.queue)
+        {
+            status << " [underruns " << m_driver.queue->underruns() << ']';
+        }
+
+        cerr << std::string(m_statusLength, '\b') << status.str() << std::flush;
+        m_statusLength = status.str().length();
     }
 
     m_timer.current = milliseconds;
@@ -739,7 +764,11 @@ void ConsolePlayer::updateDisplay()
     {   // Switch audio drivers.
         m_timer.starting = false;
         m_driver.selected = m_driver.device;
-        memset(m_driver.selected->buffer (), 0, m_driver.cfg.bufSize);
+        float *floatBuffer = m_driver.selected->floatBuffer();
+        if (floatBuffer != nullptr)
+            memset(floatBuffer, 0, m_driver.cfg.bufSize * sizeof(float));
+        else
+            memset(m_driver.selected->buffer (), 0, m_driver.cfg.bufSize);
         m_speed.current = 1;
         m_engine.fastForward(100);
         if (m_cpudebug)
@@ -36,6 +36,7 @@
 
 #include "audio/IAudio.h"
 #include "audio/AudioConfig.h"
+#include "audio/AudioQueue.h"
 #include "audio/null/null.h"
 #include "IniConfig.h"
 
@@ -184,6 +185,8 @@ private:
         IAudio*        selected; // Selected Output Driver
         IAudio*        device;   // HW/File Driver
         Audio_Null     null;     // Used for everything
+        audioQueue*    queue;    // Same as device when playing through a queue
+        unsigned int   queueDepth; // Blocks queued ahead of the sound card, 0 for none
     } m_driver;
 
     struct m_timer_t
@@ -211,6 +214,9 @@ private:
         uint_least8_t max;
     } m_speed;
 
+    // Length of the time display
+    std::size_t m_statusLength;
+
 private:
     // Console
     void consoleColour(PlayerColor colour, bool bold);
@@ -0,0 +1,293 @@
+/*
+ * This file is part of sidplayfp, a console SID player.
+ *
+ * Copyright 2011-2019 Leandro Nini
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+//
+// Songlength estimator
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <sidplayfp/sidplayfp.h>
+#include <sidplayfp/SidConfig.h>
+#include <sidplayfp/SidDatabase.h>
+#include <sidplayfp/SidTune.h>
+#include <sidplayfp/SidTuneInfo.h>
+#include <sidplayfp/builders/residfp.h>
+
+namespace fs = std::filesystem;
+
+using namespace std;
+
+namespace
+{
+struct options_t
+{
+    unsigned int threads = thread::hardware_concurrency();
+    uint_least32_t maxLengthMs = 600000;
+    uint_least32_t silenceMs = 3000;
+    string database;
+    string kernal;
+    string basic;
+};
+
+struct result_t
+{
+    string path;
+    string entry;
+};
+
+struct context_t
+{
+    const options_t &options;
+    const string &root;
+    const vector<fs::path> &files;
+    const vector<uint8_t> &kernal;
+    const vector<uint8_t> &basic;
+
+    /// Tunes already in the database are skipped
+    SidDatabase *database;
+    mutex databaseLock;
+
+    atomic<size_t> next{0};
+    atomic<unsigned int> failed{0};
+};
+
+bool isTune(const fs::path &path)
+{
+    const string ext = path.extension().string();
+    return ext.size() == 4 && ext[0] == '.'
+        && (ext[1] | 0x20) == 's' && (ext[2] | 0x20) == 'i' && (ext[3] | 0x20) == 'd';
+}
+
+bool loadRom(const string &fileName, size_t size, vector<uint8_t> &rom)
+{
+    if (fileName.empty())
+        return true;
+
+    ifstream f(fileName, ios::in | ios::binary);
+    rom.assign(istreambuf_iterator<char>(f), istreambuf_iterator<char>());
+    return rom.size() == size;
+}
+
+bool known(context_t &ctx, const char *md5)
+{
+    if (ctx.database == nullptr)
+        return false;
+
+    lock_guard<mutex> lock(ctx.databaseLock);
+    return ctx.database->lengthMs(md5, 1) > 0;
+}
+
+void estimateTune(context_t &ctx, sidplayfp &engine, const fs::path &path, vector<result_t> &results)
+{
+    const string fileName = path.string();
+    SidTune tune(fileName.c_str());
+    if (!tune.getStatus())
+    {
+        cerr << fileName << ": " << tune.statusString() << endl;
+        ctx.failed++;
+        return;
+    }
+
+    char md5[SidTune::MD5_LENGTH + 1];
+    if (tune.createMD5New(md5) == nullptr)
+    {
+        cerr << fileName << ": unable to compute MD5" << endl;
+        ctx.failed++;
+        return;
+    }
+
+    if (known(ctx, md5))
+        return;
+
+    vector<uint_least32_t> lengths;
+    for (unsigned int song = 1; song <= tune.getInfo()->songs(); song++)
+    {
+        const int_least32_t length = engine.estimateLength(&tune, song,
+            ctx.options.maxLengthMs, ctx.options.silenceMs);
+        if (length < 0)
+        {
+            cerr << fileName << ": " << engine.error() << endl;
+            ctx.failed++;
+            return;
+        }
+
+        // Tunes that never end play until the limit
+        lengths.push_back(length > 0 ? static_cast<uint_least32_t>(length) : ctx.options.maxLengthMs);
+    }
+
+    // HVSC paths are relative to the collection root with slash separators
+    results.push_back({ path.generic_string().substr(ctx.root.size()), SidDatabase::formatEntry(md5, lengths) });
+}
+
+/**
+ * Each thread has its own engine and takes the next tune in the list.
+ */
+void worker(context_t &ctx, vector<result_t> &results)
+{
+    ReSIDfpBuilder builder("sldbestimate");
+    builder.create(3);
+
+    sidplayfp engine;
+    engine.setRoms(ctx.kernal.empty() ? nullptr : ctx.kernal.data(),
+                   ctx.basic.empty() ? nullptr : ctx.basic.data());
+
+    SidConfig config = engine.config();
+    config.sidEmulation = &builder;
+    config.powerOnDelay = 0;
+    if (!engine.config(config))
+    {
+        cerr << "sldbestimate: " << engine.error() << endl;
+        return;
+    }
+
+    for (size_t i = ctx.next++; i < ctx.files.size(); i = ctx.next++)
+        estimateTune(ctx, engine, ctx.files[i], results);
+}
+
+void printUsage(const char *name)
+{
+    cerr << "Usage: " << name << " [-j<threads>] [-t<max seconds>] [-s<silence seconds>]"
+            " [-d<songlength database>] [-k<kernal>] [-b<basic>] <directory> [output file]" << endl;
+    cerr << "Estimates the length of the tunes missing from the database, in Songlengths.md5 format." << endl;
+}
+} // Anonymous namespace
+
+int main(int argc, const char *argv[])
+{
+    options_t options;
+    vector<const char*> args;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "-j", 2) == 0)
+            options.threads = static_cast<unsigned int>(atoi(argv[i] + 2));
+        else if (strncmp(argv[i], "-t", 2) == 0)
+            options.maxLengthMs = static_cast<uint_least32_t>(atof(argv[i] + 2) * 1000.);
+        else if (strncmp(argv[i], "-s", 2) == 0)
+            options.silenceMs = static_cast<uint_least32_t>(atof(argv[i] + 2) * 1000.);
+        else if (strncmp(argv[i], "-d", 2) == 0)
+            options.database = argv[i] + 2;
+        else if (strncmp(argv[i], "-k", 2) == 0)
+            options.kernal = argv[i] + 2;
+        else if (strncmp(argv[i], "-b", 2) == 0)
+            options.basic = argv[i] + 2;
+        else if (argv[i][0] == '-')
+        {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        else
+            args.push_back(argv[i]);
+    }
+
+    if (args.empty() || args.size() > 2 || options.maxLengthMs == 0)
+    {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    vector<uint8_t> kernal;
+    vector<uint8_t> basic;
+    if (!loadRom(options.kernal, 8192, kernal) || !loadRom(options.basic, 8192, basic))
+    {
+        cerr << argv[0] << ": invalid ROM image" << endl;
+        return EXIT_FAILURE;
+    }
+
+    SidDatabase db;
+    if (!options.database.empty() && !db.open(options.database.c_str()))
+    {
+        cerr << argv[0] << ": " << db.error() << " (" << options.database << ")" << endl;
+        return EXIT_FAILURE;
+    }
+
+    string root = fs::path(args[0]).lexically_normal().generic_string();
+    while (root.size() > 1 && root.back() == '/')
+        root.pop_back();
+
+    const auto start = chrono::steady_clock::now();
+
+    vector<fs::path> files;
+    error_code ec;
+    for (fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec), end;
+         !ec && it != end; it.increment(ec))
+    {
+        if (isTune(it->path()) && it->is_regular_file(ec))
+            files.push_back(it->path());
+    }
+    if (ec)
+    {
+        cerr << args[0] << ": " << ec.message() << endl;
+        return EXIT_FAILURE;
+    }
+
+    context_t ctx{ options, root, files, kernal, basic, options.database.empty() ? nullptr : &db, {}, {}, {} };
+
+    const unsigned int threads = max(options.threads, 1u);
+    vector<vector<result_t>> results(threads);
+    vector<thread> workers;
+    for (unsigned int i = 1; i < threads; i++)
+        workers.emplace_back(worker, ref(ctx), ref(results[i]));
+    worker(ctx, results[0]);
+    for (thread &t : workers)
+        t.join();
+
+    vector<result_t> entries;
+    for (vector<result_t> &result : results)
+        move(result.begin(), result.end(), back_inserter(entries));
+    sort(entries.begin(), entries.end(), [](const result_t &a, const result_t &b) { return a.path < b.path; });
+
+    ofstream file;
+    if (args.size() == 2)
+    {
+        file.open(args[1], ios::out | ios::trunc);
+        if (!file.is_open())
+        {
+            cerr << argv[0] << ": unable to write " << args[1] << endl;
+            return EXIT_FAILURE;
+        }
+    }
+    ostream &out = args.size() == 2 ? file : cout;
+
+    out << "[Database]" << endl;
+    for (const result_t &entry : entries)
+        out << "; " << entry.path << endl << entry.entry << endl;
+
+    const chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    cerr << "Estimated " << entries.size() << " tunes, " << ctx.failed << " failed, in "
+         << elapsed.count() << " s with " << threads << " threads" << endl;
+
+    return (args.size() == 2 && !file) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,61 @@
+/*
+ * This file is part of sidplayfp, a console SID player.
+ *
+ * Copyright 2011-2019 Leandro Nini
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+//
+// Songlength database compiler
+//
+
+#include <iostream>
+#include <string>
+
+#include <cstdlib>
+
+#include <sidplayfp/SidDatabase.h>
+
+using namespace std;
+
+int main(int argc, const char *argv[])
+{
+    if (argc < 2 || argc > 3)
+    {
+        cerr << "Usage: " << argv[0] << " <songlength database> [index file]" << endl;
+        cerr << "The index defaults to the database name plus .idx," << endl;
+        cerr << "where it is picked up automatically." << endl;
+        return EXIT_FAILURE;
+    }
+
+    const string index = argc > 2 ? string(argv[2]) : string(argv[1]) + ".idx";
+
+    if (!SidDatabase::compile(argv[1], index.c_str()))
+    {
+        cerr << argv[0] << ": unable to compile " << argv[1] << " into " << index << endl;
+        return EXIT_FAILURE;
+    }
+
+    // Make sure the index can be used
+    SidDatabase database;
+    if (!database.open(index.c_str()))
+    {
+        cerr << argv[0] << ": " << database.error() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
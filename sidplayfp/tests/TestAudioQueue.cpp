@@ -0,0 +1,156 @@
+/*
+ * This file is part of sidplayfp, a console SID player.
+ *
+ * Copyright 2011-2019 Leandro Nini
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "audio/AudioBase.h"
+#include "audio/AudioQueue.h"
+
+namespace
+{
+constexpr uint_least32_t BLOCKSIZE = 64;
+
+/**
+ * Records the first sample of each written block,
+ * failing the writes on request.
+ */
+class FakeDevice : public AudioBase
+{
+public:
+    FakeDevice() : AudioBase("FAKE") {}
+    ~FakeDevice() override { close(); }
+
+    bool open(AudioConfig &cfg) override
+    {
+        cfg.bufSize = BLOCKSIZE;
+        _settings = cfg;
+        m_buffer.assign(BLOCKSIZE, 0);
+        _sampleBuffer = m_buffer.data();
+        return true;
+    }
+
+    void close() override { _sampleBuffer = nullptr; }
+    void reset() override { resets++; }
+    void pause() override {}
+
+    bool write() override
+    {
+        if (fail)
+            return false;
+        played.push_back(_sampleBuffer[0]);
+        writes++;
+        return true;
+    }
+
+    std::atomic<bool> fail{false};
+    std::atomic<unsigned int> writes{0};
+    std::atomic<unsigned int> resets{0};
+    std::vector<short> played;
+
+private:
+    std::vector<short> m_buffer;
+};
+
+// Wait up to a second for the condition
+bool waitFor(const std::function<bool()> &condition)
+{
+    for (int i = 0; i < 1000; i++)
+    {
+        if (condition())
+            return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return condition();
+}
+
+void queueBlock(audioQueue &queue, short value)
+{
+    queue.buffer()[0] = value;
+    REQUIRE(queue.write());
+}
+} // Anonymous namespace
+
+TEST_CASE("Test queue plays the blocks in order", "[queue]")
+{
+    FakeDevice *device = new FakeDevice();
+    audioQueue queue(device, 4);
+
+    AudioConfig cfg;
+    REQUIRE(queue.open(cfg));
+
+    for (short i = 1; i <= 20; i++)
+        queueBlock(queue, i);
+    queue.close();
+
+    REQUIRE(device->played.size() == 20);
+    for (short i = 0; i < 20; i++)
+        REQUIRE(device->played[i] == i + 1);
+}
+
+TEST_CASE("Test queue counts the underruns", "[queue]")
+{
+    FakeDevice *device = new FakeDevice();
+    audioQueue queue(device, 4);
+
+    AudioConfig cfg;
+    REQUIRE(queue.open(cfg));
+
+    queueBlock(queue, 1);
+    REQUIRE(waitFor([&] { return queue.underruns() == 1; }));
+
+    queueBlock(queue, 2);
+    REQUIRE(waitFor([&] { return queue.underruns() == 2; }));
+
+    queue.close();
+    REQUIRE(queue.underruns() == 2);
+}
+
+TEST_CASE("Test queue recovers on reset after a device failure", "[queue]")
+{
+    FakeDevice *device = new FakeDevice();
+    audioQueue queue(device, 4);
+
+    AudioConfig cfg;
+    REQUIRE(queue.open(cfg));
+
+    device->fail = true;
+    queue.buffer()[0] = 1;
+    queue.write();
+    REQUIRE(waitFor([&] {
+        queue.buffer()[0] = 1;
+        return !queue.write();
+    }));
+
+    device->fail = false;
+    queue.reset();
+    REQUIRE(device->resets == 1);
+
+    queueBlock(queue, 2);
+    queueBlock(queue, 3);
+    queue.close();
+
+    REQUIRE(device->played == std::vector<short>{ 2, 3 });
+}
@@ -0,0 +1,164 @@
+/*
+ * This file is part of sidplayfp, a console SID player.
+ *
+ * Copyright 2011-2019 Leandro Nini
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <catch.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "audio/FileWriter.h"
+
+namespace
+{
+constexpr std::size_t BUFFER_SIZE = fileWriter::BUFFER_SIZE;
+
+/**
+ * Takes up to the given number of bytes, then fails.
+ */
+class limitedBuf : public std::streambuf
+{
+public:
+    explicit limitedBuf(std::size_t limit) : m_limit(limit) {}
+
+    std::size_t size() const { return m_size; }
+
+    unsigned int writes = 0;
+
+protected:
+    std::streamsize xsputn(const char*, std::streamsize count) override
+    {
+        writes++;
+        const std::size_t taken = std::min(static_cast<std::size_t>(count), m_limit - m_size);
+        m_size += taken;
+        return static_cast<std::streamsize>(taken);
+    }
+
+    int_type overflow(int_type) override { return traits_type::eof(); }
+
+private:
+    const std::size_t m_limit;
+    std::size_t m_size = 0;
+};
+
+std::vector<short> samples(std::size_t count, unsigned int first)
+{
+    std::vector<short> result(count);
+    for (std::size_t i = 0; i < count; i++)
+        result[i] = static_cast<short>(0x0102 + first + i * 0x0301);
+    return result;
+}
+
+std::string bytes(const std::vector<short> &values, bool bigEndian)
+{
+    std::string result;
+    for (short s : values)
+    {
+        const std::uint16_t value = static_cast<std::uint16_t>(s);
+        const char lo = static_cast<char>(value & 0xff);
+        const char hi = static_cast<char>(value >> 8);
+        result += bigEndian ? hi : lo;
+        result += bigEndian ? lo : hi;
+    }
+    return result;
+}
+} // Anonymous namespace
+
+TEST_CASE("Test writer keeps the order and the byte order across buffers", "[filewriter]")
+{
+    // Blocks not dividing the buffer size, so that they straddle the swaps
+    constexpr std::size_t BLOCK = 3000;
+    constexpr unsigned int BLOCKS = 3 * BUFFER_SIZE / (BLOCK * 2 * 2);
+    // A single append larger than a buffer
+    constexpr std::size_t LARGE = BUFFER_SIZE / 2 + 1000;
+
+    std::ostringstream out;
+    fileWriter writer;
+    writer.open(&out, LARGE * 2);
+
+    writer.write("HEAD", 4);
+    for (unsigned int i = 0; i < BLOCKS; i++)
+    {
+        writer.appendLittle(samples(BLOCK, i).data(), BLOCK);
+        writer.appendBig(samples(BLOCK, i + 1000).data(), BLOCK);
+    }
+    writer.appendLittle(samples(LARGE, 7).data(), LARGE);
+    writer.appendBig(samples(10, 9).data(), 10);
+    writer.close();
+
+    REQUIRE_FALSE(writer.failed());
+
+    const std::string data = out.str();
+    REQUIRE(data.size() == 4 + BLOCKS * BLOCK * 4 + LARGE * 2 + 20);
+
+    std::string expected("HEAD");
+    for (unsigned int i = 0; i < BLOCKS; i++)
+    {
+        expected += bytes(samples(BLOCK, i), false);
+        expected += bytes(samples(BLOCK, i + 1000), true);
+    }
+    expected += bytes(samples(LARGE, 7), false);
+    expected += bytes(samples(10, 9), true);
+    REQUIRE(data == expected);
+}
+
+TEST_CASE("Test writer close flushes the last partial buffer", "[filewriter]")
+{
+    std::ostringstream out;
+    fileWriter writer;
+    writer.open(&out, 1024);
+
+    writer.write("0123456789", 10);
+    REQUIRE(out.str().empty());
+
+    writer.close();
+    REQUIRE(out.str() == "0123456789");
+}
+
+TEST_CASE("Test writer drops the data after a stream failure", "[filewriter]")
+{
+    limitedBuf buf(1000);
+    std::ostream out(&buf);
+    fileWriter writer;
+    writer.open(&out, 1024);
+
+    const std::vector<char> block(1024, 'x');
+    const std::size_t blocks = BUFFER_SIZE / block.size();
+
+    // Fill a buffer and start a second one, the first write fails
+    for (std::size_t i = 0; i <= blocks; i++)
+        writer.write(block.data(), block.size());
+
+    // Waits for the failed write to complete
+    for (std::size_t i = 0; i < blocks; i++)
+        writer.write(block.data(), block.size());
+    REQUIRE(writer.failed());
+
+    writer.write(block.data(), block.size());
+    writer.close();
+
+    REQUIRE(writer.failed());
+    REQUIRE(buf.writes == 1);
+    REQUIRE(buf.size() == 1000);
+}